@@ -195,7 +195,8 @@ void main_driver(const char* argv)
 
     T0 = T_init[0];
 
-    //fluxes
+    //stochastic part of the fluxes; the deterministic fluxes and the nodal
+    //viscous stresses only live in per-tile scratch inside RK3step
     // need +4 to separate out heat, viscous heating (diagonal vs shear)  and Dufour contributions to the energy flux 
     // stacked at the end (see below)
     // index: flux term
@@ -228,24 +229,28 @@ void main_driver(const char* argv)
     rancorn.define(convert(ba,nodal_flag), dmap, 1, 0);
     rancorn.setVal(0.0);
 
-    //nodal arrays used for calculating viscous stress
-    std::array< MultiFab, AMREX_SPACEDIM > cornx;
-    AMREX_D_TERM(cornx[0].define(convert(ba,nodal_flag), dmap, 1, 0);,
-                 cornx[1].define(convert(ba,nodal_flag), dmap, 1, 0);,
-                 cornx[2].define(convert(ba,nodal_flag), dmap, 1, 0););
-
-    std::array< MultiFab, AMREX_SPACEDIM > corny;
-    AMREX_D_TERM(corny[0].define(convert(ba,nodal_flag), dmap, 1, 0);,
-                 corny[1].define(convert(ba,nodal_flag), dmap, 1, 0);,
-                 corny[2].define(convert(ba,nodal_flag), dmap, 1, 0););
-
-    std::array< MultiFab, AMREX_SPACEDIM > cornz;
-    AMREX_D_TERM(cornz[0].define(convert(ba,nodal_flag), dmap, 1, 0);,
-                 cornz[1].define(convert(ba,nodal_flag), dmap, 1, 0);,
-                 cornz[2].define(convert(ba,nodal_flag), dmap, 1, 0););
-
-    MultiFab visccorn;
-    visccorn.define(convert(ba,nodal_flag), dmap, 1, 0);
+    //white noise of the two RK3 fields "A" and "B", refilled every step;
+    //A is in the first half of the components and B in the second half
+    //(no density component)
+    std::array< MultiFab, AMREX_SPACEDIM > stochFlux_AB;
+    AMREX_D_TERM(stochFlux_AB[0].define(convert(ba,nodal_flag_x), dmap, 2*(nvars-1), 0);,
+                 stochFlux_AB[1].define(convert(ba,nodal_flag_y), dmap, 2*(nvars-1), 0);,
+                 stochFlux_AB[2].define(convert(ba,nodal_flag_z), dmap, 2*(nvars-1), 0););
+
+    MultiFab rancorn_AB;
+    rancorn_AB.define(convert(ba,nodal_flag), dmap, 2, 0);
+
+    //primitive variables written by each RK3 stage, swapped with prim
+    MultiFab prim_new(ba,dmap,nprimvars,ngc);
+    prim_new.setVal(0.0);
+
+    //state of each cell at its last transport coefficient evaluation, only
+    //used if transport_lag_tol > 0; zero forces a full evaluation
+    MultiFab transport_ref;
+    if (transport_lag_tol > 0.) {
+        transport_ref.define(ba,dmap,nspecies+5,ngc);
+        transport_ref.setVal(0.0);
+    }
 
     Real time = 0;
 
@@ -519,7 +524,13 @@ void main_driver(const char* argv)
         Real ts1 = ParallelDescriptor::second();
     
         RK3step(cu, cup, cup2, cup3, prim, source, eta, zeta, kappa, chi, D, flux,
-                stochFlux, cornx, corny, cornz, visccorn, rancorn, geom, dt);
+                stochFlux, rancorn, stochFlux_AB, rancorn_AB, prim_new, transport_ref, geom, dt);
+
+        // lagged transport coefficients at the new state against the exact ones
+        if (transport_lag_tol > 0. && transport_lag_report > 0 && step%transport_lag_report == 0) {
+            calculateTransportCoeffs(prim, eta, zeta, kappa, chi, D, transport_ref);
+            TransportLagReport(prim, eta, zeta, kappa, chi, D, transport_ref);
+        }
 
         // timer
         Real ts2 = ParallelDescriptor::second() - ts1;
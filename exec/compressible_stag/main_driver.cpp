@@ -772,7 +772,57 @@ void main_driver(const char* argv)
     AMREX_D_TERM(cenflux[0].define(ba,dmap,1,1);, // 0-2: rhoU, rhoV, rhoW
                  cenflux[1].define(ba,dmap,1,1);,
                  cenflux[2].define(ba,dmap,1,1););
-                
+
+    //weighted stochastic fluxes passed to calculateFluxStag
+    std::array< MultiFab, AMREX_SPACEDIM > stochface;
+    std::array< MultiFab, 2 > stochedge_x;
+    std::array< MultiFab, 2 > stochedge_y;
+    std::array< MultiFab, 2 > stochedge_z;
+    std::array< MultiFab, AMREX_SPACEDIM > stochcen;
+
+    //white noise of the two RK3 fields "A" and "B", refilled every step;
+    //A is in the first half of the components and B in the second half
+    std::array< MultiFab, AMREX_SPACEDIM > stochface_AB; // no density component
+    std::array< MultiFab, 2 > stochedge_x_AB;
+    std::array< MultiFab, 2 > stochedge_y_AB;
+    std::array< MultiFab, 2 > stochedge_z_AB;
+    std::array< MultiFab, AMREX_SPACEDIM > stochcen_AB;
+
+    AMREX_D_TERM(stochface[0].define(convert(ba,nodal_flag_x), dmap, nvars, 0);,
+                 stochface[1].define(convert(ba,nodal_flag_y), dmap, nvars, 0);,
+                 stochface[2].define(convert(ba,nodal_flag_z), dmap, nvars, 0););
+
+    stochedge_x[0].define(convert(ba,nodal_flag_xy), dmap, 1, 0);
+    stochedge_x[1].define(convert(ba,nodal_flag_xz), dmap, 1, 0);
+
+    stochedge_y[0].define(convert(ba,nodal_flag_xy), dmap, 1, 0);
+    stochedge_y[1].define(convert(ba,nodal_flag_yz), dmap, 1, 0);
+
+    stochedge_z[0].define(convert(ba,nodal_flag_xz), dmap, 1, 0);
+    stochedge_z[1].define(convert(ba,nodal_flag_yz), dmap, 1, 0);
+
+    AMREX_D_TERM(stochcen[0].define(ba,dmap,1,0);,
+                 stochcen[1].define(ba,dmap,1,0);,
+                 stochcen[2].define(ba,dmap,1,0););
+
+    for (int d=0; d<AMREX_SPACEDIM; ++d) {
+        stochface_AB[d].define(stochface[d].boxArray(), dmap, 2*(nvars-1), 0);
+        stochcen_AB[d].define(ba, dmap, 2, 0);
+    }
+    for (int i=0; i<2; ++i) {
+        stochedge_x_AB[i].define(stochedge_x[i].boxArray(), dmap, 2, 0);
+        stochedge_y_AB[i].define(stochedge_y[i].boxArray(), dmap, 2, 0);
+        stochedge_z_AB[i].define(stochedge_z[i].boxArray(), dmap, 2, 0);
+    }
+
+    //state of each cell at its last transport coefficient evaluation, only
+    //used if transport_lag_tol > 0; zero forces a full evaluation
+    MultiFab transport_ref;
+    if (transport_lag_tol > 0.) {
+        transport_ref.define(ba,dmap,nspecies+5,ngc);
+        transport_ref.setVal(0.0);
+    }
+
     /////////////////////////////////////////////////
     //Time stepping loop
     /////////////////////////////////////////////////
@@ -783,7 +833,16 @@ void main_driver(const char* argv)
         Real ts1 = ParallelDescriptor::second();
     
         RK3stepStag(cu, cumom, prim, vel, source, eta, zeta, kappa, chi, D, 
-            faceflux, edgeflux_x, edgeflux_y, edgeflux_z, cenflux, geom, dt, step);
+            faceflux, edgeflux_x, edgeflux_y, edgeflux_z, cenflux,
+            stochface, stochedge_x, stochedge_y, stochedge_z, stochcen,
+            stochface_AB, stochedge_x_AB, stochedge_y_AB, stochedge_z_AB, stochcen_AB,
+            transport_ref, geom, dt, step);
+
+        // lagged transport coefficients at the new state against the exact ones
+        if (transport_lag_tol > 0. && transport_lag_report > 0 && step%transport_lag_report == 0) {
+            calculateTransportCoeffs(prim, eta, zeta, kappa, chi, D, transport_ref);
+            TransportLagReport(prim, eta, zeta, kappa, chi, D, transport_ref);
+        }
 
         // timer
         Real ts2 = ParallelDescriptor::second() - ts1;
@@ -514,6 +514,9 @@ void main_driver(const char* argv)
     
     ///////////////////////////////////////////
 
+    // the GMRES solver (and its multigrid hierarchies) is reused for every step
+    GMRES gmres(ba,dmap,geom);
+
     //Time stepping loop
     for(int step=step_start;step<=max_step;++step) {
 
@@ -530,7 +533,7 @@ void main_driver(const char* argv)
 
 	// Advance umac
         advance(umac,umacTemp,pres,tracer,mfluxdiv_stoch,
-                alpha_fc,beta,gamma,beta_ed,geom,dt,turbforce);
+                alpha_fc,beta,gamma,beta_ed,geom,dt,turbforce,gmres);
 
 	//////////////////////////////////////////////////
 
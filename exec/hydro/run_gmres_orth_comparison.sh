@@ -0,0 +1,30 @@
+#!/bin/bash
+
+# Compares GMRES convergence of the default classical Gram-Schmidt
+# (gmres_orth_type=0) against CGS2 with block inner products
+# (gmres_orth_type=1) on the same input: for every GMRES solve it prints the
+# total iteration count and the final residual of both runs side by side.
+# The two columns of each pair should agree up to rounding differences near
+# gmres_rel_tol.
+
+dim="2"
+nprocs="4"
+input_file="inputs_regression_vortex_${dim}d"
+
+make -j${nprocs} DIM=${dim}
+
+for orth in 0 1
+do
+    rm -rf plt* stag*
+    mpiexec -n ${nprocs} ./main${dim}d.gnu.MPI.ex ${input_file} gmres_verbose=1 gmres_orth_type=${orth} \
+        > gmres_orth_${orth}.out
+    grep "total ITERs" gmres_orth_${orth}.out | awk '{print $4}' > gmres_orth_${orth}.iters
+    grep "residual/(norm_b,initial)" gmres_orth_${orth}.out | awk '{print $3}' > gmres_orth_${orth}.resid
+done
+
+echo "solve  iters(orth=0)  iters(orth=1)  resid(orth=0)  resid(orth=1)"
+paste gmres_orth_0.iters gmres_orth_1.iters gmres_orth_0.resid gmres_orth_1.resid | awk '{print NR, $0}'
+
+rm -f gmres_orth_*.iters gmres_orth_*.resid
+
+#END
@@ -204,6 +204,18 @@ void WritePlotFile(int step,
     real_comp_names.push_back("pred_forcex");
     real_comp_names.push_back("pred_forcey");
     real_comp_names.push_back("pred_forcez");
+    real_comp_names.push_back("mass");
+    real_comp_names.push_back("R");
+    real_comp_names.push_back("q");
+    real_comp_names.push_back("dryDiff");
+    real_comp_names.push_back("wetDiff");
+    real_comp_names.push_back("totalDiff");
+    real_comp_names.push_back("sigma");
+    real_comp_names.push_back("eepsilon");
+    real_comp_names.push_back("potential");
+    real_comp_names.push_back("p3m_radius");
+    real_comp_names.push_back("spring");
+    // SoA components (FHD_realDataSoA) follow the struct data
     real_comp_names.push_back("vx");
     real_comp_names.push_back("vy");
     real_comp_names.push_back("vz");
@@ -213,9 +225,6 @@ void WritePlotFile(int step,
     real_comp_names.push_back("ux");
     real_comp_names.push_back("uy");
     real_comp_names.push_back("uz");
-    real_comp_names.push_back("mass");
-    real_comp_names.push_back("R");
-    real_comp_names.push_back("q");
     real_comp_names.push_back("accelFactor");
     real_comp_names.push_back("dragFactor");
     real_comp_names.push_back("ox");
@@ -228,14 +237,6 @@ void WritePlotFile(int step,
     real_comp_names.push_back("diffAv");
     real_comp_names.push_back("stepCount");
     real_comp_names.push_back("multi");
-    real_comp_names.push_back("dryDiff");
-    real_comp_names.push_back("wetDiff");
-    real_comp_names.push_back("totalDiff");
-    real_comp_names.push_back("sigma");
-    real_comp_names.push_back("eepsilon");
-    real_comp_names.push_back("potential");
-    real_comp_names.push_back("p3m_radius");
-    real_comp_names.push_back("spring");
     int_comp_names.push_back("sorted");
     int_comp_names.push_back("i");
     int_comp_names.push_back("j");
@@ -262,6 +263,17 @@ void WritePlotFile(int step,
         0, // pred_forcex
         0, // pred_forcey
         0, // pred_forcez
+        0, // mass
+        0, // R
+        1, // q
+        0, // dryDiff
+        0, // wetDiff
+        0, // totalDiff
+        0, // sigma
+        0, // eepsilon
+        0, // potential
+        0, // p3m_radius
+        0, // spring
         0, // vx
         0, // vy
         0, // vz
@@ -271,9 +283,6 @@ void WritePlotFile(int step,
         0, // ux
         0, // uy
         0, // uz
-        0, // mass
-        0, // R
-        1, // q
         0, // accelFactor
         0, // dragFactor
         0, // ox
@@ -285,15 +294,7 @@ void WritePlotFile(int step,
         0, // travelTime
         0, // diffAv
         0, // stepCount
-        0, // multi
-        0, // dryDiff
-        0, // wetDiff
-        0, // totalDiff
-        0, // sigma
-        0, // eepsilon
-        0, // potential
-        0,  // p3m_radius
-        0  // spring
+        0 // multi
     };
 
     Vector<int> write_int_comp = {
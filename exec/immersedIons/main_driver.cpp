@@ -731,6 +731,16 @@ void main_driver(const char* argv)
         max_range = max_es_range;
     }
 
+    // g(r) and g(x,y,z) are sampled from the neighbor lists
+    if (radialdist_int > 0 || cartdist_int > 0) {
+        max_range = amrex::max(max_range, searchDist);
+    }
+
+    // Verlet skin: the list is reused until particles have moved half of it
+    Real neighbor_skin = 0;
+    pp.query("neighbor_skin", neighbor_skin);
+    max_range += neighbor_skin;
+
     int cRange = (int)ceil(max_range/dxc[0]);
 
     FhdParticleContainer particles(geomC, geom, dmap, bc, ba, cRange, ang);
@@ -793,6 +803,9 @@ void main_driver(const char* argv)
     for (int d=0; d<AMREX_SPACEDIM; ++d) {
         external[d].define(bp, dmap, 1, ngp);
     }
+
+    // Poisson solver for the potential; keeps its operator/FFT plans across steps
+    ElectrostaticSolver esSolver(bp, dmap, geomP);
     
     ///////////////////////////////////////////
     // structure factor for charge-charge
@@ -955,7 +968,7 @@ void main_driver(const char* argv)
        // particles.forceFunction(dt);
 
         // sr_tog is short range forces
-        // es_tog is electrostatic solve (0=off, 1=Poisson, 2=Pairwise, 3=P3M)
+        // es_tog is electrostatic solve (0=off, 1=Poisson, 3=P3M)
 	
 
         if (sr_tog != 0 || es_tog==3) {
@@ -972,12 +985,7 @@ void main_driver(const char* argv)
         
         // do Poisson solve using 'charge' for RHS, and put potential in 'potential'.
         // Then calculate gradient and put in 'efieldCC', then add 'external'.
-        esSolve(potential, charge, efieldCC, external, geomP);
-
-        if (es_tog==2) {
-            // compute pairwise Coulomb force (currently hard-coded to work with y-wall).
-	    particles.computeForcesCoulombGPU(simParticles);
-	}
+        esSolver.Solve(potential, charge, efieldCC, external, geomP);
 
         // compute other forces and spread to grid
         particles.SpreadIonsGPU(dx, dxp, geom, umac, efieldCC, source, sourceTemp);
@@ -1042,7 +1050,7 @@ void main_driver(const char* argv)
 //                }
 //                particles.writeMat();
 
-//                particles.invertMatrix();
+//                particles.factorMatrix();
 
 
                 MultiFab::Add(source[0],sourceRFD[0],0,0,sourceRFD[0].nComp(),sourceRFD[0].nGrow());
@@ -73,17 +73,16 @@ void FhdParticleContainer::InitParticles(species* particleInfo, const Real* dxp)
  //                    std::cout << "proc " << ParallelDescriptor::MyProc() << " Pos: " << p.pos(0) << ", " << p.pos(1) << ", " << p.pos(2)
  //                              << ", " << p.rdata(FHD_realData::q) << ", " << p.id() << "\n" ;
 
+                    // SoA components; all start at zero except the ones set below
+                    Real soa[FHD_realDataSoA::count] = {0};
+
                     //original position stored for MSD calculations
-                    p.rdata(FHD_realData::ox) = p.pos(0);
-                    p.rdata(FHD_realData::oy) = p.pos(1);
+                    soa[FHD_realDataSoA::ox] = p.pos(0);
+                    soa[FHD_realDataSoA::oy] = p.pos(1);
 #if (BL_SPACEDIM == 3)
-                    p.rdata(FHD_realData::oz) = p.pos(2);
+                    soa[FHD_realDataSoA::oz] = p.pos(2);
 #endif
 
-                    //p.rdata(FHD_realData::vx) = sqrt(particleInfo.R*particleInfo.T)*get_particle_normal_func();
-                    //p.rdata(FHD_realData::vy) = sqrt(particleInfo.R*particleInfo.T)*get_particle_normal_func();
-                    //p.rdata(FHD_realData::vz) = sqrt(particleInfo.R*particleInfo.T)*get_particle_normal_func();
-
                     p.rdata(FHD_realData::pred_posx) = 0;
                     p.rdata(FHD_realData::pred_posy) = 0;
                     p.rdata(FHD_realData::pred_posz) = 0;
@@ -96,37 +95,11 @@ void FhdParticleContainer::InitParticles(species* particleInfo, const Real* dxp)
                     p.rdata(FHD_realData::pred_forcey) = 0;
                     p.rdata(FHD_realData::pred_forcez) = 0;
 
-                    p.rdata(FHD_realData::fx) = 0;
-                    p.rdata(FHD_realData::fy) = 0;
-                    p.rdata(FHD_realData::fz) = 0;
-
-                    p.rdata(FHD_realData::vx) = 0;
-                    p.rdata(FHD_realData::vy) = 0;
-                    p.rdata(FHD_realData::vz) = 0;
-
-                    p.rdata(FHD_realData::ux) = 0;
-                    p.rdata(FHD_realData::uy) = 0;
-                    p.rdata(FHD_realData::uz) = 0;
-
-                    p.rdata(FHD_realData::ax) = 0;
-                    p.rdata(FHD_realData::ay) = 0;
-                    p.rdata(FHD_realData::az) = 0;
-
-                    p.rdata(FHD_realData::fx) = 0;
-                    p.rdata(FHD_realData::fy) = 0;
-                    p.rdata(FHD_realData::fz) = 0;
-
-                    p.rdata(FHD_realData::travelTime) = 0;
-                    p.rdata(FHD_realData::diffAv) = 0;
-                    p.rdata(FHD_realData::stepCount) = 0;
-
                     p.rdata(FHD_realData::mass) = particleInfo[i_spec].m; //mass
                     p.rdata(FHD_realData::R) = particleInfo[i_spec].R; //R
                     p.rdata(FHD_realData::radius) = particleInfo[i_spec].d/2.0; //radius
-                    p.rdata(FHD_realData::accelFactor) = -6*3.14159265359*p.rdata(FHD_realData::radius)/p.rdata(FHD_realData::mass); //acceleration factor (replace with amrex c++ constant for pi...)
-                    p.rdata(FHD_realData::dragFactor) = 6*3.14159265359*p.rdata(FHD_realData::radius); //drag factor
-                    //p.rdata(FHD_realData::dragFactor) = 0; //drag factor
-                    //p.rdata(FHD_realData::dragFactor) = 6*3.14159265359*dx[0]*1.322; //drag factor
+                    soa[FHD_realDataSoA::accelFactor] = -6*3.14159265359*p.rdata(FHD_realData::radius)/p.rdata(FHD_realData::mass); //acceleration factor (replace with amrex c++ constant for pi...)
+                    soa[FHD_realDataSoA::dragFactor] = 6*3.14159265359*p.rdata(FHD_realData::radius); //drag factor
 
                     p.rdata(FHD_realData::wetDiff) = particleInfo[i_spec].wetDiff;
                     p.rdata(FHD_realData::dryDiff) = particleInfo[i_spec].dryDiff;
@@ -144,6 +117,9 @@ void FhdParticleContainer::InitParticles(species* particleInfo, const Real* dxp)
                     p.rdata(FHD_realData::p3m_radius) = (pkernel_es[p.idata(FHD_intData::species)-1] + 0.5)*dxp[0];
 
                     particle_tile.push_back(p);
+                    for (int n=0; n<FHD_realDataSoA::count; ++n) {
+                        particle_tile.push_back_real(n, soa[n]);
+                    }
 
                     pcount++;
                 }
@@ -166,6 +142,7 @@ void FhdParticleContainer::InitParticles(species* particleInfo, const Real* dxp)
     totalPinnedMarkers = pinnedParticles;
 
     Redistribute();
+    nl_valid = 0;
     //clearNeighbors();
     //fillNeighbors();
 
@@ -227,5 +204,6 @@ void FhdParticleContainer::ReInitParticles()
 
     Redistribute();
     doRedist = 1;
+    nl_valid = 0;
 
 }
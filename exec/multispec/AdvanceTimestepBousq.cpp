@@ -31,8 +31,10 @@ void AdvanceTimestepBousq(std::array< MultiFab, AMREX_SPACEDIM >& umac,
                           MultiFab& charge_new,
                           MultiFab& Epot,
                           MultiFab& permittivity,
+                          EpotSolver& epotSolver,
                           StochMassFlux& sMassFlux,
                           StochMomFlux& sMomFlux,
+                          GMRES& gmres,
                           const Real& dt,
                           const Real& time,
                           const int& istep,
@@ -210,7 +212,7 @@ void AdvanceTimestepBousq(std::array< MultiFab, AMREX_SPACEDIM >& umac,
 
     ComputeMassFluxdiv(rho_old,rhotot_old,Temp,diff_mass_fluxdiv,stoch_mass_fluxdiv,
                        diff_mass_flux,stoch_mass_flux,sMassFlux,0.5*dt,time,geom,weights_mass,
-                       charge_old,grad_Epot_old,Epot,permittivity);
+                       charge_old,grad_Epot_old,Epot,permittivity,epotSolver);
     
     // here is a reasonable place to call something to compute in reversible stress term
     // in this case want to get divergence so it looks like a add to rhs for stokes solver
@@ -305,7 +307,6 @@ void AdvanceTimestepBousq(std::array< MultiFab, AMREX_SPACEDIM >& umac,
     // gmres_abs_tol = 0.d0 ! It is better to set gmres_abs_tol in namelist to a sensible value
 
     // call gmres to compute delta v and delta pi
-    GMRES gmres(ba,dmap,geom);
     gmres.Solve(gmres_rhs_v, gmres_rhs_p, dumac, dpi, rhotot_fc_old, eta, eta_ed,
                 kappa, theta_alpha, geom, norm_pre_rhs);
 
@@ -433,7 +434,7 @@ void AdvanceTimestepBousq(std::array< MultiFab, AMREX_SPACEDIM >& umac,
         weights_mass[1] = 1./std::sqrt(2.);
         ComputeMassFluxdiv(rho_new,rhotot_new,Temp,diff_mass_fluxdiv,stoch_mass_fluxdiv,
                            diff_mass_flux,stoch_mass_flux,sMassFlux,dt,time,geom,weights_mass,
-                           charge_new,grad_Epot_new,Epot,permittivity,0);
+                           charge_new,grad_Epot_new,Epot,permittivity,epotSolver,0);
 
     } else if (midpoint_stoch_mass_flux_type == 2) {
 
@@ -454,7 +455,7 @@ void AdvanceTimestepBousq(std::array< MultiFab, AMREX_SPACEDIM >& umac,
         weights_mass[1] = 1.;
         ComputeMassFluxdiv(rho_new,rhotot_new,Temp,diff_mass_fluxdiv,stoch_mass_fluxdiv,
                            diff_mass_flux,stoch_mass_flux,sMassFlux,0.5*dt,time,geom,weights_mass,
-                           charge_new,grad_Epot_new,Epot,permittivity,0);
+                           charge_new,grad_Epot_new,Epot,permittivity,epotSolver,0);
 
         if (variance_coef_mass != 0.) {
             // add stoch_mass_fluxdiv_old to stoch_mass_fluxdiv and multiply by 1/2
@@ -721,7 +722,7 @@ void AdvanceTimestepBousq(std::array< MultiFab, AMREX_SPACEDIM >& umac,
 
             ComputeMassFluxdiv(rho_new,rhotot_new,Temp,diff_mass_fluxdiv,stoch_mass_fluxdiv,
                                diff_mass_flux,stoch_mass_flux,sMassFlux,dt,time,geom,weights_mass,
-                               charge_old,grad_Epot_old,Epot,permittivity,0);
+                               charge_old,grad_Epot_old,Epot,permittivity,epotSolver,0);
         }
     }
     
@@ -31,8 +31,10 @@ void AdvanceTimestepInertial(std::array< MultiFab, AMREX_SPACEDIM >& umac,
                              MultiFab& charge_new,
                              MultiFab& Epot,
                              MultiFab& permittivity,
+                             EpotSolver& epotSolver,
                              StochMassFlux& sMassFlux,
                              StochMomFlux& sMomFlux,
+                             GMRES& gmres,
                              const Real& dt,
                              const Real& time,
                              const int& istep,
@@ -243,7 +245,7 @@ void AdvanceTimestepInertial(std::array< MultiFab, AMREX_SPACEDIM >& umac,
     // this computes "-F = rho W chi [Gamma grad x... ]"
     ComputeMassFluxdiv(rho_new,rhotot_new,Temp,diff_mass_fluxdiv,stoch_mass_fluxdiv,
                        diff_mass_flux,stoch_mass_flux,sMassFlux,dt,time,geom,weights,
-                       charge_new,grad_Epot_new,Epot,permittivity);
+                       charge_new,grad_Epot_new,Epot,permittivity,epotSolver);
     
     // assemble total fluxes to be used in reservoirs
     //
@@ -338,7 +340,6 @@ void AdvanceTimestepInertial(std::array< MultiFab, AMREX_SPACEDIM >& umac,
     // gmres_abs_tol = 0.d0 ! It is better to set gmres_abs_tol in namelist to a sensible value
 
     // call gmres to compute delta v and delta pi
-    GMRES gmres(ba,dmap,geom);
     gmres.Solve(gmres_rhs_v, gmres_rhs_p, dumac, dpi, rhotot_fc_new, eta, eta_ed,
                 kappa, theta_alpha, geom, norm_pre_rhs);
 
@@ -510,7 +511,7 @@ void AdvanceTimestepInertial(std::array< MultiFab, AMREX_SPACEDIM >& umac,
     // this computes "-F = rho W chi [Gamma grad x... ]"
     ComputeMassFluxdiv(rho_new,rhotot_new,Temp,diff_mass_fluxdiv,stoch_mass_fluxdiv,
                        diff_mass_flux,stoch_mass_flux,sMassFlux,dt,time,geom,weights,
-                       charge_new,grad_Epot_new,Epot,permittivity);
+                       charge_new,grad_Epot_new,Epot,permittivity,epotSolver);
     
     // assemble total fluxes to be used in reservoirs
     //
@@ -308,6 +308,12 @@ void main_driver(const char* argv)
     StochMassFlux sMassFlux(ba,dmap,geom,n_rngs_mass);
     StochMomFlux  sMomFlux (ba,dmap,geom,n_rngs_mom);
 
+    // the GMRES solver (and its multigrid hierarchies) is reused for every step
+    GMRES gmres(ba,dmap,geom);
+
+    // the electrodiffusive Poisson operator and its MLMG are reused for every step
+    EpotSolver epotSolver(ba,dmap,geom);
+
     // save random state for writing checkpoint
     //
     //
@@ -471,7 +477,7 @@ void main_driver(const char* argv)
     if (algorithm_type != 2 && algorithm_type != 6) {
         InitialProjection(umac,rho_old,rhotot_old,diff_mass_fluxdiv,stoch_mass_fluxdiv,
                           stoch_mass_flux,sMassFlux,Temp,eta,eta_ed,dt,time,geom,
-                          charge_old,grad_Epot_old,Epot,permittivity);
+                          charge_old,grad_Epot_old,Epot,permittivity,epotSolver);
     }
 
     if (restart < 0) {
@@ -533,8 +539,8 @@ void main_driver(const char* argv)
                                     pi,eta,eta_ed,kappa,Temp,Temp_ed,
                                     diff_mass_fluxdiv,stoch_mass_fluxdiv,stoch_mass_flux,
                                     grad_Epot_old,grad_Epot_new,
-                                    charge_old,charge_new,Epot,permittivity,
-                                    sMassFlux,sMomFlux,
+                                    charge_old,charge_new,Epot,permittivity,epotSolver,
+                                    sMassFlux,sMomFlux,gmres,
                                     dt,time,istep,geom);
         }
         else if (algorithm_type == 6) {
@@ -543,8 +549,8 @@ void main_driver(const char* argv)
                                  pi,eta,eta_ed,kappa,Temp,Temp_ed,
                                  diff_mass_fluxdiv,stoch_mass_fluxdiv,stoch_mass_flux,
                                  grad_Epot_old,grad_Epot_new,
-                                 charge_old,charge_new,Epot,permittivity,
-                                 sMassFlux,sMomFlux,
+                                 charge_old,charge_new,Epot,permittivity,epotSolver,
+                                 sMassFlux,sMomFlux,gmres,
                                  dt,time,istep,geom);
         }
         else {
@@ -0,0 +1,79 @@
+#include "common_functions.H"
+#include "multispec_functions.H"
+
+#include "common_namespace_declarations.H"
+#include "gmres_namespace_declarations.H"
+#include "multispec_namespace_declarations.H"
+
+using namespace amrex;
+
+// Per-cell throughput of the batched multispec chi (iterative and inverse)
+// and Cholesky kernels (ComputeRhoWChi, ComputeSqrtLonsagerFC) with the
+// runtime species count against the kernels specialized for nspecies = 2-8.
+// Each of the max_step repetitions evaluates every cell (or face).
+void main_driver(const char* argv)
+{
+    BL_PROFILE_VAR("main_driver()",main_driver);
+
+    std::string inputs_file = argv;
+
+    // read in parameters from inputs file into F90 modules
+    // we use "+1" because of amrex_string_c_to_f expects a null char termination
+    read_common_namelist   (inputs_file.c_str(),inputs_file.size()+1);
+    read_multispec_namelist(inputs_file.c_str(),inputs_file.size()+1);
+
+    // copy contents of F90 modules to C++ namespaces
+    InitializeCommonNamespace();
+    InitializeMultispecNamespace();
+
+    Vector<int> is_periodic(AMREX_SPACEDIM,1);
+
+    RealBox real_box({AMREX_D_DECL(prob_lo[0],prob_lo[1],prob_lo[2])},
+                     {AMREX_D_DECL(prob_hi[0],prob_hi[1],prob_hi[2])});
+
+    IntVect dom_lo(AMREX_D_DECL(           0,            0,            0));
+    IntVect dom_hi(AMREX_D_DECL(n_cells[0]-1, n_cells[1]-1, n_cells[2]-1));
+    Box domain(dom_lo, dom_hi);
+
+    Geometry geom(domain,&real_box,CoordSys::cartesian,is_periodic.data());
+
+    BoxArray ba(domain);
+    ba.maxSize(IntVect(max_grid_size));
+    DistributionMapping dmap(ba);
+
+    // mass fractions c_init_1 perturbed by up to 10%, with rhotot from the
+    // equation of state 1/rhotot = sum_k c_k/rhobar_k
+    MultiFab rho   (ba,dmap,nspecies,1);
+    MultiFab rhotot(ba,dmap,1,1);
+
+    for ( MFIter mfi(rho); mfi.isValid(); ++mfi) {
+
+        const Box& bx = mfi.growntilebox();
+        const Array4<Real>& r = rho.array(mfi);
+
+        amrex::ParallelForRNG(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k, amrex::RandomEngine const& engine) noexcept
+        {
+            GpuArray<Real,MAX_SPECIES> c;
+
+            Real sumc = 0.;
+            for (int n=0; n<nspecies; ++n) {
+                c[n] = c_init_1[n]*(1. + 0.2*(amrex::Random(engine)-0.5));
+                sumc += c[n];
+            }
+
+            Real rhoinv = 0.;
+            for (int n=0; n<nspecies; ++n) {
+                c[n] /= sumc;
+                rhoinv += c[n]/rhobar[n];
+            }
+
+            for (int n=0; n<nspecies; ++n) {
+                r(i,j,k,n) = c[n]/rhoinv;
+            }
+        });
+    }
+
+    ComputeRhotot(rho,rhotot,1);
+
+    MassFluxUtilBenchmark(rho, rhotot, geom, max_step);
+}
@@ -0,0 +1,109 @@
+#include "common_functions.H"
+#include "FhdParticleContainer.H"
+
+#include "common_namespace_declarations.H"
+
+#include <AMReX_ParmParse.H>
+
+using namespace amrex;
+
+// Memory traffic and throughput of the FHD ion particle struct with the rarely
+// used fields in SoA components (FHD_realDataSoA, the current layout) against
+// the layout with all of them in the struct. Two kernels are timed:
+//  - a force sweep that reads the position, charge and force of each ion and
+//    writes the force, like the hot kernels (compute_forces_nl_gpu, emf_gpu, ...);
+//    it only touches the cache lines holding those fields
+//  - a copy of every struct, like the neighbor particle fill, which moves the
+//    whole struct
+
+// time per force sweep and per copy over np particles of type P
+template <class P>
+std::pair<Real,Real> SweepTime(int np, int nsteps)
+{
+    Gpu::DeviceVector<P> parts(np);
+    Gpu::DeviceVector<P> copies(np);
+    P* pstruct = parts.dataPtr();
+    P* pcopy = copies.dataPtr();
+
+    amrex::ParallelFor(np, [=] AMREX_GPU_DEVICE (int i) noexcept
+    {
+        P& p = pstruct[i];
+        for (int n=0; n<P::NReal; ++n) {
+            p.rdata(n) = 0.;
+        }
+        for (int d=0; d<AMREX_SPACEDIM; ++d) {
+            p.pos(d) = 1.e-3*(i%1000 + d);
+        }
+        p.rdata(FHD_realData::q) = (i%2 == 0) ? 1. : -1.;
+    });
+    Gpu::synchronize();
+
+    Real time1 = ParallelDescriptor::second();
+
+    for (int step=0; step<nsteps; ++step) {
+        amrex::ParallelFor(np, [=] AMREX_GPU_DEVICE (int i) noexcept
+        {
+            P& p = pstruct[i];
+            const ParticleReal qi = p.rdata(FHD_realData::q);
+            p.rdata(FHD_realData::forcex) += qi*p.pos(0);
+            p.rdata(FHD_realData::forcey) += qi*p.pos(1);
+            p.rdata(FHD_realData::forcez) += qi*p.pos(2);
+        });
+    }
+    Gpu::synchronize();
+
+    Real time2 = ParallelDescriptor::second();
+
+    for (int step=0; step<nsteps; ++step) {
+        amrex::ParallelFor(np, [=] AMREX_GPU_DEVICE (int i) noexcept
+        {
+            pcopy[i] = pstruct[i];
+        });
+    }
+    Gpu::synchronize();
+
+    Real time3 = ParallelDescriptor::second();
+
+    Real tsweep = (time2 - time1)/nsteps;
+    Real tcopy  = (time3 - time2)/nsteps;
+    ParallelDescriptor::ReduceRealMax({tsweep,tcopy});
+
+    return {tsweep, tcopy};
+}
+
+template <class P>
+void Report(const std::string& layout, int np, std::pair<Real,Real> t)
+{
+    Print() << layout << ": " << sizeof(P) << " bytes per particle\n"
+            << "  force sweep " << t.first << " s, " << np/t.first << " particles/s\n"
+            << "  copy        " << t.second << " s, " << 2.*sizeof(P) << " bytes moved per particle, "
+            << 2.*sizeof(P)*np/t.second*1.e-9 << " GB/s\n";
+}
+
+void main_driver(const char* argv)
+{
+    BL_PROFILE_VAR("main_driver()",main_driver);
+
+    int np = 4000000;
+    int nsteps = 20;
+    ParmParse pp;
+    pp.query("np", np);
+    pp.query("nsteps", nsteps);
+
+    // particle struct before and after the rarely used fields moved to SoA
+    using ParticleAll = Particle<FHD_realData::count + FHD_realDataSoA::count, FHD_intData::count>;
+    using ParticleHot = Particle<FHD_realData::count, FHD_intData::count>;
+
+    const std::pair<Real,Real> tAll = SweepTime<ParticleAll>(np, nsteps);
+    const std::pair<Real,Real> tHot = SweepTime<ParticleHot>(np, nsteps);
+
+    Print() << "np = " << np << ", " << nsteps << " repetitions, "
+            << FHD_realDataSoA::count*sizeof(ParticleReal)
+            << " bytes per particle in SoA components (not touched by either kernel)\n";
+    Report<ParticleAll>("all fields in the struct", np, tAll);
+    Report<ParticleHot>("rarely used fields in SoA", np, tHot);
+    Print() << "struct size reduced by "
+            << Real(sizeof(ParticleAll))/Real(sizeof(ParticleHot)) << "x, "
+            << "force sweep time by " << tAll.first/tHot.first << "x, "
+            << "copy time by " << tAll.second/tHot.second << "x\n";
+}
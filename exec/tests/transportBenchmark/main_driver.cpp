@@ -0,0 +1,72 @@
+#include "common_functions.H"
+#include "compressible_functions.H"
+
+#include "common_namespace_declarations.H"
+
+using namespace amrex;
+
+// Per-cell throughput of the compressible transport coefficients
+// (IdealMixtureTransport) with the runtime species count against the
+// kernels specialized for nspecies = 2-8.
+// Each of the max_step repetitions evaluates every cell of the grown grid.
+void main_driver(const char* argv)
+{
+    BL_PROFILE_VAR("main_driver()",main_driver);
+
+    std::string inputs_file = argv;
+
+    // read in parameters from inputs file into F90 modules
+    // we use "+1" because of amrex_string_c_to_f expects a null char termination
+    read_common_namelist(inputs_file.c_str(),inputs_file.size()+1);
+
+    // copy contents of F90 modules to C++ namespaces
+    InitializeCommonNamespace();
+
+    GetHcGas();
+
+    BoxArray ba;
+    {
+        IntVect dom_lo(AMREX_D_DECL(           0,            0,            0));
+        IntVect dom_hi(AMREX_D_DECL(n_cells[0]-1, n_cells[1]-1, n_cells[2]-1));
+        Box domain(dom_lo, dom_hi);
+        ba.define(domain);
+        ba.maxSize(IntVect(max_grid_size));
+    }
+    DistributionMapping dmap(ba);
+
+    // rho0, T_init(1) and mass fractions rhobar perturbed by up to 10%
+    MultiFab prim(ba,dmap,nprimvars,ngc);
+    prim.setVal(0.0);
+
+    for ( MFIter mfi(prim); mfi.isValid(); ++mfi) {
+
+        const Box& bx = mfi.growntilebox();
+        const Array4<Real>& p = prim.array(mfi);
+
+        amrex::ParallelForRNG(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k, amrex::RandomEngine const& engine) noexcept
+        {
+            GpuArray<Real,MAX_SPECIES> Yk;
+            GpuArray<Real,MAX_SPECIES> Xk;
+
+            Real sumYk = 0.;
+            for (int n=0; n<nspecies; ++n) {
+                Yk[n] = rhobar[n]*(1. + 0.2*(amrex::Random(engine)-0.5));
+                sumYk += Yk[n];
+            }
+            for (int n=0; n<nspecies; ++n) {
+                Yk[n] /= sumYk;
+            }
+            GetMolfrac(Yk, Xk);
+
+            p(i,j,k,0) = rho0;
+            p(i,j,k,4) = T_init[0];
+            GetPressureGas(p(i,j,k,5), Yk, p(i,j,k,0), p(i,j,k,4));
+            for (int n=0; n<nspecies; ++n) {
+                p(i,j,k,6+n) = Yk[n];
+                p(i,j,k,6+nspecies+n) = Xk[n];
+            }
+        });
+    }
+
+    TransportCoeffsBenchmark(prim, max_step);
+}
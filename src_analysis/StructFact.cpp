@@ -3,12 +3,18 @@
 #include "StructFact.H"
 
 #include <AMReX_MultiFabUtil.H>
+#include <AMReX_ParmParse.H>
 #include "AMReX_PlotFileUtil.H"
 #include "AMReX_BoxArray.H"
 
 StructFact::StructFact()
 {}
 
+StructFact::~StructFact()
+{
+  ClearFFTW();
+}
+
 StructFact::StructFact(const BoxArray& ba_in, const DistributionMapping& dmap_in,
 		       const Vector< std::string >& var_names,
 		       const Vector< Real >& var_scaling_in,
@@ -146,6 +152,11 @@ StructFact::StructFact(const BoxArray& ba_in, const DistributionMapping& dmap_in
     cov_names[cnt] = x;
     cnt++;
   }
+
+  // build the FFTW plans up front so sampling only executes them
+  if (fft_type == 1 || fft_type == 2) {
+      InitFFTW(ba_in, fft_type == 2);
+  }
 }
 
 StructFact::StructFact(const BoxArray& ba_in, const DistributionMapping& dmap_in,
@@ -208,6 +219,11 @@ StructFact::StructFact(const BoxArray& ba_in, const DistributionMapping& dmap_in
     cov_names[cnt] = x;
     cnt++;
   }
+
+  // build the FFTW plans up front so sampling only executes them
+  if (fft_type == 1 || fft_type == 2) {
+      InitFFTW(ba_in, fft_type == 2);
+  }
 }
 
 void StructFact::define(const BoxArray& ba_in, const DistributionMapping& dmap_in,
@@ -270,6 +286,11 @@ void StructFact::define(const BoxArray& ba_in, const DistributionMapping& dmap_i
     cov_names[cnt] = x;
     cnt++;
   }
+
+  // build the FFTW plans up front so sampling only executes them
+  if (fft_type == 1 || fft_type == 2) {
+      InitFFTW(ba_in, fft_type == 2);
+  }
 }
 
 void StructFact::FortStructure(const MultiFab& variables, const Geometry& geom,
@@ -284,8 +305,11 @@ void StructFact::FortStructure(const MultiFab& variables, const Geometry& geom,
   variables_dft_real.define(ba, dm, NVAR, 0);
   variables_dft_imag.define(ba, dm, NVAR, 0);
 
-  if (fft_type_in == 1) {
+  if (fft_type_in == 1 || fft_type_in == 2) {
       Print() << "Using FFTW\n";
+      if (fftw_mode != fft_type_in) {
+          InitFFTW(ba, fft_type_in == 2);
+      }
       ComputeFFTW(variables, variables_dft_real, variables_dft_imag, geom);
   }
   else if (ba.size() == ParallelDescriptor::NProcs()) {
@@ -326,41 +350,51 @@ void StructFact::FortStructure(const MultiFab& variables, const Geometry& geom,
       variables_dft_imag.ParallelCopy(variables_dft_imag_temp, 0, 0, NVAR);
   }
 
-  MultiFab cov_temp;
-  cov_temp.define(ba, dm, 1, 0);
-
-  int index = 0;
-  for (int n=0; n<NCOV; n++) {
-    int i = s_pairA[n];
-    int j = s_pairB[n];
-    
-    // Compute temporary real and imaginary components of covariance
-
-    // Real component of covariance
-    cov_temp.setVal(0.0);
-    MultiFab::AddProduct(cov_temp,variables_dft_real,i,variables_dft_real,j,0,1,0);
-    MultiFab::AddProduct(cov_temp,variables_dft_imag,i,variables_dft_imag,j,0,1,0);
-
-    if (reset == 1) {
-        MultiFab::Copy(cov_real,cov_temp,0,index,1,0);
-    } else {
-        MultiFab::Add(cov_real,cov_temp,0,index,1,0);
-    }
-
-    // Imaginary component of covariance
-    cov_temp.setVal(0.0);
-    MultiFab::AddProduct(cov_temp,variables_dft_imag,i,variables_dft_real,j,0,1,0);
-    cov_temp.mult(-1.0,0);
-    MultiFab::AddProduct(cov_temp,variables_dft_real,i,variables_dft_imag,j,0,1,0);
-
-    if (reset == 1) {
-        MultiFab::Copy(cov_imag,cov_temp,0,index,1,0);
-    } else {
-        MultiFab::Add(cov_imag,cov_temp,0,index,1,0);
-    }
-
-    index++;
-
+  // Accumulate the real and imaginary parts of all NCOV covariances in a
+  // single tiled pass over the spectra
+  Gpu::DeviceVector<int> pairA_d(NCOV);
+  Gpu::DeviceVector<int> pairB_d(NCOV);
+  Gpu::copy(Gpu::hostToDevice, s_pairA.begin(), s_pairA.end(), pairA_d.begin());
+  Gpu::copy(Gpu::hostToDevice, s_pairB.begin(), s_pairB.end(), pairB_d.begin());
+  const int* pairA = pairA_d.dataPtr();
+  const int* pairB = pairB_d.dataPtr();
+
+  const int ncov = NCOV;
+  const bool overwrite = (reset == 1);
+
+  for (MFIter mfi(cov_real,TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+
+      const Box& bx = mfi.tilebox();
+
+      const Array4<const Real>& dft_real = variables_dft_real.const_array(mfi);
+      const Array4<const Real>& dft_imag = variables_dft_imag.const_array(mfi);
+      const Array4<Real>& cr = cov_real.array(mfi);
+      const Array4<Real>& ci = cov_imag.array(mfi);
+
+      amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+      {
+          for (int n=0; n<ncov; ++n) {
+              const int a = pairA[n];
+              const int b = pairB[n];
+
+              const Real re_a = dft_real(i,j,k,a);
+              const Real im_a = dft_imag(i,j,k,a);
+              const Real re_b = dft_real(i,j,k,b);
+              const Real im_b = dft_imag(i,j,k,b);
+
+              // conj(a) * b
+              const Real cov_re = re_a*re_b + im_a*im_b;
+              const Real cov_im = re_a*im_b - im_a*re_b;
+
+              if (overwrite) {
+                  cr(i,j,k,n) = cov_re;
+                  ci(i,j,k,n) = cov_im;
+              } else {
+                  cr(i,j,k,n) += cov_re;
+                  ci(i,j,k,n) += cov_im;
+              }
+          }
+      });
   }
 
   bool write_data = false;
@@ -585,149 +619,225 @@ void StructFact::ComputeSWFFT(const MultiFab& variables,
 }
 
 
-void StructFact::ComputeFFTW(const MultiFab& variables,
-                             MultiFab& variables_dft_real, 
-                             MultiFab& variables_dft_imag,
-                             const Geometry& geom) {
+void StructFact::InitFFTW(const BoxArray& ba_in, const int& distributed) {
 
-    bool is_flattened = false;
+    BL_PROFILE_VAR("StructFact::InitFFTW()",InitFFTW);
 
-    long npts;
+    ClearFFTW();
 
-    // Initialize the boxarray "ba_onegrid" from the single box "domain"
-    BoxArray ba_onegrid;
-    {
-      Box domain = geom.Domain();
-      ba_onegrid.define(domain);
+    ParmParse pp("structfact");
+    pp.query("fftw_planner",fftw_planner);
+    pp.query("fftw_wisdom_file",fftw_wisdom_file);
 
-      if (domain.bigEnd(AMREX_SPACEDIM-1) == 0) {
-          is_flattened = true;
-      }
+    unsigned flags = FFTW_ESTIMATE;
+    if (fftw_planner == 1) {
+        flags = FFTW_MEASURE;
+    } else if (fftw_planner == 2) {
+        flags = FFTW_PATIENT;
+    }
+
+    Box domain = ba_in.minimalBox();
+
+    fftw_is_flattened = (domain.length(AMREX_SPACEDIM-1) == 1);
+    fftw_npts = domain.numPts();
 
+    // transform dimensions in row-major (FFTW) order
+    int rnk;
+    int n[3];
 #if (AMREX_SPACEDIM == 2)
-      npts = (domain.length(0)*domain.length(1));
+    if (fftw_is_flattened) {
+        rnk = 1;
+        n[0] = domain.length(0);
+    } else {
+        rnk = 2;
+        n[0] = domain.length(1);
+        n[1] = domain.length(0);
+    }
 #elif (AMREX_SPACEDIM == 3)
-      npts = (domain.length(0)*domain.length(1)*domain.length(2));
+    if (fftw_is_flattened) {
+        rnk = 2;
+        n[0] = domain.length(1);
+        n[1] = domain.length(0);
+    } else {
+        rnk = 3;
+        n[0] = domain.length(2);
+        n[1] = domain.length(1);
+        n[2] = domain.length(0);
+    }
 #endif
 
+    // the slowest FFTW dimension is the one split across ranks
+    const int slab_dir = (rnk == 3) ? 2 : 1;
+
+    MPI_Comm comm = ParallelDescriptor::Communicator();
+    const bool use_wisdom = !fftw_wisdom_file.empty();
+
+    if (distributed && rnk == 1) {
+        Print() << "StructFact::InitFFTW() - 1D transforms are not distributed; using a single grid\n";
     }
 
-    Real sqrtnpts = std::sqrt(npts);
+    if (distributed && rnk > 1) {
 
-    DistributionMapping dmap_onegrid(ba_onegrid);
+        fftw_mpi_init();
 
-    // we will take one FFT at a time and copy the answer into the
-    // corresponding component
-    MultiFab variables_onegrid;
-    MultiFab variables_dft_real_onegrid;
-    MultiFab variables_dft_imag_onegrid;
-    variables_onegrid.define(ba_onegrid, dmap_onegrid, 1, 0);
-    variables_dft_real_onegrid.define(ba_onegrid, dmap_onegrid, 1, 0);
-    variables_dft_imag_onegrid.define(ba_onegrid, dmap_onegrid, 1, 0);
+        ptrdiff_t nn[3];
+        for (int d=0; d<rnk; ++d) {
+            nn[d] = n[d];
+        }
 
-//    fftw_mpi_init();
-    
-    using FFTplan = fftw_plan;
-    using FFTcomplex = fftw_complex;
+        ptrdiff_t local_n0, local_0_start;
+        ptrdiff_t alloc_local = fftw_mpi_local_size_many(rnk, nn, NVARU, FFTW_MPI_DEFAULT_BLOCK,
+                                                         comm, &local_n0, &local_0_start);
+
+        // gather the slab decomposition chosen by fftw-mpi
+        const int nprocs = ParallelDescriptor::NProcs();
+        const int myproc = ParallelDescriptor::MyProc();
+        Vector<int> slab_n(nprocs,0);
+        Vector<int> slab_lo(nprocs,0);
+        slab_n[myproc] = local_n0;
+        slab_lo[myproc] = local_0_start;
+        ParallelDescriptor::ReduceIntSum(slab_n.dataPtr(),nprocs);
+        ParallelDescriptor::ReduceIntSum(slab_lo.dataPtr(),nprocs);
+
+        BoxList bl;
+        Vector<int> pmap;
+        for (int p=0; p<nprocs; ++p) {
+            if (slab_n[p] > 0) {
+                Box bx = domain;
+                bx.setSmall(slab_dir, domain.smallEnd(slab_dir) + slab_lo[p]);
+                bx.setBig  (slab_dir, domain.smallEnd(slab_dir) + slab_lo[p] + slab_n[p] - 1);
+                bl.push_back(bx);
+                pmap.push_back(p);
+            }
+        }
+        ba_fft.define(bl);
+        dm_fft.define(pmap);
 
-    // contain to store FFT - note it is shrunk by "half" in x
-    Vector<std::unique_ptr<BaseFab<GpuComplex<Real> > > > spectral_field;
+        fftw_data = fftw_alloc_complex(amrex::max(alloc_local,(ptrdiff_t) 1));
 
-    Vector<FFTplan> forward_plan;
+        if (use_wisdom) {
+            if (ParallelDescriptor::IOProcessor()) {
+                fftw_import_wisdom_from_filename(fftw_wisdom_file.c_str());
+            }
+            fftw_mpi_broadcast_wisdom(comm);
+        }
 
-    for (int comp=0; comp<NVAR; comp++) {
+        fftw_forward_plan = fftw_mpi_plan_many_dft(rnk, nn, NVARU,
+                                                   FFTW_MPI_DEFAULT_BLOCK, FFTW_MPI_DEFAULT_BLOCK,
+                                                   fftw_data, fftw_data, comm,
+                                                   FFTW_FORWARD, flags);
 
-        bool comp_fft = false;
-        for (int i=0; i<NVARU; i++) {
-            if (comp == var_u[i]) {
-                comp_fft = true;
-                break;
+        if (use_wisdom) {
+            fftw_mpi_gather_wisdom(comm);
+            if (ParallelDescriptor::IOProcessor()) {
+                fftw_export_wisdom_to_filename(fftw_wisdom_file.c_str());
             }
         }
 
-        variables_onegrid.ParallelCopy(variables,comp,0,1);
+        fftw_mode = 2;
 
-        for (MFIter mfi(variables_onegrid); mfi.isValid(); ++mfi) {
+    } else {
 
-            // grab a single box including ghost cell range
-            Box realspace_bx = mfi.fabbox();
+        ba_fft.define(domain);
+        dm_fft.define(ba_fft);
+
+        fftw_mode = 1;
+    }
+
+    variables_fft.define(ba_fft, dm_fft, NVARU, 0);
+    dft_real_fft.define(ba_fft, dm_fft, NVARU, 0);
+    dft_imag_fft.define(ba_fft, dm_fft, NVARU, 0);
 
-            // size of box including ghost cell range
-            IntVect fft_size = realspace_bx.length(); // This will be different for hybrid FFT
+    if (fftw_mode == 1) {
+
+        // only the rank owning the single grid plans and transforms
+        for (MFIter mfi(variables_fft); mfi.isValid(); ++mfi) {
+
+            Box realspace_bx = mfi.fabbox();
 
             // this is the size of the box, except the 0th component is 'halved plus 1'
-            IntVect spectral_bx_size = fft_size;
-            spectral_bx_size[0] = fft_size[0]/2 + 1;
+            IntVect spectral_bx_size = realspace_bx.length();
+            spectral_bx_size[0] = spectral_bx_size[0]/2 + 1;
 
-            // spectral box
             Box spectral_bx = Box(IntVect(0), spectral_bx_size - IntVect(1));
 
-            spectral_field.emplace_back(new BaseFab<GpuComplex<Real> >(spectral_bx,1,
-                                                                       The_Device_Arena()));
-            spectral_field.back()->setVal<RunOn::Device>(0.0); // touch the memory
+            spectral_fft.reset(new BaseFab<GpuComplex<Real> >(spectral_bx,NVARU,The_Device_Arena()));
+            spectral_fft->setVal<RunOn::Device>(0.0); // touch the memory
 
-            FFTplan fplan;
-
-            if (is_flattened) {
-#if (AMREX_SPACEDIM == 2)
-                fplan = fftw_plan_dft_r2c_1d(fft_size[0],
-                                             variables_onegrid[mfi].dataPtr(),
-                                             reinterpret_cast<FFTcomplex*>
-                                             (spectral_field.back()->dataPtr()),
-                                             FFTW_ESTIMATE);
-#elif (AMREX_SPACEDIM == 3)
-                fplan = fftw_plan_dft_r2c_2d(fft_size[1], fft_size[0],
-                                             variables_onegrid[mfi].dataPtr(),
-                                             reinterpret_cast<FFTcomplex*>
-                                             (spectral_field.back()->dataPtr()),
-                                             FFTW_ESTIMATE);
-#endif
-            } else {
-#if (AMREX_SPACEDIM == 2)
-                fplan = fftw_plan_dft_r2c_2d(fft_size[1], fft_size[0],
-                                             variables_onegrid[mfi].dataPtr(),
-                                             reinterpret_cast<FFTcomplex*>
-                                             (spectral_field.back()->dataPtr()),
-                                             FFTW_ESTIMATE);
-#elif (AMREX_SPACEDIM == 3)
-                fplan = fftw_plan_dft_r2c_3d(fft_size[2], fft_size[1], fft_size[0],
-                                             variables_onegrid[mfi].dataPtr(),
-                                             reinterpret_cast<FFTcomplex*>
-                                             (spectral_field.back()->dataPtr()),
-                                             FFTW_ESTIMATE);
-#endif
+            if (use_wisdom) {
+                fftw_import_wisdom_from_filename(fftw_wisdom_file.c_str());
             }
 
-            forward_plan.push_back(fplan);
+            // fields are stored component by component, so the batch stride is one field
+            fftw_forward_plan = fftw_plan_many_dft_r2c(rnk, n, NVARU,
+                                                       variables_fft[mfi].dataPtr(), NULL, 1, realspace_bx.numPts(),
+                                                       reinterpret_cast<fftw_complex*>(spectral_fft->dataPtr()),
+                                                       NULL, 1, spectral_bx.numPts(),
+                                                       flags);
+
+            if (use_wisdom) {
+                fftw_export_wisdom_to_filename(fftw_wisdom_file.c_str());
+            }
         }
+    }
+}
+
+void StructFact::ClearFFTW() {
 
-        ParallelDescriptor::Barrier();
+    if (fftw_forward_plan) {
+        fftw_destroy_plan(fftw_forward_plan);
+        fftw_forward_plan = nullptr;
+    }
+    if (fftw_data) {
+        fftw_free(fftw_data);
+        fftw_data = nullptr;
+    }
+    spectral_fft.reset();
+    fftw_mode = 0;
+}
+
+void StructFact::ComputeFFTW(const MultiFab& variables,
+                             MultiFab& variables_dft_real, 
+                             MultiFab& variables_dft_imag,
+                             const Geometry& geom) {
+
+    BL_PROFILE_VAR("StructFact::ComputeFFTW()",ComputeFFTW);
+
+    bool is_flattened = fftw_is_flattened;
+
+    Real sqrtnpts = std::sqrt(fftw_npts);
 
-        // ForwardTransform
-        for (MFIter mfi(variables_onegrid); mfi.isValid(); ++mfi) {
-            int i = mfi.LocalIndex();
-            fftw_execute(forward_plan[i]);
+    // gather the unique variables onto the FFT layout
+    for (int n=0; n<NVARU; n++) {
+        variables_fft.ParallelCopy(variables,var_u[n],n,1);
+    }
+
+    if (fftw_mode == 1) {
+
+        // ForwardTransform of all unique variables in one batched plan
+        for (MFIter mfi(variables_fft); mfi.isValid(); ++mfi) {
+            fftw_execute(fftw_forward_plan);
         }
 
         // copy data to a full-sized MultiFab
         // this involves copying the complex conjugate from the half-sized field
         // into the appropriate place in the full MultiFab
-        for (MFIter mfi(variables_dft_real_onegrid); mfi.isValid(); ++mfi) {
+        for (MFIter mfi(dft_real_fft); mfi.isValid(); ++mfi) {
 
-            Array4< GpuComplex<Real> > spectral = (*spectral_field[0]).array();
+            Array4< GpuComplex<Real> > spectral = spectral_fft->array();
 
-            Array4<Real> const& realpart = variables_dft_real_onegrid.array(mfi);
-            Array4<Real> const& imagpart = variables_dft_imag_onegrid.array(mfi);
+            Array4<Real> const& realpart = dft_real_fft.array(mfi);
+            Array4<Real> const& imagpart = dft_imag_fft.array(mfi);
 
             Box bx = mfi.fabbox();
 
-            amrex::ParallelFor(bx,
-            [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+            amrex::ParallelFor(bx, NVARU,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
             {
                 if (i <= bx.length(0)/2) {
                     // copy value
-                    realpart(i,j,k) = spectral(i,j,k).real();
-                    imagpart(i,j,k) = spectral(i,j,k).imag();
+                    realpart(i,j,k,n) = spectral(i,j,k,n).real();
+                    imagpart(i,j,k,n) = spectral(i,j,k,n).imag();
                 } else {
                     // copy complex conjugate
                     int iloc = bx.length(0)-i;
@@ -748,37 +858,62 @@ void StructFact::ComputeFFTW(const MultiFab& variables,
 #endif
                     }
 
-                    realpart(i,j,k) =  spectral(iloc,jloc,kloc).real();
-                    imagpart(i,j,k) = -spectral(iloc,jloc,kloc).imag();
+                    realpart(i,j,k,n) =  spectral(iloc,jloc,kloc,n).real();
+                    imagpart(i,j,k,n) = -spectral(iloc,jloc,kloc,n).imag();
                 }
 
-                realpart(i,j,k) /= sqrtnpts;
-                imagpart(i,j,k) /= sqrtnpts;
+                realpart(i,j,k,n) /= sqrtnpts;
+                imagpart(i,j,k,n) /= sqrtnpts;
             });
+        }
+
+    } else {
 
-            /*
-            amrex::ParallelFor(bx,
-            [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+        const int nvaru = NVARU;
+
+        // pack the local slab, fields interleaved, into the fftw-mpi buffer
+        for (MFIter mfi(variables_fft); mfi.isValid(); ++mfi) {
+
+            const Box& bx = mfi.validbox();
+            const Array4<const Real>& var = variables_fft.const_array(mfi);
+            const Dim3 lo = amrex::lbound(bx);
+            const Dim3 len = amrex::length(bx);
+            fftw_complex* data = fftw_data;
+
+            amrex::LoopOnCpu(bx, nvaru, [=] (int i, int j, int k, int n) noexcept
             {
-                std::cout << "HACKFFT " << i << " " << j << " " << k << " "
-                          << realpart(i,j,k) << " + " << imagpart(i,j,k) << "i"
-                          << std::endl;
+                long cell = (long(k-lo.z)*len.y + (j-lo.y))*len.x + (i-lo.x);
+                data[cell*nvaru+n][0] = var(i,j,k,n);
+                data[cell*nvaru+n][1] = 0.;
             });
-            */
         }
 
-        variables_dft_real.ParallelCopy(variables_dft_real_onegrid,0,comp,1);
-        variables_dft_imag.ParallelCopy(variables_dft_imag_onegrid,0,comp,1);
+        // ForwardTransform of all unique variables in one batched plan;
+        // collective over all ranks, including those that own no slab
+        fftw_execute(fftw_forward_plan);
 
-    }
+        for (MFIter mfi(dft_real_fft); mfi.isValid(); ++mfi) {
 
-    // destroy fft plan
-    for (int i = 0; i < forward_plan.size(); ++i) {
-        fftw_destroy_plan(forward_plan[i]);
-    }
+            const Box& bx = mfi.validbox();
+            const Array4<Real>& realpart = dft_real_fft.array(mfi);
+            const Array4<Real>& imagpart = dft_imag_fft.array(mfi);
+            const Dim3 lo = amrex::lbound(bx);
+            const Dim3 len = amrex::length(bx);
+            const fftw_complex* data = fftw_data;
 
-//    fftw_mpi_cleanup();
+            amrex::LoopOnCpu(bx, nvaru, [=] (int i, int j, int k, int n) noexcept
+            {
+                long cell = (long(k-lo.z)*len.y + (j-lo.y))*len.x + (i-lo.x);
+                realpart(i,j,k,n) = data[cell*nvaru+n][0] / sqrtnpts;
+                imagpart(i,j,k,n) = data[cell*nvaru+n][1] / sqrtnpts;
+            });
+        }
+    }
 
+    for (int n=0; n<NVARU; n++) {
+        variables_dft_real.ParallelCopy(dft_real_fft,n,var_u[n],1);
+        variables_dft_imag.ParallelCopy(dft_imag_fft,n,var_u[n],1);
+    }
 }
 
 void StructFact::WritePlotFile(const int step, const Real time, const Geometry& geom,
@@ -989,48 +1124,27 @@ void StructFact::ShiftFFT(MultiFab& dft_out, const Geometry& geom, const int& ze
 
 }
 
-// integrate cov_mag over k shells
-void StructFact::IntegratekShells(const int& step, const Geometry& geom) {
+// compute the k-shell / angular sector bin of each cell of cov_mag
+// shells are unit width in k, centered on the zero mode (n_cells/2 after ShiftFFT);
+// sectors split |cos(theta)| = |k_z|/|k| (|k_y|/|k| in 2D) evenly into nsectors
+void StructFact::BuildkShellBins(const int& nsectors) {
 
-    BL_PROFILE_VAR("StructFact::IntegratekShells",IntegratekShells);
+    BL_PROFILE_VAR("StructFact::BuildkShellBins",BuildkShellBins);
 
     GpuArray<int,AMREX_SPACEDIM> center;
     for (int d=0; d<AMREX_SPACEDIM; ++d) {
         center[d] = n_cells[d]/2;
     }
 
-    int npts = n_cells[0]/2-1;
-    int npts_sq = npts*npts;
-
-    Gpu::DeviceVector<Real> phisum_vect(npts);
-    Gpu::DeviceVector<int>  phicnt_vect(npts);
-
-//    Gpu::DeviceVector<Real> phisum_vect_large(npts_sq);
-//    Gpu::DeviceVector<int>  phicnt_vect_large(npts_sq);
-
-    for (int d=0; d<npts; ++d) {
-        phisum_vect[d] = 0.;
-        phicnt_vect[d] = 0;
-    }
+    kshell_bin.define(cov_mag.boxArray(), cov_mag.DistributionMap(), 1, 0);
+    kshell_nsectors = nsectors;
+    kshell_nbins = (center[0]+1)*nsectors;
 
-//    for (int d=0; d<npts_sq; ++d) {
-//        phisum_vect_large[d] = 0.;
-//        phicnt_vect_large[d] = 0;
-//    }
-    
-    Real* phisum_gpu = phisum_vect.dataPtr();  // pointer to data
-    int*  phicnt_gpu = phicnt_vect.dataPtr();  // pointer to data
-    
-  //  Real* phisum_large_gpu = phisum_vect_large.dataPtr();  // pointer to data
- //   int*  phicnt_large_gpu = phicnt_vect_large.dataPtr();  // pointer to data
+    for ( MFIter mfi(kshell_bin,TilingIfNotGPU()); mfi.isValid(); ++mfi ) {
 
-    // only consider cells that are within 15k of the center point
-    
-    for ( MFIter mfi(cov_mag,TilingIfNotGPU()); mfi.isValid(); ++mfi ) {
-        
         const Box& bx = mfi.tilebox();
 
-        const Array4<Real> & cov = cov_mag.array(mfi);
+        const Array4<int> & bin = kshell_bin.array(mfi);
 
         amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
         {
@@ -1038,81 +1152,135 @@ void StructFact::IntegratekShells(const int& step, const Geometry& geom) {
             int jlen = amrex::Math::abs(j-center[1]);
             int klen = (AMREX_SPACEDIM == 3) ? amrex::Math::abs(k-center[2]) : 0;
 
-            Real dist = (ilen*ilen + jlen*jlen + klen*klen);
- //           int idist = (ilen*ilen + jlen*jlen + klen*klen);
-            dist = std::sqrt(dist);
-            
+            Real dist = std::sqrt(Real(ilen*ilen + jlen*jlen + klen*klen));
+
             if ( dist <= center[0]-0.5) {
-	        dist = dist+0.5;
-                int cell = int(dist);
-                for (int d=0; d<AMREX_SPACEDIM; ++d) {
-                    phisum_gpu[cell] += cov(i,j,k,d);
-//		    phisum_large_gpu[idist]  += cov(i,j,k,d);
+                int cell = int(dist+0.5);
+
+                int sector = 0;
+                if (nsectors > 1 && dist > 0.) {
+                    Real costheta = (AMREX_SPACEDIM == 3) ? klen/dist : jlen/dist;
+                    sector = amrex::min(int(costheta*nsectors), nsectors-1);
                 }
-                ++phicnt_gpu[cell];
- //               ++phicnt_large_gpu[idist];
+                bin(i,j,k) = cell*nsectors + sector;
+            } else {
+                bin(i,j,k) = -1;
             }
         });
     }
-        
-    for (int d=1; d<npts; ++d) {
-        ParallelDescriptor::ReduceRealSum(phisum_vect[d]);
-        ParallelDescriptor::ReduceIntSum(phicnt_vect[d]);
+}
+
+// integrate cov_mag over k shells (and optionally angular sectors)
+void StructFact::IntegratekShells(const int& step, const Geometry& geom, const int& nsectors) {
+
+    BL_PROFILE_VAR("StructFact::IntegratekShells",IntegratekShells);
+
+    if (kshell_nsectors != nsectors || kshell_bin.boxArray() != cov_mag.boxArray()) {
+        BuildkShellBins(nsectors);
     }
-        
-#if 0
-    for (int d=1; d<npts_sq; ++d) {
-        ParallelDescriptor::ReduceRealSum(phisum_vect_large[d]);
-        ParallelDescriptor::ReduceIntSum(phicnt_vect_large[d]);
+
+    const int nbins = kshell_nbins;
+    int npts = n_cells[0]/2-1;
+
+    // sums followed by counts, so both go out in one reduction
+    Vector<Real> phisum(2*nbins, 0.);
+
+#ifdef AMREX_USE_GPU
+    Gpu::DeviceVector<Real> phisum_vect(2*nbins, 0.);
+    Real* phisum_gpu = phisum_vect.dataPtr();  // pointer to data
+
+    for ( MFIter mfi(cov_mag,TilingIfNotGPU()); mfi.isValid(); ++mfi ) {
+
+        const Box& bx = mfi.tilebox();
+
+        const Array4<const Real> & cov = cov_mag.const_array(mfi);
+        const Array4<const int> & bin = kshell_bin.const_array(mfi);
+
+        amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+        {
+            const int b = bin(i,j,k);
+            if (b >= 0) {
+                Real val = 0.;
+                for (int d=0; d<AMREX_SPACEDIM; ++d) {
+                    val += cov(i,j,k,d);
+                }
+                Gpu::Atomic::Add(&phisum_gpu[b], val);
+                Gpu::Atomic::Add(&phisum_gpu[nbins+b], 1.);
+            }
+        });
     }
 
-    if (ParallelDescriptor::IOProcessor()) {
-        std::ofstream turb_disc;
-        std::string turbNamedisc = "turb_disc";
-        turbNamedisc += std::to_string(step);
-        turbNamedisc += ".txt";
-        
-        turb_disc.open(turbNamedisc);
-        for (int d=1; d<npts_sq; ++d) {
-	    if(phicnt_vect_large[d]>0) {
-		Real dreal = d;
-                turb_disc << sqrt(dreal) << " " << 4.*M_PI*d*phisum_vect_large[d]/phicnt_vect_large[d] << std::endl;
-	    }
+    Gpu::copy(Gpu::deviceToHost, phisum_vect.begin(), phisum_vect.end(), phisum.begin());
+#else
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+        // thread-private partial histogram, merged once below
+        Vector<Real> phisum_local(2*nbins, 0.);
+
+        for ( MFIter mfi(cov_mag,TilingIfNotGPU()); mfi.isValid(); ++mfi ) {
+
+            const Box& bx = mfi.tilebox();
+
+            const Array4<const Real> & cov = cov_mag.const_array(mfi);
+            const Array4<const int> & bin = kshell_bin.const_array(mfi);
+
+            amrex::LoopOnCpu(bx, [&] (int i, int j, int k) noexcept
+            {
+                const int b = bin(i,j,k);
+                if (b >= 0) {
+                    for (int d=0; d<AMREX_SPACEDIM; ++d) {
+                        phisum_local[b] += cov(i,j,k,d);
+                    }
+                    phisum_local[nbins+b] += 1.;
+                }
+            });
         }
-    }
 
-    Real dk = 1.;
-    if (ParallelDescriptor::IOProcessor()) {
-        std::ofstream turb_alt;
-        std::string turbNamealt = "turb_alt";
-        turbNamealt += std::to_string(step);
-        turbNamealt += ".txt";
-        
-        turb_alt.open(turbNamealt);
-        for (int d=1; d<npts; ++d) {
-            turb_alt << d << " " << phisum_vect[d] << std::endl;
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+        for (int b=0; b<2*nbins; ++b) {
+            phisum[b] += phisum_local[b];
         }
     }
 #endif
 
+    ParallelDescriptor::ReduceRealSum(phisum.dataPtr(),2*nbins);
+
     Real dk = 1.;
-    
-#if (AMREX_SPACEDIM == 2)
+
+    // shell totals (all sectors) and per-sector averages
+    Vector<Real> phisum_vect(npts, 0.);
+    Vector<Real> phisector(npts*nsectors, 0.);
+
     for (int d=1; d<npts; ++d) {
-      //  phisum_vect[d] *= 2.*M_PI*d*dk*dk/phicnt_vect[d];
-        phisum_vect[d] *= 2.*M_PI*(d*dk+.5*dk*dk)/phicnt_vect[d];
-    }
+
+        Real sum = 0.;
+        Real cnt = 0.;
+        for (int s=0; s<nsectors; ++s) {
+            sum += phisum[d*nsectors+s];
+            cnt += phisum[nbins+d*nsectors+s];
+        }
+
+#if (AMREX_SPACEDIM == 2)
+        Real shellvol = 2.*M_PI*(d*dk+.5*dk*dk);
 #else
-    for (int d=1; d<npts; ++d) {
-      //  phisum_vect[d] *= 4.*M_PI*(d*d)*dk*dk*dk/phicnt_vect[d];
-      //  phisum_vect[d] *= 4.*M_PI*(d*d*dk+d*dk*dk+dk*dk*dk/3.)/phicnt_vect[d];
-        phisum_vect[d] *= 4.*M_PI*(d*d*dk+dk*dk*dk/12.)/phicnt_vect[d];
-    }
+        Real shellvol = 4.*M_PI*(d*d*dk+dk*dk*dk/12.);
 #endif
+        phisum_vect[d] = (cnt > 0.) ? sum*shellvol/cnt : 0.;
+
+        for (int s=0; s<nsectors; ++s) {
+            Real scnt = phisum[nbins+d*nsectors+s];
+            phisector[d*nsectors+s] = (scnt > 0.) ? phisum[d*nsectors+s]*shellvol/scnt : 0.;
+        }
+    }
+
     if (ParallelDescriptor::IOProcessor()) {
         std::ofstream turb;
         std::string turbBaseName = "turb";
-        //turbName += std::to_string(step);
         std::string turbName = Concatenate(turbBaseName,step,7);
         turbName += ".txt";
         
@@ -1120,5 +1288,20 @@ void StructFact::IntegratekShells(const int& step, const Geometry& geom) {
         for (int d=1; d<npts; ++d) {
             turb << d << " " << phisum_vect[d] << std::endl;
         }
+
+        if (nsectors > 1) {
+            std::ofstream turbs;
+            std::string turbSectorName = Concatenate("turb_sectors",step,7);
+            turbSectorName += ".txt";
+
+            turbs.open(turbSectorName);
+            for (int d=1; d<npts; ++d) {
+                turbs << d;
+                for (int s=0; s<nsectors; ++s) {
+                    turbs << " " << phisector[d*nsectors+s];
+                }
+                turbs << std::endl;
+            }
+        }
     }
 }
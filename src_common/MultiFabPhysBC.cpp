@@ -218,7 +218,9 @@ void MultiFabPhysBC(MultiFab& phi, const Geometry& geom, int scomp, int ncomp, i
 // Set the value of normal ghost cells to the inverse reflection of the interior.
 // We fill all the ghost cells - they are needed for Perskin kernels and
 // to avoid intermediate NaN propagation in BDS.
-void MultiFabPhysBCDomainVel(MultiFab& vel, const Geometry& geom, int dim) {
+// MF is a MultiFab or the single-precision FabArray used by StagMGSolver.
+template <class MF>
+void MultiFabPhysBCDomainVel(MF& vel, const Geometry& geom, int dim) {
 
     BL_PROFILE_VAR("MultiFabPhysBCDomainVel()",MultiFabPhysBCDomainVel);
     
@@ -234,7 +236,7 @@ void MultiFabPhysBCDomainVel(MultiFab& vel, const Geometry& geom, int dim) {
 
         Box bx = mfi.growntilebox(ng);
 
-        const Array4<Real>& data = vel.array(mfi);
+        const auto& data = vel.array(mfi);
 
         //___________________________________________________________________________
         // Apply x-physbc to data
@@ -347,7 +349,8 @@ void MultiFabPhysBCDomainVel(MultiFab& vel, const Geometry& geom, int dim) {
 // Set the value of tranverse ghost cells to +/- the reflection of the interior
 // (+ for slip walls, - for no-slip).
 // We fill all the ghost cells - they are needed for Perskin kernels.
-void MultiFabPhysBCMacVel(MultiFab& vel, const Geometry& geom, int dim) {
+template <class MF>
+void MultiFabPhysBCMacVel(MF& vel, const Geometry& geom, int dim) {
 
     BL_PROFILE_VAR("MultiFabPhysBCMacVel()",MultiFabPhysBCMacVel);
     
@@ -363,7 +366,7 @@ void MultiFabPhysBCMacVel(MultiFab& vel, const Geometry& geom, int dim) {
 
         Box bx = mfi.growntilebox(ng);
 
-        const Array4<Real>& data = vel.array(mfi);
+        const auto& data = vel.array(mfi);
 
         //___________________________________________________________________________
         // Apply x-physbc to data
@@ -443,6 +446,11 @@ void MultiFabPhysBCMacVel(MultiFab& vel, const Geometry& geom, int dim) {
     } // end MFIter
 }
 
+template void MultiFabPhysBCDomainVel<MultiFab>(MultiFab&, const Geometry&, int);
+template void MultiFabPhysBCDomainVel<FabArray<BaseFab<float> > >(FabArray<BaseFab<float> >&, const Geometry&, int);
+template void MultiFabPhysBCMacVel<MultiFab>(MultiFab&, const Geometry&, int);
+template void MultiFabPhysBCMacVel<FabArray<BaseFab<float> > >(FabArray<BaseFab<float> >&, const Geometry&, int);
+
 // Boundary filling routine for normal velocity.
 // Set the value of normal velocity on walls to zero.
 // Works for slip and no-slip (bc_vel_lo/hi = 1 or 2).
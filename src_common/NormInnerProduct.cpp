@@ -156,6 +156,138 @@ void CCInnerProd(const amrex::MultiFab& m1,
   SumCC(mscr,0,prod_val,false);
 }
 
+// processor-local products <w,V(n)>, n = 0..nvec-1, followed by <w,w> if
+// include_norm, all accumulated in one sweep over w and V and added to
+// prod_val scaled by scale.  For dir >= 0 (faces normal to dir) the faces on
+// the boundary of each grid are weighted by 1/2, as in SumStag
+static void LocalMultiDot(const MultiFab& w,
+                          const int wcomp,
+                          const MultiFab& V,
+                          const int nvec,
+                          const bool include_norm,
+                          const int dir,
+                          const Real scale,
+                          Vector<Real>& prod_val)
+{
+  const int nprod = include_norm ? nvec+1 : nvec;
+
+  Vector<Real> sum(nprod, 0.);
+
+#ifdef AMREX_USE_GPU
+  Gpu::DeviceVector<Real> sum_vect(nprod, 0.);
+  Real* sum_gpu = sum_vect.dataPtr();
+
+  for (MFIter mfi(w,TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+
+      const Box& bx = mfi.tilebox();
+      const Box& bx_grid = mfi.validbox();
+
+      const Array4<const Real>& wa = w.const_array(mfi);
+      const Array4<const Real>& Va = V.const_array(mfi);
+
+      const int lo = (dir >= 0) ? bx_grid.smallEnd(dir) : 0;
+      const int hi = (dir >= 0) ? bx_grid.bigEnd(dir) : 0;
+
+      amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+      {
+          Real weight = 1.;
+          if (dir >= 0) {
+              const int idx = (dir == 0) ? i : ((dir == 1) ? j : k);
+              weight = (idx>lo && idx<hi) ? 1.0 : 0.5;
+          }
+          const Real ww = weight*wa(i,j,k,wcomp);
+          for (int n=0; n<nvec; ++n) {
+              Gpu::Atomic::Add(&sum_gpu[n], ww*Va(i,j,k,n));
+          }
+          if (include_norm) {
+              Gpu::Atomic::Add(&sum_gpu[nvec], ww*wa(i,j,k,wcomp));
+          }
+      });
+  }
+
+  Gpu::copy(Gpu::deviceToHost, sum_vect.begin(), sum_vect.end(), sum.begin());
+#else
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+  {
+      // thread-private partial sums, merged once below
+      Vector<Real> sum_local(nprod, 0.);
+
+      for (MFIter mfi(w,TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+
+          const Box& bx = mfi.tilebox();
+          const Box& bx_grid = mfi.validbox();
+
+          const Array4<const Real>& wa = w.const_array(mfi);
+          const Array4<const Real>& Va = V.const_array(mfi);
+
+          const int lo = (dir >= 0) ? bx_grid.smallEnd(dir) : 0;
+          const int hi = (dir >= 0) ? bx_grid.bigEnd(dir) : 0;
+
+          amrex::LoopOnCpu(bx, [&] (int i, int j, int k) noexcept
+          {
+              Real weight = 1.;
+              if (dir >= 0) {
+                  const int idx = (dir == 0) ? i : ((dir == 1) ? j : k);
+                  weight = (idx>lo && idx<hi) ? 1.0 : 0.5;
+              }
+              const Real ww = weight*wa(i,j,k,wcomp);
+              for (int n=0; n<nvec; ++n) {
+                  sum_local[n] += ww*Va(i,j,k,n);
+              }
+              if (include_norm) {
+                  sum_local[nvec] += ww*wa(i,j,k,wcomp);
+              }
+          });
+      }
+
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+      for (int n=0; n<nprod; ++n) {
+          sum[n] += sum_local[n];
+      }
+  }
+#endif
+
+  for (int n=0; n<nprod; ++n) {
+      prod_val[n] += scale*sum[n];
+  }
+}
+
+void StagCCMultiInnerProd(const Geometry& geom,
+                          const std::array<MultiFab, AMREX_SPACEDIM>& w_u,
+                          const MultiFab& w_p,
+                          const int& wcomp,
+                          const std::array<MultiFab, AMREX_SPACEDIM>& V_u,
+                          const MultiFab& V_p,
+                          const int& nvec,
+                          const Real& p_weight,
+                          amrex::Vector<amrex::Real>& prod_val,
+                          const bool& include_norm)
+{
+  BL_PROFILE_VAR("StagCCMultiInnerProd()",StagCCMultiInnerProd);
+
+  const int nprod = include_norm ? nvec+1 : nvec;
+  if (prod_val.size() < nprod) {
+    prod_val.resize(nprod);
+  }
+
+  const Real p_weight_sq = p_weight*p_weight;
+
+  // one sweep per face direction and one over the pressure, each producing
+  // every product at once
+  std::fill(prod_val.begin(), prod_val.begin()+nprod, 0.);
+  for (int d=0; d<AMREX_SPACEDIM; d++) {
+    LocalMultiDot(w_u[d],wcomp,V_u[d],nvec,include_norm,d,1.,prod_val);
+  }
+  LocalMultiDot(w_p,wcomp,V_p,nvec,include_norm,-1,p_weight_sq,prod_val);
+
+  ParallelDescriptor::ReduceRealSum(prod_val.dataPtr(),nprod);
+}
+
 void CCMoments(const amrex::MultiFab& m1,
 		 const int& comp1,
                  amrex::MultiFab& mscr,
@@ -98,7 +98,8 @@ void InitializeCommonNamespace() {
                                 &rho0, &variance_coef_mom, &variance_coef_mass, &k_B, &Runiv,
                                 T_init.begin(),
                                 &algorithm_type,  &advection_type,
-                                &barodiffusion_type, &use_bl_rng, &seed,
+                                &barodiffusion_type, &use_bl_rng, &counter_rng,
+                                &transport_lag_tol, &transport_lag_report, &seed,
                                 &seed_momentum, &seed_diffusion, &seed_reaction,
                                 &seed_init_mass,
                                 &seed_init_momentum, &visc_coef, &visc_type,
@@ -131,7 +132,7 @@ void InitializeCommonNamespace() {
                                 &permittivity,
                                 &wall_mob,rmin.begin(),rmax.begin(), eepsilon.begin(), sigma.begin(),rmin_wall.begin(),rmax_wall.begin(), eepsilon_wall.begin(), sigma_wall.begin(),
                                 &poisson_verbose, &poisson_bottom_verbose, &poisson_max_iter,
-                                &poisson_rel_tol, &particle_grid_refine, &es_grid_refine,
+                                &poisson_rel_tol, &poisson_fft, &particle_grid_refine, &es_grid_refine,
                                 diff.dataPtr(), &all_dry, &fluid_tog, &es_tog, &drag_tog, &move_tog, &rfd_tog,
                                 &dry_move_tog, &sr_tog, &graphene_tog, &crange, &thermostat_tog, &zero_net_force,
                                 &images, eamp.dataPtr(), efreq.dataPtr(), ephase.dataPtr(),
@@ -1137,6 +1137,46 @@ void BCWallSpeciesFlux(std::array< MultiFab, AMREX_SPACEDIM >& faceflux, const a
     }
 }
 
+// BCWallSpeciesFlux on the x/y/z face boxes of one tile (fluxx/fluxy/fluxz may
+// be scratch fabs covering just those boxes)
+void BCWallSpeciesFluxTile(const Box& tbx, const Box& tby, const Box& tbz,
+                           const Array4<Real>& fluxx, const Array4<Real>& fluxy, const Array4<Real>& fluxz,
+                           const amrex::Geometry geom)
+{
+    const Array<Box,3> tb = {tbx, tby, tbz};
+    const Array<Array4<Real>,3> faceflux = {fluxx, fluxy, fluxz};
+
+    for (int d=0; d<AMREX_SPACEDIM; ++d) {
+
+        // domain grown nodally in direction d
+        const Box& dom_d = amrex::surroundingNodes(geom.Domain(), d);
+
+        for (int lohi=0; lohi<2; ++lohi) {
+
+            const int bc = (lohi == 0) ? bc_mass_lo[d] : bc_mass_hi[d];
+            if (bc != 1) continue;
+
+            const Box& dom_face = amrex::bdryNode(dom_d, Orientation(d, (lohi == 0) ? Orientation::low
+                                                                                     : Orientation::high));
+            const Box& b = tb[d] & dom_face;
+            const Array4<Real>& flux = faceflux[d];
+            if (b.ok()) {
+                amrex::ParallelFor(b, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+                {
+                    // species
+                    for (int n=0;n<nspecies;++n) {
+                        flux(i,j,k,n+5) = 0.;
+                    }
+                    // density
+                    flux(i,j,k,0) = 0.;
+                    // Dufour
+                    flux(i,j,k,nvars+3) = 0.;
+                });
+            }
+        }
+    }
+}
+
 void StochFlux(std::array<MultiFab, AMREX_SPACEDIM>& faceflux_in,
                const amrex::Geometry geom) {
 
@@ -47,45 +47,7 @@ void conservedToPrimitive(MultiFab& prim_in, const MultiFab& cons_in)
         
         amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
         {
-            // method 2 to create a thread private array
-            // can use when the size of the array is known at compile-time
-            GpuArray<Real,MAX_SPECIES> Xk;
-            GpuArray<Real,MAX_SPECIES> Yk;
-            GpuArray<Real,MAX_SPECIES> Yk_fixed;
-            
-
-            prim(i,j,k,0) = cons(i,j,k,0);
-            prim(i,j,k,1) = cons(i,j,k,1)/cons(i,j,k,0);
-            prim(i,j,k,2) = cons(i,j,k,2)/cons(i,j,k,0);
-            prim(i,j,k,3) = cons(i,j,k,3)/cons(i,j,k,0);
-
-            Real vsqr = prim(i,j,k,1)*prim(i,j,k,1) + prim(i,j,k,2)*prim(i,j,k,2) + prim(i,j,k,3)*prim(i,j,k,3);
-            Real intenergy = cons(i,j,k,4)/cons(i,j,k,0) - 0.5*vsqr;
-
-            Real sumYk = 0.;
-            for (int n=0; n<nspecies; ++n) {
-                Yk[n] = cons(i,j,k,5+n)/cons(i,j,k,0);
-                Yk_fixed[n] = amrex::max(0.,amrex::min(1.,Yk[n]));
-                sumYk += Yk_fixed[n];
-            }
-            
-            for (int n=0; n<nspecies; ++n) {
-                Yk_fixed[n] /= sumYk;
-            }
-
-            // update temperature in-place using internal energy
-            GetTemperature(intenergy, Yk_fixed, prim(i,j,k,4));
-
-            // compute mole fractions from mass fractions
-            GetMolfrac(Yk, Xk);
-
-            // mass fractions
-            for (int n=0; n<nspecies; ++n) {
-                prim(i,j,k,6+n) = Yk[n];
-                prim(i,j,k,6+nspecies+n) = Xk[n];
-            }
-
-            GetPressureGas(prim(i,j,k,5), Yk, prim(i,j,k,0), prim(i,j,k,4));
+            ConsToPrimCell(i, j, k, cons, prim);
         });
         
     } // end MFIter
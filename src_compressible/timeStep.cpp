@@ -4,7 +4,184 @@
 
 #include "rng_functions.H"
 
+// One RK3 stage:
+//   cnew = a*cold + b*(cstage - dt*div(flux) + dt*source + dt*gravity(cstage))
+// followed by primnew = conservedToPrimitive(cnew). The flux stencils of
+// neighboring regions still read prim, so primnew must be a separate MultiFab.
+// The diffusive and hyperbolic fluxes are computed region by region into
+// views of scratch (allocated once per step by RK3step) that only cover that
+// region's faces and corners, and are consumed by the divergence and
+// primitive conversion in the same sweep, so the face fluxes and corner
+// viscous stresses are never stored for the whole grid. flux holds only the stochastic part (stoch_stress_form = 1) and is
+// read once; otherwise it is not touched.
+// Each tile is split into the part within ngrow of its box faces and the box
+// interior. The face regions go first, then the cnew ghost cell exchange is
+// posted and overlapped with the interior regions (on GPU too, where a tile is
+// a whole box). The primitive variables in the interior/periodic ghost cells
+// are then recomputed from the exchanged cnew, which replaces
+// prim.FillBoundary.
+// cnew may be the same MultiFab as cold (the update is pointwise).
+static void RK3StageUpdate(MultiFab& cnew, const MultiFab& cold, const MultiFab& cstage,
+                           const Real a, const Real b, const MultiFab& source,
+                           const MultiFab& prim, const MultiFab& eta, const MultiFab& zeta,
+                           const MultiFab& kappa, const MultiFab& chi, const MultiFab& D,
+                           const std::array<MultiFab, AMREX_SPACEDIM>& flux,
+                           MultiFab& primnew, FArrayBox& scratch,
+                           const amrex::Geometry& geom, const amrex::Real dt)
+{
+    BL_PROFILE_VAR("RK3StageUpdate()",RK3StageUpdate);
+
+    AMREX_ASSERT(cnew.nGrowVect().allGE(primnew.nGrowVect()));
+
+    const GpuArray<Real, AMREX_SPACEDIM> dx = geom.CellSizeArray();
+    const IntVect ngrow = cnew.nGrowVect();
+
+    const int nflux = nvars+4;
+    const int stoch = (stoch_stress_form == 1);
+
+    // pass 0: regions within ngrow of a box face; pass 1: the rest
+    for (int pass=0; pass<2; ++pass) {
+
+        if (pass == 1) {
+            cnew.FillBoundary_nowait(geom.periodicity());
+        }
+
+        for ( MFIter mfi(cnew,TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+
+            const Box& tbx = mfi.tilebox();
+
+            const Box inner = amrex::grow(mfi.validbox(), -ngrow);
+
+            BoxList regions;
+            if (pass == 0) {
+                if (inner.ok()) {
+                    regions = amrex::boxDiff(tbx, inner);
+                } else {
+                    regions.push_back(tbx);
+                }
+            } else if (inner.ok() && tbx.intersects(inner)) {
+                regions.push_back(tbx & inner);
+            }
+
+            const Array4<Real> & cnew_fab = cnew.array(mfi);
+            const Array4<Real const> & cold_fab = cold.array(mfi);
+            const Array4<Real const> & cs_fab = cstage.array(mfi);
+            const Array4<Real const> & source_fab = source.array(mfi);
+            const Array4<Real const> & prim_fab = prim.array(mfi);
+            const Array4<Real> & primnew_fab = primnew.array(mfi);
+            AMREX_D_TERM(Array4<Real const> const& xstoch_fab = flux[0].array(mfi);,
+                         Array4<Real const> const& ystoch_fab = flux[1].array(mfi);,
+                         Array4<Real const> const& zstoch_fab = flux[2].array(mfi););
+
+            for (const Box& bx : regions) {
+
+                const Box& bxx = amrex::surroundingNodes(bx,0);
+                const Box& bxy = amrex::surroundingNodes(bx,1);
+                const Box& bxz = amrex::surroundingNodes(bx,2);
+                const Box& bxn = amrex::surroundingNodes(bx);
+
+                // face fluxes and corner stresses of this region only, each
+                // in its own slice of scratch
+                Real* scr = scratch.dataPtr();
+                const Array4<Real> xflux_fab = makeArray4(scr, bxx, nflux);
+                scr += nflux*bxx.numPts();
+                const Array4<Real> yflux_fab = makeArray4(scr, bxy, nflux);
+                scr += nflux*bxy.numPts();
+                const Array4<Real> zflux_fab = makeArray4(scr, bxz, nflux);
+                scr += nflux*bxz.numPts();
+                const Array4<Real> corn = makeArray4(scr, bxn, 10);
+
+                // start from the stochastic fluxes
+                amrex::ParallelFor(bxx, nflux,
+                [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+                {
+                    xflux_fab(i,j,k,n) = stoch ? xstoch_fab(i,j,k,n) : 0.;
+                },
+                                   bxy, nflux,
+                [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+                {
+                    yflux_fab(i,j,k,n) = stoch ? ystoch_fab(i,j,k,n) : 0.;
+                },
+                                   bxz, nflux,
+                [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+                {
+                    zflux_fab(i,j,k,n) = stoch ? zstoch_fab(i,j,k,n) : 0.;
+                });
+
+                DiffusiveFluxTile(bxx, bxy, bxz, bxn, xflux_fab, yflux_fab, zflux_fab,
+                                  prim_fab, eta.array(mfi), zeta.array(mfi),
+                                  kappa.array(mfi), chi.array(mfi), D.array(mfi),
+                                  Array4<Real>(corn,0), Array4<Real>(corn,1), Array4<Real>(corn,2),
+                                  Array4<Real>(corn,3), Array4<Real>(corn,4), Array4<Real>(corn,5),
+                                  Array4<Real>(corn,6), Array4<Real>(corn,7), Array4<Real>(corn,8),
+                                  Array4<Real>(corn,9), dx);
+
+                // set species flux to zero at the walls (also Dufour)
+                BCWallSpeciesFluxTile(bxx, bxy, bxz, xflux_fab, yflux_fab, zflux_fab, geom);
+
+                HyperbolicFluxTile(bxx, bxy, bxz, xflux_fab, yflux_fab, zflux_fab,
+                                   prim_fab, cs_fab);
+
+                amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+                {
+                    for (int n=0; n<nvars; ++n) {
+                        Real unew = cs_fab(i,j,k,n) - dt *
+                            ( AMREX_D_TERM(  (xflux_fab(i+1,j,k,n) - xflux_fab(i,j,k,n)) / dx[0],
+                                           + (yflux_fab(i,j+1,k,n) - yflux_fab(i,j,k,n)) / dx[1],
+                                           + (zflux_fab(i,j,k+1,n) - zflux_fab(i,j,k,n)) / dx[2])
+                                                                                                   )
+                            + dt*source_fab(i,j,k,n);
+
+                        // gravity
+                        if (n >= 1 && n <= 3) {
+                            unew += dt * cs_fab(i,j,k,0)*grav[n-1];
+                        }
+                        else if (n == 4) {
+                            unew += dt * (  grav[0]*cs_fab(i,j,k,1)
+                                          + grav[1]*cs_fab(i,j,k,2)
+                                          + grav[2]*cs_fab(i,j,k,3) );
+                        }
+
+                        cnew_fab(i,j,k,n) = a*cold_fab(i,j,k,n) + b*unew;
+                    }
+
+                    ConsToPrimCell(i, j, k, cnew_fab, primnew_fab);
+                });
+            }
+        }
+    }
+
+    cnew.FillBoundary_finish();
+
+    // primitive variables in the interior and periodic ghost cells; ghost
+    // cells outside a non-periodic boundary are left to setBC
+    Box dom = geom.Domain();
+    for (int d=0; d<AMREX_SPACEDIM; ++d) {
+        if (geom.isPeriodic(d)) {
+            dom.grow(d, primnew.nGrowVect()[d]);
+        }
+    }
+
+    for ( MFIter mfi(primnew,TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+
+        const Box& bx = mfi.growntilebox() & dom;
+        if (!bx.ok()) continue;
+
+        const Dim3 vlo = amrex::lbound(mfi.validbox());
+        const Dim3 vhi = amrex::ubound(mfi.validbox());
 
+        const Array4<Real const> & cnew_fab = cnew.array(mfi);
+        const Array4<Real> & prim_fab = primnew.array(mfi);
+
+        amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+        {
+            if (i >= vlo.x && i <= vhi.x && j >= vlo.y && j <= vhi.y && k >= vlo.z && k <= vhi.z) {
+                return;
+            }
+            ConsToPrimCell(i, j, k, cnew_fab, prim_fab);
+        });
+    }
+}
 
 void RK3step(MultiFab& cu, MultiFab& cup, MultiFab& cup2, MultiFab& cup3,
              MultiFab& prim, MultiFab& source,
@@ -12,16 +189,15 @@ void RK3step(MultiFab& cu, MultiFab& cup, MultiFab& cup2, MultiFab& cup3,
              MultiFab& chi, MultiFab& D,
              std::array<MultiFab, AMREX_SPACEDIM>& flux,
              std::array<MultiFab, AMREX_SPACEDIM>& stochFlux,
-             std::array<MultiFab, AMREX_SPACEDIM>& cornx,
-             std::array<MultiFab, AMREX_SPACEDIM>& corny,
-             std::array<MultiFab, AMREX_SPACEDIM>& cornz,
-             MultiFab& visccorn, MultiFab& rancorn,
+             MultiFab& rancorn,
+             std::array<MultiFab, AMREX_SPACEDIM>& stochFlux_AB,
+             MultiFab& rancorn_AB,
+             MultiFab& prim_new,
+             MultiFab& transport_ref,
              const amrex::Geometry geom, const amrex::Real dt)
 {
     BL_PROFILE_VAR("RK3step()",RK3step);
     
-    const GpuArray<Real, AMREX_SPACEDIM> dx = geom.CellSizeArray();
-    
     /////////////////////////////////////////////////////
     // Initialize white noise fields
 
@@ -30,50 +206,32 @@ void RK3step(MultiFab& cu, MultiFab& cup, MultiFab& cup2, MultiFab& cup3,
     amrex::Real swgt1, swgt2;
     swgt1 = 1.0;
 
-    // Temp. stoch. fluxes
-
-    // field "A"
-    std::array< MultiFab, AMREX_SPACEDIM > stochFlux_A;
-    AMREX_D_TERM(stochFlux_A[0].define(stochFlux[0].boxArray(), stochFlux[0].DistributionMap(), nvars, 0);,
-                 stochFlux_A[1].define(stochFlux[1].boxArray(), stochFlux[1].DistributionMap(), nvars, 0);,
-                 stochFlux_A[2].define(stochFlux[2].boxArray(), stochFlux[2].DistributionMap(), nvars, 0););
+    // scratch for the face fluxes and corner stresses of one region of
+    // RK3StageUpdate, sized for the largest tile and shared by the stages
+    Long nscratch = 0;
+    for ( MFIter mfi(cu,TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+        const Box& tbx = mfi.tilebox();
+        nscratch = std::max(nscratch,
+                            (nvars+4)*(  amrex::surroundingNodes(tbx,0).numPts()
+                                       + amrex::surroundingNodes(tbx,1).numPts()
+                                       + amrex::surroundingNodes(tbx,2).numPts() )
+                            + 10*amrex::surroundingNodes(tbx).numPts());
+    }
+    FArrayBox scratch(Box(IntVect(0),IntVect(0)), static_cast<int>(nscratch));
+    auto scratch_eli = scratch.elixir();
 
-    MultiFab rancorn_A;
-    rancorn_A.define(rancorn.boxArray(), rancorn.DistributionMap(), 1, 0);
-    
-    // field "B"
-    std::array< MultiFab, AMREX_SPACEDIM > stochFlux_B;
-    AMREX_D_TERM(stochFlux_B[0].define(stochFlux[0].boxArray(), stochFlux[0].DistributionMap(), nvars, 0);,
-                 stochFlux_B[1].define(stochFlux[1].boxArray(), stochFlux[1].DistributionMap(), nvars, 0);,
-                 stochFlux_B[2].define(stochFlux[2].boxArray(), stochFlux[2].DistributionMap(), nvars, 0););
-
-    MultiFab rancorn_B;
-    rancorn_B.define(rancorn.boxArray(), rancorn.DistributionMap(), 1, 0);
-
-    AMREX_D_TERM(stochFlux_A[0].setVal(0.0);,
-                 stochFlux_A[1].setVal(0.0);,
-                 stochFlux_A[2].setVal(0.0););
-    rancorn_A.setVal(0.0);
-
-    AMREX_D_TERM(stochFlux_B[0].setVal(0.0);,
-                 stochFlux_B[1].setVal(0.0);,
-                 stochFlux_B[2].setVal(0.0););
-    rancorn_B.setVal(0.0);
-
-    // fill random numbers (can skip density component 0)
+    // fill the white noise fields "A" and "B" in one batch each; stochFlux_AB
+    // and rancorn_AB hold A in the first half of their components and B in the
+    // second half (density component 0 is skipped)
     for(int d=0;d<AMREX_SPACEDIM;d++) {
-    	for(int i=1;i<nvars;i++) {
-    	    MultiFabFillRandom(stochFlux_A[d], i, 1.0, geom);
-	        MultiFabFillRandom(stochFlux_B[d], i, 1.0, geom);
-        }
+        MultiFabFillRandom(stochFlux_AB[d], 0, 2*(nvars-1), 1.0, geom);
     }
 
-    MultiFabFillRandom(rancorn_A, 0, 1.0, geom);
-    MultiFabFillRandom(rancorn_B, 0, 1.0, geom);
+    MultiFabFillRandom(rancorn_AB, 0, 2, 1.0, geom);
     /////////////////////////////////////////////////////
 
     // Compute transport coefs after setting BCs    
-    calculateTransportCoeffs(prim, eta, zeta, kappa, chi, D);
+    calculateTransportCoeffs(prim, eta, zeta, kappa, chi, D, transport_ref);
 
     ///////////////////////////////////////////////////////////
     // Perform weighting of white noise fields
@@ -90,84 +248,32 @@ void RK3step(MultiFab& cu, MultiFab& cup, MultiFab& cup2, MultiFab& cup3,
     // apply weights (only momentum and energy)
     for(int d=0;d<AMREX_SPACEDIM;d++) {
 	MultiFab::LinComb(stochFlux[d], 
-			  stoch_weights[0], stochFlux_A[d], 1, 
-			  stoch_weights[1], stochFlux_B[d], 1,
+			  stoch_weights[0], stochFlux_AB[d], 0, 
+			  stoch_weights[1], stochFlux_AB[d], nvars-1,
 			  1, nvars-1, 0);
     }
 
     MultiFab::LinComb(rancorn, 
-		      stoch_weights[0], rancorn_A, 0, 
-		      stoch_weights[1], rancorn_B, 0,
+		      stoch_weights[0], rancorn_AB, 0, 
+		      stoch_weights[1], rancorn_AB, 1,
 		      0, 1, 0);
 
     ///////////////////////////////////////////////////////////
 
-    calculateFlux(cu, prim, eta, zeta, kappa, chi, D, flux, stochFlux, cornx, corny, cornz,
-                  visccorn, rancorn, geom, stoch_weights, dt);
-
-    for ( MFIter mfi(cu,TilingIfNotGPU()); mfi.isValid(); ++mfi) {
-        
-        const Box& bx = mfi.tilebox();
-
-        const Array4<Real> & cu_fab = cu.array(mfi);
-        const Array4<Real> & cup_fab = cup.array(mfi);
-        const Array4<Real> & source_fab = source.array(mfi);
-        AMREX_D_TERM(Array4<Real const> const& xflux_fab = flux[0].array(mfi);,
-                     Array4<Real const> const& yflux_fab = flux[1].array(mfi);,
-                     Array4<Real const> const& zflux_fab = flux[2].array(mfi););
-
-        amrex::ParallelFor(bx, nvars, [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
-        {
-            cup_fab(i,j,k,n) = cu_fab(i,j,k,n) - dt *
-                ( AMREX_D_TERM(  (xflux_fab(i+1,j,k,n) - xflux_fab(i,j,k,n)) / dx[0],
-                               + (yflux_fab(i,j+1,k,n) - yflux_fab(i,j,k,n)) / dx[1],
-                               + (zflux_fab(i,j,k+1,n) - zflux_fab(i,j,k,n)) / dx[2])
-                                                                                       )
-                + dt*source_fab(i,j,k,n);
-        });
-
-//        amrex::ParallelFor(bx, nvars, [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
-//        {
-//            cup_fab(i,j,k,n) = cu_fab(i,j,k,n) - dt *
-//                (  (xflux_fab(i+1,j,k,n) - xflux_fab(i,j,k,n)) / dx[0] )
-//                + dt*source_fab(i,j,k,n);
-//        });
-
-//  what to do about tests
-
-//              if(cup(i,j,k,1) .lt. 0) then
-//                print *, "Aborting. Negative density at", i,j,k
-//                call exit(0)
-//              endif
-//              if(cup(i,j,k,5) .lt. 0) then
-//                print *, "Aborting. Negative energy at", i,j,k
-//                call exit(0)
-//              endif
-//
-
-        amrex::ParallelFor(bx, 3, [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
-        {
-            cup_fab(i,j,k,n+1) += dt * cu_fab(i,j,k,0)*grav[n];
-        });
-
-        amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
-        {
-            cup_fab(i,j,k,4) += dt * (  grav[0]*cu_fab(i,j,k,1)
-                                      + grav[1]*cu_fab(i,j,k,2)
-                                     + grav[2]*cu_fab(i,j,k,3)
-                                                                        );
-        });
+    if (stoch_stress_form == 1) {
+        calculateStochFlux(cu, prim, eta, zeta, kappa, chi, D, flux, stochFlux, rancorn,
+                           geom, stoch_weights, dt);
     }
 
-    conservedToPrimitive(prim, cup);
-    
-    // Set BC: 1) fill boundary 2) physical
-    cup.FillBoundary(geom.periodicity());
-    prim.FillBoundary(geom.periodicity());
+    // deterministic fluxes, stage update, gravity and primitive variables in
+    // one sweep; ghost cells are exchanged while the interior is updated
+    RK3StageUpdate(cup, cu, cu, 0., 1., source, prim, eta, zeta, kappa, chi, D,
+                   flux, prim_new, scratch, geom, dt);
+    std::swap(prim, prim_new);
     setBC(prim, cup);
 
     // Compute transport coefs after setting BCs
-    calculateTransportCoeffs(prim, eta, zeta, kappa, chi, D);
+    calculateTransportCoeffs(prim, eta, zeta, kappa, chi, D, transport_ref);
 
     ///////////////////////////////////////////////////////////
     // Perform weighting of white noise fields
@@ -184,84 +290,32 @@ void RK3step(MultiFab& cu, MultiFab& cup, MultiFab& cup2, MultiFab& cup3,
     // apply weights (only momentum and energy)
     for(int d=0;d<AMREX_SPACEDIM;d++) {
 	MultiFab::LinComb(stochFlux[d], 
-			  stoch_weights[0], stochFlux_A[d], 1, 
-			  stoch_weights[1], stochFlux_B[d], 1,
+			  stoch_weights[0], stochFlux_AB[d], 0, 
+			  stoch_weights[1], stochFlux_AB[d], nvars-1,
 			  1, nvars-1, 0);
     }
 
     MultiFab::LinComb(rancorn, 
-		      stoch_weights[0], rancorn_A, 0, 
-		      stoch_weights[1], rancorn_B, 0,
+		      stoch_weights[0], rancorn_AB, 0, 
+		      stoch_weights[1], rancorn_AB, 1,
 		      0, 1, 0);
 
     ///////////////////////////////////////////////////////////
 
-    calculateFlux(cup, prim, eta, zeta, kappa, chi, D, flux, stochFlux, cornx, corny, cornz,
-                  visccorn, rancorn, geom, stoch_weights, dt);
-
-    for ( MFIter mfi(cu,TilingIfNotGPU()); mfi.isValid(); ++mfi) {
-        
-        const Box& bx = mfi.tilebox();
-
-        const Array4<Real> & cu_fab = cu.array(mfi);
-        const Array4<Real> & cup_fab = cup.array(mfi);
-        const Array4<Real> & cup2_fab = cup2.array(mfi);
-        const Array4<Real> & source_fab = source.array(mfi);
-        AMREX_D_TERM(Array4<Real const> const& xflux_fab = flux[0].array(mfi);,
-                     Array4<Real const> const& yflux_fab = flux[1].array(mfi);,
-                     Array4<Real const> const& zflux_fab = flux[2].array(mfi););
-
-        amrex::ParallelFor(bx, nvars, [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
-        {
-            cup2_fab(i,j,k,n) = 0.25*( 3.0* cu_fab(i,j,k,n) + cup_fab(i,j,k,n) - dt *
-                                       ( AMREX_D_TERM(  (xflux_fab(i+1,j,k,n) - xflux_fab(i,j,k,n)) / dx[0],
-                                                      + (yflux_fab(i,j+1,k,n) - yflux_fab(i,j,k,n)) / dx[1],
-                                                      + (zflux_fab(i,j,k+1,n) - zflux_fab(i,j,k,n)) / dx[2])
-                                                                                                                )
-                                       +dt*source_fab(i,j,k,n)  );
-        });
-
-//        amrex::ParallelFor(bx, nvars, [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
-//        {
-//            cup2_fab(i,j,k,n) = 0.25*( 3.0* cu_fab(i,j,k,n) + cup_fab(i,j,k,n) - dt *
-//                                       (  (xflux_fab(i+1,j,k,n) - xflux_fab(i,j,k,n)) / dx[0])                                                                                                                                                   
-//                                       +dt*source_fab(i,j,k,n)  );
-//        });
-
-//  what to do about tests
-
-//              if(cup(i,j,k,1) .lt. 0) then
-//                print *, "Aborting. Negative density at", i,j,k
-//                call exit(0)
-//              endif
-//              if(cup(i,j,k,5) .lt. 0) then
-//                print *, "Aborting. Negative energy at", i,j,k
-//                call exit(0)
-//              endif
-//
-
-        amrex::ParallelFor(bx, 3, [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
-        {
-            cup2_fab(i,j,k,n+1) += 0.25* dt * cup_fab(i,j,k,0)*grav[n];
-        });
-
-        amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
-        {
-            cup2_fab(i,j,k,4) += 0.25 * dt * (  grav[0]*cup_fab(i,j,k,1)
-                                              + grav[1]*cup_fab(i,j,k,2)
-                                              + grav[2]*cup_fab(i,j,k,3));
-        });
+    if (stoch_stress_form == 1) {
+        calculateStochFlux(cup, prim, eta, zeta, kappa, chi, D, flux, stochFlux, rancorn,
+                           geom, stoch_weights, dt);
     }
-        
-    conservedToPrimitive(prim, cup2);
 
-    // Set BC: 1) fill boundary 2) physical
-    cup2.FillBoundary(geom.periodicity());
-    prim.FillBoundary(geom.periodicity());
+    // deterministic fluxes, stage update, gravity and primitive variables in
+    // one sweep; ghost cells are exchanged while the interior is updated
+    RK3StageUpdate(cup2, cu, cup, 0.75, 0.25, source, prim, eta, zeta, kappa, chi, D,
+                   flux, prim_new, scratch, geom, dt);
+    std::swap(prim, prim_new);
     setBC(prim, cup2);
 
     // Compute transport coefs after setting BCs
-    calculateTransportCoeffs(prim, eta, zeta, kappa, chi, D);
+    calculateTransportCoeffs(prim, eta, zeta, kappa, chi, D, transport_ref);
 
     ///////////////////////////////////////////////////////////
     // Perform weighting of white noise fields
@@ -278,83 +332,28 @@ void RK3step(MultiFab& cu, MultiFab& cup, MultiFab& cup2, MultiFab& cup3,
     // apply weights (only momentum and energy)
     for(int d=0;d<AMREX_SPACEDIM;d++) {
 	MultiFab::LinComb(stochFlux[d], 
-			  stoch_weights[0], stochFlux_A[d], 1, 
-			  stoch_weights[1], stochFlux_B[d], 1,
+			  stoch_weights[0], stochFlux_AB[d], 0, 
+			  stoch_weights[1], stochFlux_AB[d], nvars-1,
 			  1, nvars-1, 0);
     }
 
     MultiFab::LinComb(rancorn, 
-		      stoch_weights[0], rancorn_A, 0, 
-		      stoch_weights[1], rancorn_B, 0,
+		      stoch_weights[0], rancorn_AB, 0, 
+		      stoch_weights[1], rancorn_AB, 1,
 		      0, 1, 0);
 
     ///////////////////////////////////////////////////////////
 
-    calculateFlux(cup2, prim, eta, zeta, kappa, chi, D, flux, stochFlux, cornx, corny, cornz,
-                  visccorn, rancorn, geom, stoch_weights, dt);
-
-    for ( MFIter mfi(cu,TilingIfNotGPU()); mfi.isValid(); ++mfi) {
-        
-        const Box& bx = mfi.tilebox();
-
-        const Array4<Real> & cu_fab = cu.array(mfi);
-        const Array4<Real> & cup2_fab = cup2.array(mfi);
-        const Array4<Real> & source_fab = source.array(mfi);
-        AMREX_D_TERM(Array4<Real const> const& xflux_fab = flux[0].array(mfi);,
-                     Array4<Real const> const& yflux_fab = flux[1].array(mfi);,
-                     Array4<Real const> const& zflux_fab = flux[2].array(mfi););
-
-        amrex::ParallelFor(bx, nvars, [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
-        {
-            cu_fab(i,j,k,n) = (2./3.) *( 0.5* cu_fab(i,j,k,n) + cup2_fab(i,j,k,n) - dt *
-                                    (   AMREX_D_TERM(  (xflux_fab(i+1,j,k,n) - xflux_fab(i,j,k,n)) / dx[0],
-                                                     + (yflux_fab(i,j+1,k,n) - yflux_fab(i,j,k,n)) / dx[1],
-                                                     + (zflux_fab(i,j,k+1,n) - zflux_fab(i,j,k,n)) / dx[2]) 
-                                                                                                            )
-                                    + dt*source_fab(i,j,k,n) );
-            
-        });
-
-//        amrex::ParallelFor(bx, nvars, [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
-//        {
-//            cu_fab(i,j,k,n) = (2./3.) *( 0.5* cu_fab(i,j,k,n) + cup2_fab(i,j,k,n) - dt *
-//                                    (     (xflux_fab(i+1,j,k,n) - xflux_fab(i,j,k,n)) / dx[0])
-//                                                   
-//                                    + dt*source_fab(i,j,k,n) );
-//            
-//        });
-        
-//  what to do about tests
-
-//              if(cup(i,j,k,1) .lt. 0) then
-//                print *, "Aborting. Negative density at", i,j,k
-//                call exit(0)
-//              endif
-//              if(cup(i,j,k,5) .lt. 0) then
-//                print *, "Aborting. Negative energy at", i,j,k
-//                call exit(0)
-//              endif
-//
-
-        amrex::ParallelFor(bx, 3, [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
-        {
-            cu_fab(i,j,k,n+1) += 2./3.* dt * cup2_fab(i,j,k,0)*grav[n];
-        });
-
-        amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
-        {
-            cu_fab(i,j,k,4) += 2./3. * dt * (  grav[0]*cup2_fab(i,j,k,1)
-                                             + grav[1]*cup2_fab(i,j,k,2)
-                                             + grav[2]*cup2_fab(i,j,k,3) );
-        });
-        
+    if (stoch_stress_form == 1) {
+        calculateStochFlux(cup2, prim, eta, zeta, kappa, chi, D, flux, stochFlux, rancorn,
+                           geom, stoch_weights, dt);
     }
 
-    conservedToPrimitive(prim, cu);
-
-    // Set BC: 1) fill boundary 2) physical
-    cu.FillBoundary(geom.periodicity());
-    prim.FillBoundary(geom.periodicity());
+    // deterministic fluxes, stage update, gravity and primitive variables in
+    // one sweep; ghost cells are exchanged while the interior is updated
+    RK3StageUpdate(cu, cu, cup2, 1./3., 2./3., source, prim, eta, zeta, kappa, chi, D,
+                   flux, prim_new, scratch, geom, dt);
+    std::swap(prim, prim_new);
 
     //doMembrane(cu,prim,flux,geom,dxp,dt);
 
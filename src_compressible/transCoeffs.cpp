@@ -4,24 +4,112 @@
 
 using namespace common;
 
-void calculateTransportCoeffs(const MultiFab& prim_in, 
-			      MultiFab& eta_in, MultiFab& zeta_in, MultiFab& kappa_in,
-			      MultiFab& chi_in, MultiFab& Dij_in)
+// Coefficients of cell (i,j,k) from the primitive variables; Dij is
+// multiplied by rho.  NS is the compile-time species count (0 = runtime)
+template <int NS>
+AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+static void TransportCoeffsCell(int i, int j, int k,
+                                const Array4<const Real>& prim,
+                                const Array4<Real>& eta, const Array4<Real>& zeta,
+                                const Array4<Real>& kappa, const Array4<Real>& chi,
+                                const Array4<Real>& Dij)
 {
-    BL_PROFILE_VAR("calculateTransportCoeffs()",calculateTransportCoeffs);
+    const int nspecies = (NS > 0) ? NS : common::nspecies;
+
+    GpuArray<Real,MAX_SPECIES> Yk_fixed;
+    GpuArray<Real,MAX_SPECIES> Xk_fixed;
+
+    Real sumYk = 0.;
+    for (int n=0; n<nspecies; ++n) {
+        if (prim(i,j,k,6+n) <= 0.0) std::printf("Negative mass fraction encountered\n");
+        if (prim(i,j,k,6+n) >= 1.0) std::printf("Greater than unity mass fraction encountered\n");
+        Yk_fixed[n] = amrex::max(0.,amrex::min(1.,prim(i,j,k,6+n)));
+        sumYk += Yk_fixed[n];
+    }
+
+    for (int n=0; n<nspecies; ++n) {
+        Yk_fixed[n] /= sumYk;
+    }
+
+    // compute mole fractions from mass fractions
+    GetMolfrac(Yk_fixed, Xk_fixed);
+
+    IdealMixtureTransport<NS>(i,j,k, prim(i,j,k,0), prim(i,j,k,4), prim(i,j,k,5),
+                          Yk_fixed, Xk_fixed, eta(i,j,k), kappa(i,j,k), zeta(i,j,k),
+                          Dij, chi);
 
+    // want this multiplied by rho for all times
+    for (int kk=0; kk<nspecies; ++kk) {
+        for (int ll=0; ll<nspecies; ++ll) {
+            int n = kk*nspecies + ll;
+            Dij(i,j,k,n) *= prim(i,j,k,0);
+        }
+    }
+}
+
+// exact coefficients on the tile boxes grown by ng
+template <int NS>
+static void TransportCoeffsExactNS(const MultiFab& prim_in,
+                                 MultiFab& eta_in, MultiFab& zeta_in, MultiFab& kappa_in,
+                                 MultiFab& chi_in, MultiFab& Dij_in, int ng)
+{
     // see comments in conservedPrimitiveConversions.cpp regarding alternate ways of declaring
     // thread shared and thread private arrays on GPUs
     // if the size is not known at compile time, alternate approaches are required
     // here we know the size at compile time
     
     // Loop over boxes
+    for ( MFIter mfi(prim_in); mfi.isValid(); ++mfi) {
+
+        const Box& bx = amrex::grow(mfi.tilebox(), ng);
+
+        const Array4<const Real>& prim = prim_in.array(mfi);
+
+        const Array4<Real>& eta   =   eta_in.array(mfi);
+        const Array4<Real>& zeta  =  zeta_in.array(mfi);
+        const Array4<Real>& kappa = kappa_in.array(mfi);
+        const Array4<Real>& chi   =   chi_in.array(mfi);
+        const Array4<Real>& Dij   =   Dij_in.array(mfi);
+
+        amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+        {
+            TransportCoeffsCell<NS>(i, j, k, prim, eta, zeta, kappa, chi, Dij);
+        });
+    }
+}
+
+// species counts 2-8 run kernels specialized at compile time
+static void TransportCoeffsExact(const MultiFab& prim_in,
+                                 MultiFab& eta_in, MultiFab& zeta_in, MultiFab& kappa_in,
+                                 MultiFab& chi_in, MultiFab& Dij_in, int ng)
+{
+    switch (nspecies) {
+    case 2: TransportCoeffsExactNS<2>(prim_in, eta_in, zeta_in, kappa_in, chi_in, Dij_in, ng); break;
+    case 3: TransportCoeffsExactNS<3>(prim_in, eta_in, zeta_in, kappa_in, chi_in, Dij_in, ng); break;
+    case 4: TransportCoeffsExactNS<4>(prim_in, eta_in, zeta_in, kappa_in, chi_in, Dij_in, ng); break;
+    case 5: TransportCoeffsExactNS<5>(prim_in, eta_in, zeta_in, kappa_in, chi_in, Dij_in, ng); break;
+    case 6: TransportCoeffsExactNS<6>(prim_in, eta_in, zeta_in, kappa_in, chi_in, Dij_in, ng); break;
+    case 7: TransportCoeffsExactNS<7>(prim_in, eta_in, zeta_in, kappa_in, chi_in, Dij_in, ng); break;
+    case 8: TransportCoeffsExactNS<8>(prim_in, eta_in, zeta_in, kappa_in, chi_in, Dij_in, ng); break;
+    default: TransportCoeffsExactNS<0>(prim_in, eta_in, zeta_in, kappa_in, chi_in, Dij_in, ng);
+    }
+}
+
+template <int NS>
+static void TransportCoeffsLaggedNS(const MultiFab& prim_in,
+                                    MultiFab& eta_in, MultiFab& zeta_in, MultiFab& kappa_in,
+                                    MultiFab& chi_in, MultiFab& Dij_in,
+                                    MultiFab& ref_in, const Real tol)
+{
+    const int nspecies = (NS > 0) ? NS : common::nspecies;
+
     for ( MFIter mfi(prim_in); mfi.isValid(); ++mfi) {
 
         // grow the box by ngc
         const Box& bx = amrex::grow(mfi.tilebox(), ngc);
 
         const Array4<const Real>& prim = prim_in.array(mfi);
+        const Array4<Real>& ref = ref_in.array(mfi);
 
         const Array4<Real>& eta   =   eta_in.array(mfi);
         const Array4<Real>& zeta  =  zeta_in.array(mfi);
@@ -31,37 +119,176 @@ void calculateTransportCoeffs(const MultiFab& prim_in,
 
         amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
         {
-        
-            GpuArray<Real,MAX_SPECIES> Yk_fixed;
-            GpuArray<Real,MAX_SPECIES> Xk_fixed;
-            
-            Real sumYk = 0.;
-            for (int n=0; n<nspecies; ++n) {
-	        if (prim(i,j,k,6+n) <= 0.0) std::printf("Negative mass fraction encountered\n");
-   	        if (prim(i,j,k,6+n) >= 1.0) std::printf("Greater than unity mass fraction encountered\n");
-                Yk_fixed[n] = amrex::max(0.,amrex::min(1.,prim(i,j,k,6+n)));
-                sumYk += Yk_fixed[n];
+            // a cell whose stored rho is not positive has never been evaluated
+            bool reeval = !(ref(i,j,k,nspecies+3) > 0.);
+            if (!reeval) {
+                Real change = amrex::max(amrex::Math::abs(prim(i,j,k,0)-ref(i,j,k,0))/ref(i,j,k,0),
+                                         amrex::Math::abs(prim(i,j,k,4)-ref(i,j,k,1))/ref(i,j,k,1));
+                change = amrex::max(change, amrex::Math::abs(prim(i,j,k,5)-ref(i,j,k,2))/ref(i,j,k,2));
+                for (int n=0; n<nspecies; ++n) {
+                    change = amrex::max(change, amrex::Math::abs(prim(i,j,k,6+n)-ref(i,j,k,3+n)));
+                }
+                reeval = !(change <= tol);
             }
 
-            for (int n=0; n<nspecies; ++n) {
-                Yk_fixed[n] /= sumYk;
+            if (reeval) {
+                TransportCoeffsCell<NS>(i, j, k, prim, eta, zeta, kappa, chi, Dij);
+                ref(i,j,k,0) = prim(i,j,k,0);
+                ref(i,j,k,1) = prim(i,j,k,4);
+                ref(i,j,k,2) = prim(i,j,k,5);
+                for (int n=0; n<nspecies; ++n) {
+                    ref(i,j,k,3+n) = prim(i,j,k,6+n);
+                }
+                ref(i,j,k,nspecies+4) = 1.;
+            } else {
+                Real fac = prim(i,j,k,0)/ref(i,j,k,nspecies+3);
+                for (int n=0; n<nspecies*nspecies; ++n) {
+                    Dij(i,j,k,n) *= fac;
+                }
+                ref(i,j,k,nspecies+4) = 0.;
             }
+            ref(i,j,k,nspecies+3) = prim(i,j,k,0);
+        });
+    }
+}
 
-            // compute mole fractions from mass fractions
-            GetMolfrac(Yk_fixed, Xk_fixed);
+// print the error of the lagged coefficients against the exact ones
+void TransportLagReport(const MultiFab& prim_in,
+                        const MultiFab& eta_in, const MultiFab& zeta_in,
+                        const MultiFab& kappa_in, const MultiFab& chi_in,
+                        const MultiFab& Dij_in, const MultiFab& transport_ref)
+{
+    const BoxArray& ba = prim_in.boxArray();
+    const DistributionMapping& dm = prim_in.DistributionMap();
 
-            IdealMixtureTransport(i,j,k, prim(i,j,k,0), prim(i,j,k,4), prim(i,j,k,5),
-                                  Yk_fixed, Xk_fixed, eta(i,j,k), kappa(i,j,k), zeta(i,j,k),
-                                  Dij, chi);
+    MultiFab eta  (ba, dm, 1, 0);
+    MultiFab zeta (ba, dm, 1, 0);
+    MultiFab kappa(ba, dm, 1, 0);
+    MultiFab chi  (ba, dm, nspecies, 0);
+    MultiFab Dij  (ba, dm, nspecies*nspecies, 0);
 
-            // want this multiplied by rho for all times
-            for (int kk=0; kk<nspecies; ++kk) {
-                for (int ll=0; ll<nspecies; ++ll) {
-                    int n = kk*nspecies + ll;
-                    Dij(i,j,k,n) *= prim(i,j,k,0);
-                }
-            }
+    TransportCoeffsExact(prim_in, eta, zeta, kappa, chi, Dij, 0);
 
-        });
+    // max |lagged - exact| relative to max |exact| over the valid cells
+    auto relerr = [] (MultiFab& exact, const MultiFab& lagged) {
+        Real scale = exact.norm0(0, exact.nComp(), IntVect(0));
+        MultiFab::Subtract(exact, lagged, 0, 0, exact.nComp(), 0);
+        Real err = exact.norm0(0, exact.nComp(), IntVect(0));
+        return (scale > 0.) ? err/scale : err;
+    };
+
+    Real err_eta   = relerr(eta,   eta_in);
+    Real err_zeta  = relerr(zeta,  zeta_in);
+    Real err_kappa = relerr(kappa, kappa_in);
+    Real err_chi   = relerr(chi,   chi_in);
+    Real err_Dij   = relerr(Dij,   Dij_in);
+
+    Real frac = transport_ref.sum(nspecies+4) / ba.numPts();
+
+    Print() << "Transport lag (tol " << transport_lag_tol << "): "
+            << "fraction re-evaluated " << frac
+            << ", relative error eta " << err_eta
+            << " zeta " << err_zeta
+            << " kappa " << err_kappa
+            << " chi " << err_chi
+            << " Dij " << err_Dij << "\n";
+}
+
+// transport_ref holds the state of each cell at its last exact evaluation and
+// is only used if transport_lag_tol > 0; it has nspecies+5 components and ngc
+// ghost cells: rho, T, p, Yk (nspecies), the rho that Dij is currently
+// multiplied by, and a flag that is 1 if the cell was re-evaluated by the
+// latest call.  Setting it to zero forces a full evaluation.
+void calculateTransportCoeffs(const MultiFab& prim_in, 
+			      MultiFab& eta_in, MultiFab& zeta_in, MultiFab& kappa_in,
+			      MultiFab& chi_in, MultiFab& Dij_in, MultiFab& transport_ref)
+{
+    BL_PROFILE_VAR("calculateTransportCoeffs()",calculateTransportCoeffs);
+
+    if (transport_lag_tol <= 0.) {
+        TransportCoeffsExact(prim_in, eta_in, zeta_in, kappa_in, chi_in, Dij_in, ngc);
+        return;
     }
+
+    // lagged evaluation: a cell is re-evaluated only if its state has moved
+    // by more than transport_lag_tol since its coefficients were computed;
+    // otherwise only the rho factor of Dij is brought up to date
+    const Real tol = transport_lag_tol;
+
+    switch (nspecies) {
+    case 2: TransportCoeffsLaggedNS<2>(prim_in, eta_in, zeta_in, kappa_in, chi_in, Dij_in, transport_ref, tol); break;
+    case 3: TransportCoeffsLaggedNS<3>(prim_in, eta_in, zeta_in, kappa_in, chi_in, Dij_in, transport_ref, tol); break;
+    case 4: TransportCoeffsLaggedNS<4>(prim_in, eta_in, zeta_in, kappa_in, chi_in, Dij_in, transport_ref, tol); break;
+    case 5: TransportCoeffsLaggedNS<5>(prim_in, eta_in, zeta_in, kappa_in, chi_in, Dij_in, transport_ref, tol); break;
+    case 6: TransportCoeffsLaggedNS<6>(prim_in, eta_in, zeta_in, kappa_in, chi_in, Dij_in, transport_ref, tol); break;
+    case 7: TransportCoeffsLaggedNS<7>(prim_in, eta_in, zeta_in, kappa_in, chi_in, Dij_in, transport_ref, tol); break;
+    case 8: TransportCoeffsLaggedNS<8>(prim_in, eta_in, zeta_in, kappa_in, chi_in, Dij_in, transport_ref, tol); break;
+    default: TransportCoeffsLaggedNS<0>(prim_in, eta_in, zeta_in, kappa_in, chi_in, Dij_in, transport_ref, tol);
+    }
+}
+
+void TransportCoeffsBenchmark(const MultiFab& prim, int nrep)
+{
+    const BoxArray& ba = prim.boxArray();
+    const DistributionMapping& dm = prim.DistributionMap();
+    const int ng = prim.nGrow();
+
+    MultiFab eta  (ba, dm, 1, ng);
+    MultiFab zeta (ba, dm, 1, ng);
+    MultiFab kappa(ba, dm, 1, ng);
+    MultiFab chi  (ba, dm, nspecies, ng);
+    MultiFab Dij  (ba, dm, nspecies*nspecies, ng);
+
+    MultiFab eta_s  (ba, dm, 1, ng);
+    MultiFab zeta_s (ba, dm, 1, ng);
+    MultiFab kappa_s(ba, dm, 1, ng);
+    MultiFab chi_s  (ba, dm, nspecies, ng);
+    MultiFab Dij_s  (ba, dm, nspecies*nspecies, ng);
+
+    Real ncells = 0.;
+    for (int i=0; i<ba.size(); ++i) {
+        ncells += amrex::grow(ba[i], ng).numPts();
+    }
+    ncells *= nrep;
+
+    // warm up both paths
+    TransportCoeffsExactNS<0>(prim, eta, zeta, kappa, chi, Dij, ng);
+    TransportCoeffsExact(prim, eta_s, zeta_s, kappa_s, chi_s, Dij_s, ng);
+
+    Gpu::synchronize();
+    Real t0 = ParallelDescriptor::second();
+    for (int r=0; r<nrep; ++r) {
+        TransportCoeffsExactNS<0>(prim, eta, zeta, kappa, chi, Dij, ng);
+    }
+    Gpu::synchronize();
+    Real t_generic = ParallelDescriptor::second() - t0;
+
+    t0 = ParallelDescriptor::second();
+    for (int r=0; r<nrep; ++r) {
+        TransportCoeffsExact(prim, eta_s, zeta_s, kappa_s, chi_s, Dij_s, ng);
+    }
+    Gpu::synchronize();
+    Real t_special = ParallelDescriptor::second() - t0;
+
+    ParallelDescriptor::ReduceRealMax(t_generic);
+    ParallelDescriptor::ReduceRealMax(t_special);
+
+    // the two paths should agree to roundoff
+    MultiFab::Subtract(Dij_s, Dij, 0, 0, nspecies*nspecies, ng);
+    MultiFab::Subtract(chi_s, chi, 0, 0, nspecies, ng);
+    MultiFab::Subtract(kappa_s, kappa, 0, 0, 1, ng);
+    MultiFab::Subtract(zeta_s, zeta, 0, 0, 1, ng);
+    MultiFab::Subtract(eta_s, eta, 0, 0, 1, ng);
+
+    Print() << "Transport coefficients, nspecies = " << nspecies
+            << ((nspecies >= 2 && nspecies <= 8) ? " (specialized)" : " (no specialization)") << "\n";
+    Print() << "  runtime nspecies: " << t_generic << " s, "
+            << ncells/t_generic << " cells/s\n";
+    Print() << "  dispatched:       " << t_special << " s, "
+            << ncells/t_special << " cells/s, speedup " << t_generic/t_special << "\n";
+    Print() << "  max difference: eta " << eta_s.norm0(0,ng)
+            << " zeta " << zeta_s.norm0(0,ng)
+            << " kappa " << kappa_s.norm0(0,ng)
+            << " chi " << chi_s.norm0(0,nspecies,IntVect(ng))
+            << " Dij " << Dij_s.norm0(0,nspecies*nspecies,IntVect(ng)) << "\n";
 }
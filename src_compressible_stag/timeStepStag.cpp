@@ -17,6 +17,17 @@ void RK3stepStag(MultiFab& cu,
                  std::array< MultiFab, 2 >& edgeflux_y,
                  std::array< MultiFab, 2 >& edgeflux_z,
                  std::array< MultiFab, AMREX_SPACEDIM>& cenflux,
+                 std::array< MultiFab, AMREX_SPACEDIM >& stochface,
+                 std::array< MultiFab, 2 >& stochedge_x,
+                 std::array< MultiFab, 2 >& stochedge_y,
+                 std::array< MultiFab, 2 >& stochedge_z,
+                 std::array< MultiFab, AMREX_SPACEDIM >& stochcen,
+                 std::array< MultiFab, AMREX_SPACEDIM >& stochface_AB,
+                 std::array< MultiFab, 2 >& stochedge_x_AB,
+                 std::array< MultiFab, 2 >& stochedge_y_AB,
+                 std::array< MultiFab, 2 >& stochedge_z_AB,
+                 std::array< MultiFab, AMREX_SPACEDIM >& stochcen_AB,
+                 MultiFab& transport_ref,
                  const amrex::Geometry geom, const amrex::Real dt, const int step)
 {
     BL_PROFILE_VAR("RK3stepStag()",RK3stepStag);
@@ -48,32 +59,6 @@ void RK3stepStag(MultiFab& cu,
 
     const GpuArray<Real, AMREX_SPACEDIM> dx = geom.CellSizeArray();
     
-    /////////////////////////////////////////////////////
-    // Setup stochastic flux MultiFabs
-    std::array< MultiFab, AMREX_SPACEDIM > stochface;
-    AMREX_D_TERM(stochface[0].define(convert(cu.boxArray(),nodal_flag_x), cu.DistributionMap(), nvars, 0);,
-                 stochface[1].define(convert(cu.boxArray(),nodal_flag_y), cu.DistributionMap(), nvars, 0);,
-                 stochface[2].define(convert(cu.boxArray(),nodal_flag_z), cu.DistributionMap(), nvars, 0););
-    
-    std::array< MultiFab, 2 > stochedge_x; 
-    std::array< MultiFab, 2 > stochedge_y; 
-    std::array< MultiFab, 2 > stochedge_z; 
-
-    stochedge_x[0].define(convert(cu.boxArray(),nodal_flag_xy), cu.DistributionMap(), 1, 0); 
-    stochedge_x[1].define(convert(cu.boxArray(),nodal_flag_xz), cu.DistributionMap(), 1, 0);
-             
-    stochedge_y[0].define(convert(cu.boxArray(),nodal_flag_xy), cu.DistributionMap(), 1, 0);
-    stochedge_y[1].define(convert(cu.boxArray(),nodal_flag_yz), cu.DistributionMap(), 1, 0);
-
-    stochedge_z[0].define(convert(cu.boxArray(),nodal_flag_xz), cu.DistributionMap(), 1, 0);
-    stochedge_z[1].define(convert(cu.boxArray(),nodal_flag_yz), cu.DistributionMap(), 1, 0);
-
-    std::array< MultiFab, AMREX_SPACEDIM > stochcen;
-    AMREX_D_TERM(stochcen[0].define(cu.boxArray(),cu.DistributionMap(),1,0);, 
-                 stochcen[1].define(cu.boxArray(),cu.DistributionMap(),1,0);,
-                 stochcen[2].define(cu.boxArray(),cu.DistributionMap(),1,0););
-    /////////////////////////////////////////////////////
-
     /////////////////////////////////////////////////////
     // Initialize white noise weighted fields
     // weights for stochastic fluxes; swgt2 changes each stage
@@ -81,96 +66,19 @@ void RK3stepStag(MultiFab& cu,
     amrex::Real swgt1, swgt2;
     swgt1 = 1.0;
 
-    // field "A"
-    std::array< MultiFab, AMREX_SPACEDIM > stochface_A;
-    AMREX_D_TERM(stochface_A[0].define(stochface[0].boxArray(), stochface[0].DistributionMap(), nvars, 0);,
-                 stochface_A[1].define(stochface[1].boxArray(), stochface[1].DistributionMap(), nvars, 0);,
-                 stochface_A[2].define(stochface[2].boxArray(), stochface[2].DistributionMap(), nvars, 0););
-
-    AMREX_D_TERM(stochface_A[0].setVal(0.0);,
-                 stochface_A[1].setVal(0.0);,
-                 stochface_A[2].setVal(0.0););
-    
-    std::array< MultiFab, 2 > stochedge_x_A; 
-    std::array< MultiFab, 2 > stochedge_y_A; 
-    std::array< MultiFab, 2 > stochedge_z_A; 
-
-    stochedge_x_A[0].define(stochedge_x[0].boxArray(), stochedge_x[0].DistributionMap(), 1, 0); 
-    stochedge_x_A[1].define(stochedge_x[1].boxArray(), stochedge_x[1].DistributionMap(), 1, 0);
-             
-    stochedge_y_A[0].define(stochedge_y[0].boxArray(), stochedge_y[0].DistributionMap(), 1, 0);
-    stochedge_y_A[1].define(stochedge_y[1].boxArray(), stochedge_y[1].DistributionMap(), 1, 0);
-
-    stochedge_z_A[0].define(stochedge_z[0].boxArray(), stochedge_z[0].DistributionMap(), 1, 0);
-    stochedge_z_A[1].define(stochedge_z[1].boxArray(), stochedge_z[1].DistributionMap(), 1, 0);
-
-    stochedge_x_A[0].setVal(0.0); stochedge_x_A[1].setVal(0.0);
-    stochedge_y_A[0].setVal(0.0); stochedge_y_A[1].setVal(0.0);
-    stochedge_z_A[0].setVal(0.0); stochedge_z_A[1].setVal(0.0);
-
-    std::array< MultiFab, AMREX_SPACEDIM > stochcen_A;
-    AMREX_D_TERM(stochcen_A[0].define(stochcen[0].boxArray(),stochcen[0].DistributionMap(),1,0);, 
-                 stochcen_A[1].define(stochcen[1].boxArray(),stochcen[1].DistributionMap(),1,0);,
-                 stochcen_A[2].define(stochcen[2].boxArray(),stochcen[2].DistributionMap(),1,0););
-
-    AMREX_D_TERM(stochcen_A[0].setVal(0.0);,
-                 stochcen_A[1].setVal(0.0);,
-                 stochcen_A[2].setVal(0.0););
-
-    // field "B"
-    std::array< MultiFab, AMREX_SPACEDIM > stochface_B;
-    AMREX_D_TERM(stochface_B[0].define(stochface[0].boxArray(), stochface[0].DistributionMap(), nvars, 0);,
-                 stochface_B[1].define(stochface[1].boxArray(), stochface[1].DistributionMap(), nvars, 0);,
-                 stochface_B[2].define(stochface[2].boxArray(), stochface[2].DistributionMap(), nvars, 0););
-
-    AMREX_D_TERM(stochface_B[0].setVal(0.0);,
-                 stochface_B[1].setVal(0.0);,
-                 stochface_B[2].setVal(0.0););
-    
-    std::array< MultiFab, 2 > stochedge_x_B; 
-    std::array< MultiFab, 2 > stochedge_y_B; 
-    std::array< MultiFab, 2 > stochedge_z_B; 
-
-    stochedge_x_B[0].define(stochedge_x[0].boxArray(), stochedge_x[0].DistributionMap(), 1, 0); 
-    stochedge_x_B[1].define(stochedge_x[1].boxArray(), stochedge_x[1].DistributionMap(), 1, 0);
-             
-    stochedge_y_B[0].define(stochedge_y[0].boxArray(), stochedge_y[0].DistributionMap(), 1, 0);
-    stochedge_y_B[1].define(stochedge_y[1].boxArray(), stochedge_y[1].DistributionMap(), 1, 0);
-
-    stochedge_z_B[0].define(stochedge_z[0].boxArray(), stochedge_z[0].DistributionMap(), 1, 0);
-    stochedge_z_B[1].define(stochedge_z[1].boxArray(), stochedge_z[1].DistributionMap(), 1, 0);
-
-    stochedge_x_B[0].setVal(0.0); stochedge_x_B[1].setVal(0.0);
-    stochedge_y_B[0].setVal(0.0); stochedge_y_B[1].setVal(0.0);
-    stochedge_z_B[0].setVal(0.0); stochedge_z_B[1].setVal(0.0);
-
-    std::array< MultiFab, AMREX_SPACEDIM > stochcen_B;
-    AMREX_D_TERM(stochcen_B[0].define(stochcen[0].boxArray(),stochcen[0].DistributionMap(),1,0);, 
-                 stochcen_B[1].define(stochcen[1].boxArray(),stochcen[1].DistributionMap(),1,0);,
-                 stochcen_B[2].define(stochcen[2].boxArray(),stochcen[2].DistributionMap(),1,0););
-
-    AMREX_D_TERM(stochcen_B[0].setVal(0.0);,
-                 stochcen_B[1].setVal(0.0);,
-                 stochcen_B[2].setVal(0.0););
-
-    // fill random numbers (can skip density component 0)
+    // fill random numbers for fields "A" and "B"; the *_AB MultiFabs hold A in
+    // the first half of their components and B in the second half, so one
+    // batched fill covers both (density component 0 is skipped)
     for(int d=0;d<AMREX_SPACEDIM;d++) {
-     	for(int i=1;i<nvars;i++) {
-    	    MultiFabFillRandom(stochface_A[d], i, 1.0, geom);
-	        MultiFabFillRandom(stochface_B[d], i, 1.0, geom);
-        }
+        MultiFabFillRandom(stochface_AB[d], 0, 2*(nvars-1), 1.0, geom);
     }
     for (int i=0; i<2; i++) {
-        MultiFabFillRandom(stochedge_x_A[i], 0, 1.0, geom);
-        MultiFabFillRandom(stochedge_x_B[i], 0, 1.0, geom);
-        MultiFabFillRandom(stochedge_y_A[i], 0, 1.0, geom);
-        MultiFabFillRandom(stochedge_y_B[i], 0, 1.0, geom);
-        MultiFabFillRandom(stochedge_z_A[i], 0, 1.0, geom);
-        MultiFabFillRandom(stochedge_z_B[i], 0, 1.0, geom);
+        MultiFabFillRandom(stochedge_x_AB[i], 0, 2, 1.0, geom);
+        MultiFabFillRandom(stochedge_y_AB[i], 0, 2, 1.0, geom);
+        MultiFabFillRandom(stochedge_z_AB[i], 0, 2, 1.0, geom);
     }
     for (int i=0; i<3; i++) {
-        MultiFabFillRandom(stochcen_A[i], 0, 2.0, geom);
-        MultiFabFillRandom(stochcen_B[i], 0, 2.0, geom);
+        MultiFabFillRandom(stochcen_AB[i], 0, 2, 2.0, geom);
     }
     /////////////////////////////////////////////////////
 
@@ -195,34 +103,34 @@ void RK3stepStag(MultiFab& cu,
 
     for (int d=0;d<AMREX_SPACEDIM;d++) {
 	    MultiFab::LinComb(stochface[d], 
-            stoch_weights[0], stochface_A[d], 1, 
-            stoch_weights[1], stochface_B[d], 1,
+            stoch_weights[0], stochface_AB[d], 0, 
+            stoch_weights[1], stochface_AB[d], nvars-1,
             1, nvars-1, 0);
     }
     for (int i=0;i<2;i++) {
         MultiFab::LinComb(stochedge_x[i],
-            stoch_weights[0], stochedge_x_A[i], 0,
-            stoch_weights[1], stochedge_x_B[i], 0,
+            stoch_weights[0], stochedge_x_AB[i], 0,
+            stoch_weights[1], stochedge_x_AB[i], 1,
             0, 1, 0);
         MultiFab::LinComb(stochedge_y[i],
-            stoch_weights[0], stochedge_y_A[i], 0,
-            stoch_weights[1], stochedge_y_B[i], 0,
+            stoch_weights[0], stochedge_y_AB[i], 0,
+            stoch_weights[1], stochedge_y_AB[i], 1,
             0, 1, 0);
         MultiFab::LinComb(stochedge_z[i],
-            stoch_weights[0], stochedge_z_A[i], 0,
-            stoch_weights[1], stochedge_z_B[i], 0,
+            stoch_weights[0], stochedge_z_AB[i], 0,
+            stoch_weights[1], stochedge_z_AB[i], 1,
             0, 1, 0);
     }
     for (int i=0;i<3;i++) {
         MultiFab::LinComb(stochcen[i],
-            stoch_weights[0], stochcen_A[i], 0,
-            stoch_weights[1], stochcen_B[i], 0,
+            stoch_weights[0], stochcen_AB[i], 0,
+            stoch_weights[1], stochcen_AB[i], 1,
             0, 1, 0);
     }
     /////////////////////////////////////////////////////
 
     // Compute transport coefs after setting BCs    
-    calculateTransportCoeffs(prim, eta, zeta, kappa, chi, D);
+    calculateTransportCoeffs(prim, eta, zeta, kappa, chi, D, transport_ref);
 
     calculateFluxStag(cu, cumom, prim, vel, eta, zeta, kappa, chi, D, 
         faceflux, edgeflux_x, edgeflux_y, edgeflux_z, cenflux, 
@@ -345,7 +253,7 @@ void RK3stepStag(MultiFab& cu,
     setBCStag(prim, cup, cupmom, vel, geom);
 
     // Compute transport coefs after setting BCs
-    calculateTransportCoeffs(prim, eta, zeta, kappa, chi, D);
+    calculateTransportCoeffs(prim, eta, zeta, kappa, chi, D, transport_ref);
 
     ///////////////////////////////////////////////////////////
     // Perform weighting of white noise fields
@@ -369,28 +277,28 @@ void RK3stepStag(MultiFab& cu,
 
     for (int d=0;d<AMREX_SPACEDIM;d++) {
 	    MultiFab::LinComb(stochface[d], 
-            stoch_weights[0], stochface_A[d], 1, 
-            stoch_weights[1], stochface_B[d], 1,
+            stoch_weights[0], stochface_AB[d], 0, 
+            stoch_weights[1], stochface_AB[d], nvars-1,
             1, nvars-1, 0);
     }
     for (int i=0;i<2;i++) {
         MultiFab::LinComb(stochedge_x[i],
-            stoch_weights[0], stochedge_x_A[i], 0,
-            stoch_weights[1], stochedge_x_B[i], 0,
+            stoch_weights[0], stochedge_x_AB[i], 0,
+            stoch_weights[1], stochedge_x_AB[i], 1,
             0, 1, 0);
         MultiFab::LinComb(stochedge_y[i],
-            stoch_weights[0], stochedge_y_A[i], 0,
-            stoch_weights[1], stochedge_y_B[i], 0,
+            stoch_weights[0], stochedge_y_AB[i], 0,
+            stoch_weights[1], stochedge_y_AB[i], 1,
             0, 1, 0);
         MultiFab::LinComb(stochedge_z[i],
-            stoch_weights[0], stochedge_z_A[i], 0,
-            stoch_weights[1], stochedge_z_B[i], 0,
+            stoch_weights[0], stochedge_z_AB[i], 0,
+            stoch_weights[1], stochedge_z_AB[i], 1,
             0, 1, 0);
     }
     for (int i=0;i<3;i++) {
         MultiFab::LinComb(stochcen[i],
-            stoch_weights[0], stochcen_A[i], 0,
-            stoch_weights[1], stochcen_B[i], 0,
+            stoch_weights[0], stochcen_AB[i], 0,
+            stoch_weights[1], stochcen_AB[i], 1,
             0, 1, 0);
     }
     ///////////////////////////////////////////////////////////
@@ -521,7 +429,7 @@ void RK3stepStag(MultiFab& cu,
     setBCStag(prim, cup2, cup2mom, vel, geom);
 
     // Compute transport coefs after setting BCs
-    calculateTransportCoeffs(prim, eta, zeta, kappa, chi, D);
+    calculateTransportCoeffs(prim, eta, zeta, kappa, chi, D, transport_ref);
 
     ///////////////////////////////////////////////////////////
     // Perform weighting of white noise fields
@@ -545,28 +453,28 @@ void RK3stepStag(MultiFab& cu,
 
     for (int d=0;d<AMREX_SPACEDIM;d++) {
 	    MultiFab::LinComb(stochface[d], 
-            stoch_weights[0], stochface_A[d], 1, 
-            stoch_weights[1], stochface_B[d], 1,
+            stoch_weights[0], stochface_AB[d], 0, 
+            stoch_weights[1], stochface_AB[d], nvars-1,
             1, nvars-1, 0);
     }
     for (int i=0;i<2;i++) {
         MultiFab::LinComb(stochedge_x[i],
-            stoch_weights[0], stochedge_x_A[i], 0,
-            stoch_weights[1], stochedge_x_B[i], 0,
+            stoch_weights[0], stochedge_x_AB[i], 0,
+            stoch_weights[1], stochedge_x_AB[i], 1,
             0, 1, 0);
         MultiFab::LinComb(stochedge_y[i],
-            stoch_weights[0], stochedge_y_A[i], 0,
-            stoch_weights[1], stochedge_y_B[i], 0,
+            stoch_weights[0], stochedge_y_AB[i], 0,
+            stoch_weights[1], stochedge_y_AB[i], 1,
             0, 1, 0);
         MultiFab::LinComb(stochedge_z[i],
-            stoch_weights[0], stochedge_z_A[i], 0,
-            stoch_weights[1], stochedge_z_B[i], 0,
+            stoch_weights[0], stochedge_z_AB[i], 0,
+            stoch_weights[1], stochedge_z_AB[i], 1,
             0, 1, 0);
     }
     for (int i=0;i<3;i++) {
         MultiFab::LinComb(stochcen[i],
-            stoch_weights[0], stochcen_A[i], 0,
-            stoch_weights[1], stochcen_B[i], 0,
+            stoch_weights[0], stochcen_AB[i], 0,
+            stoch_weights[1], stochcen_AB[i], 1,
             0, 1, 0);
     }
     ///////////////////////////////////////////////////////////
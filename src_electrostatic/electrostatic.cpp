@@ -1,14 +1,112 @@
 #include "electrostatic.H"
 #include "common_functions.H"
-#include <AMReX_MLMG.H>
 
 using namespace amrex;
 
-void esSolve(MultiFab& potential, MultiFab& charge,
-             std::array< MultiFab, AMREX_SPACEDIM >& efieldCC,
-             const std::array< MultiFab, AMREX_SPACEDIM >& external, const Geometry geom)
+ElectrostaticSolver::ElectrostaticSolver(const BoxArray& ba_in,
+                                         const DistributionMapping& dmap_in,
+                                         const Geometry& geom_in)
 {
-    BL_PROFILE_VAR("esSolve()",esSolve);
+    BL_PROFILE_VAR("ElectrostaticSolver::ElectrostaticSolver()",ElectrostaticSolver);
+
+    if (es_tog == 2) {
+        Abort("ElectrostaticSolver: es_tog=2 (pairwise Coulomb) has been removed; use es_tog=3 (P3M)");
+    }
+
+    if (es_tog != 1 && es_tog != 3) {
+        return;
+    }
+
+    bool all_periodic = true;
+    for (int i=0; i<AMREX_SPACEDIM; ++i) {
+        if (bc_es_lo[i] != -1 || bc_es_hi[i] != -1) {
+            all_periodic = false;
+        }
+    }
+
+    if (poisson_fft == 1 && !all_periodic) {
+        Abort("ElectrostaticSolver: poisson_fft=1 requires bc_es_lo = bc_es_hi = -1");
+    }
+
+    use_fft = (poisson_fft == 1);
+
+    if (use_fft) {
+        InitFFTW(ba_in, geom_in);
+        return;
+    }
+
+    LinOpBCType lo_linop_bc[3];
+    LinOpBCType hi_linop_bc[3];
+
+    for (int i=0; i<AMREX_SPACEDIM; ++i) {
+        if (bc_es_lo[i] == -1 && bc_es_hi[i] == -1) {
+            lo_linop_bc[i] = LinOpBCType::Periodic;
+            hi_linop_bc[i] = LinOpBCType::Periodic;
+        }
+        if(bc_es_lo[i] == 2)
+        {
+            lo_linop_bc[i] = LinOpBCType::inhomogNeumann;
+//            lo_linop_bc[i] = LinOpBCType::Neumann;
+        }
+        if(bc_es_hi[i] == 2)
+        {
+            hi_linop_bc[i] = LinOpBCType::inhomogNeumann;
+//            hi_linop_bc[i] = LinOpBCType::Neumann;
+        }
+        if(bc_es_lo[i] == 1)
+        {
+            lo_linop_bc[i] = LinOpBCType::Dirichlet;
+        }
+        if(bc_es_hi[i] == 1)
+        {
+            hi_linop_bc[i] = LinOpBCType::Dirichlet;
+        }
+    }
+
+    //create solver opject
+    linop.reset(new MLPoisson({geom_in}, {ba_in}, {dmap_in}));
+
+    //set BCs
+    linop->setDomainBC({AMREX_D_DECL(lo_linop_bc[0],
+                                     lo_linop_bc[1],
+                                     lo_linop_bc[2])},
+                       {AMREX_D_DECL(hi_linop_bc[0],
+                                     hi_linop_bc[1],
+                                     hi_linop_bc[2])});
+
+    // this forces the solver to NOT enforce solvability
+    // thus if there are Neumann conditions on phi they must
+    // be correct or the Poisson solver won't converge
+    linop->setEnforceSingularSolvable(false);
+
+    //Multi Level Multi Grid
+    mlmg.reset(new MLMG(*linop));
+
+    //Solver parameters
+    mlmg->setMaxIter(poisson_max_iter);
+    mlmg->setVerbose(poisson_verbose);
+    mlmg->setBottomVerbose(poisson_bottom_verbose);
+}
+
+ElectrostaticSolver::~ElectrostaticSolver()
+{
+    if (fftw_forward_plan) {
+        fftw_destroy_plan(fftw_forward_plan);
+    }
+    if (fftw_backward_plan) {
+        fftw_destroy_plan(fftw_backward_plan);
+    }
+    if (fftw_data) {
+        fftw_free(fftw_data);
+    }
+}
+
+void ElectrostaticSolver::Solve(MultiFab& potential, MultiFab& charge,
+                                std::array< MultiFab, AMREX_SPACEDIM >& efieldCC,
+                                const std::array< MultiFab, AMREX_SPACEDIM >& external,
+                                const Geometry& geom)
+{
+    BL_PROFILE_VAR("ElectrostaticSolver::Solve()",ElectrostaticSolver_Solve);
 
     AMREX_D_TERM(efieldCC[0].setVal(0);,
                  efieldCC[1].setVal(0);,
@@ -16,76 +114,28 @@ void esSolve(MultiFab& potential, MultiFab& charge,
 
     if(es_tog==1 || es_tog==3)
     {
+        if (use_fft) {
 
-        LinOpBCType lo_linop_bc[3];
-        LinOpBCType hi_linop_bc[3];
+            FFTSolve(potential, charge);
 
-        for (int i=0; i<AMREX_SPACEDIM; ++i) {
-            if (bc_es_lo[i] == -1 && bc_es_hi[i] == -1) {
-                lo_linop_bc[i] = LinOpBCType::Periodic;
-                hi_linop_bc[i] = LinOpBCType::Periodic;
-            }
-            if(bc_es_lo[i] == 2)
-            {
-                lo_linop_bc[i] = LinOpBCType::inhomogNeumann;
-//                lo_linop_bc[i] = LinOpBCType::Neumann;
-            }
-            if(bc_es_hi[i] == 2)
-            {
-                hi_linop_bc[i] = LinOpBCType::inhomogNeumann;
-//                hi_linop_bc[i] = LinOpBCType::Neumann;
-            }
-            if(bc_es_lo[i] == 1)
-            {                 
-                lo_linop_bc[i] = LinOpBCType::Dirichlet;
-            }
-            if(bc_es_hi[i] == 1)
-            {
-                hi_linop_bc[i] = LinOpBCType::Dirichlet;
-            }
+        } else {
+
+            // fill in ghost cells with Dirichlet/Neumann values
+            // the ghost cells will hold the value ON the boundary
+            MultiFabPotentialBC_solver(potential,geom);
+
+            // tell MLPoisson about these potentially inhomogeneous BC values
+            linop->setLevelBC(0, &potential);
+
+            //Do solve; potential still holds the previous solution,
+            //which is used as the initial guess
+            mlmg->solve({&potential}, {&charge}, poisson_rel_tol, 0.0);
         }
 
-        const BoxArray& ba = charge.boxArray();
-        const DistributionMapping& dmap = charge.DistributionMap();
-
-        //create solver opject
-        MLPoisson linop({geom}, {ba}, {dmap});
- 
-        //set BCs
-        linop.setDomainBC({AMREX_D_DECL(lo_linop_bc[0],
-                                        lo_linop_bc[1],
-                                        lo_linop_bc[2])},
-                          {AMREX_D_DECL(hi_linop_bc[0],
-                                        hi_linop_bc[1],
-                                        hi_linop_bc[2])});
-
-        // fill in ghost cells with Dirichlet/Neumann values
-        // the ghost cells will hold the value ON the boundary
-        MultiFabPotentialBC_solver(potential,geom);
-
-        // tell MLPoisson about these potentially inhomogeneous BC values
-        linop.setLevelBC(0, &potential);
-
-        // this forces the solver to NOT enforce solvability
-        // thus if there are Neumann conditions on phi they must
-        // be correct or the Poisson solver won't converge
-        linop.setEnforceSingularSolvable(false);
-
-        //Multi Level Multi Grid
-        MLMG mlmg(linop);
-
-        //Solver parameters
-        mlmg.setMaxIter(poisson_max_iter);
-        mlmg.setVerbose(poisson_verbose);
-        mlmg.setBottomVerbose(poisson_bottom_verbose);
-        
-        //Do solve
-        mlmg.solve({&potential}, {&charge}, poisson_rel_tol, 0.0);
-            
         potential.FillBoundary(geom.periodicity());
         // set ghost cell values so electric field is calculated properly
         // the ghost cells will hold the values extrapolated to the ghost CC
-        MultiFabPotentialBC(potential, geom); 
+        MultiFabPotentialBC(potential, geom);
 
         //Find e field, gradient from cell centers to faces
         ComputeCentredGrad(potential, efieldCC, geom);
@@ -100,4 +150,155 @@ void esSolve(MultiFab& potential, MultiFab& charge,
 
 }
 
+void ElectrostaticSolver::InitFFTW(const BoxArray& ba_in, const Geometry& geom)
+{
+    BL_PROFILE_VAR("ElectrostaticSolver::InitFFTW()",InitFFTW);
+
+    Box domain = ba_in.minimalBox();
+
+    // transform dimensions in row-major (FFTW) order; the slowest one is
+    // split across ranks
+    const int rnk = AMREX_SPACEDIM;
+    ptrdiff_t nn[3];
+    for (int d=0; d<rnk; ++d) {
+        nn[d] = domain.length(rnk-1-d);
+    }
+    const int slab_dir = rnk-1;
+
+    MPI_Comm comm = ParallelDescriptor::Communicator();
+
+    // fftw-mpi must be initialized once per process, not per solver
+    static bool fftw_mpi_initialized = false;
+    if (!fftw_mpi_initialized) {
+        fftw_mpi_init();
+        fftw_mpi_initialized = true;
+    }
+
+    ptrdiff_t local_n0, local_0_start;
+    ptrdiff_t alloc_local = fftw_mpi_local_size(rnk, nn, comm, &local_n0, &local_0_start);
+
+    // gather the slab decomposition chosen by fftw-mpi
+    const int nprocs = ParallelDescriptor::NProcs();
+    const int myproc = ParallelDescriptor::MyProc();
+    Vector<int> slab_n(nprocs,0);
+    Vector<int> slab_lo(nprocs,0);
+    slab_n[myproc] = local_n0;
+    slab_lo[myproc] = local_0_start;
+    ParallelDescriptor::ReduceIntSum(slab_n.dataPtr(),nprocs);
+    ParallelDescriptor::ReduceIntSum(slab_lo.dataPtr(),nprocs);
+
+    BoxList bl;
+    Vector<int> pmap;
+    for (int p=0; p<nprocs; ++p) {
+        if (slab_n[p] > 0) {
+            Box bx = domain;
+            bx.setSmall(slab_dir, domain.smallEnd(slab_dir) + slab_lo[p]);
+            bx.setBig  (slab_dir, domain.smallEnd(slab_dir) + slab_lo[p] + slab_n[p] - 1);
+            bl.push_back(bx);
+            pmap.push_back(p);
+        }
+    }
+    ba_fft.define(bl);
+    dm_fft.define(pmap);
+
+    rhs_fft.define(ba_fft, dm_fft, 1, 0);
+
+    fftw_data = fftw_alloc_complex(amrex::max(alloc_local,(ptrdiff_t) 1));
+
+    // in-place, untransposed, so the spectral data has the slab layout of the
+    // real-space data
+    fftw_forward_plan = fftw_mpi_plan_dft(rnk, nn, fftw_data, fftw_data, comm,
+                                          FFTW_FORWARD, FFTW_MEASURE);
+    fftw_backward_plan = fftw_mpi_plan_dft(rnk, nn, fftw_data, fftw_data, comm,
+                                           FFTW_BACKWARD, FFTW_MEASURE);
+
+    // eigenvalues of the second-order discrete Laplacian MLPoisson uses,
+    // so both solvers give the same potential
+    const Real* dx = geom.CellSize();
+    for (int d=0; d<AMREX_SPACEDIM; ++d) {
+        const int n = domain.length(d);
+        lap_eig[d].resize(n);
+        for (int m=0; m<n; ++m) {
+            lap_eig[d][m] = (2.*std::cos(2.*M_PI*m/n) - 2.) / (dx[d]*dx[d]);
+        }
+    }
+}
+
+void ElectrostaticSolver::FFTSolve(MultiFab& potential, const MultiFab& charge)
+{
+    BL_PROFILE_VAR("ElectrostaticSolver::FFTSolve()",FFTSolve);
+
+    rhs_fft.ParallelCopy(charge, 0, 0, 1);
+
+    const Box& domain = ba_fft.minimalBox();
+    const Dim3 dlo = amrex::lbound(domain);
+    const Real npts = domain.numPts();
+
+    AMREX_D_TERM(const Real* eigx = lap_eig[0].dataPtr();,
+                 const Real* eigy = lap_eig[1].dataPtr();,
+                 const Real* eigz = lap_eig[2].dataPtr(););
+
+    // pack the local slab into the fftw-mpi buffer
+    for (MFIter mfi(rhs_fft); mfi.isValid(); ++mfi) {
+
+        const Box& bx = mfi.validbox();
+        const Array4<const Real>& rhs = rhs_fft.const_array(mfi);
+        const Dim3 lo = amrex::lbound(bx);
+        const Dim3 len = amrex::length(bx);
+        fftw_complex* data = fftw_data;
+
+        amrex::LoopOnCpu(bx, [=] (int i, int j, int k) noexcept
+        {
+            long cell = (long(k-lo.z)*len.y + (j-lo.y))*len.x + (i-lo.x);
+            data[cell][0] = rhs(i,j,k);
+            data[cell][1] = 0.;
+        });
+    }
+
+    // collective over all ranks, including those that own no slab
+    fftw_execute(fftw_forward_plan);
+
+    // divide by the Laplacian eigenvalues; the k=0 mode, which sets the
+    // arbitrary mean of the potential, is zeroed
+    for (MFIter mfi(rhs_fft); mfi.isValid(); ++mfi) {
+
+        const Box& bx = mfi.validbox();
+        const Dim3 lo = amrex::lbound(bx);
+        const Dim3 len = amrex::length(bx);
+        fftw_complex* data = fftw_data;
+
+        amrex::LoopOnCpu(bx, [=] (int i, int j, int k) noexcept
+        {
+            long cell = (long(k-lo.z)*len.y + (j-lo.y))*len.x + (i-lo.x);
+            Real eig = AMREX_D_TERM(eigx[i-dlo.x], + eigy[j-dlo.y], + eigz[k-dlo.z]);
+            if (eig == 0.) {
+                data[cell][0] = 0.;
+                data[cell][1] = 0.;
+            } else {
+                data[cell][0] /= (eig*npts);
+                data[cell][1] /= (eig*npts);
+            }
+        });
+    }
+
+    fftw_execute(fftw_backward_plan);
+
+    for (MFIter mfi(rhs_fft); mfi.isValid(); ++mfi) {
+
+        const Box& bx = mfi.validbox();
+        const Array4<Real>& phi = rhs_fft.array(mfi);
+        const Dim3 lo = amrex::lbound(bx);
+        const Dim3 len = amrex::length(bx);
+        const fftw_complex* data = fftw_data;
+
+        amrex::LoopOnCpu(bx, [=] (int i, int j, int k) noexcept
+        {
+            long cell = (long(k-lo.z)*len.y + (j-lo.y))*len.x + (i-lo.x);
+            phi(i,j,k) = data[cell][0];
+        });
+    }
+
+    potential.ParallelCopy(rhs_fft, 0, 0, 1);
+}
+
 
@@ -23,14 +23,79 @@ GMRES::GMRES (const BoxArray& ba_in,
 
     StagSolver.Define(ba_in,dmap_in,geom_in);
     Pcon.Define(ba_in,dmap_in,geom_in);
+
+    // the coefficients are fixed during a solve, so the multigrid hierarchies
+    // only need to be rebuilt when Solve() finds that they have changed
+    StagSolver.CacheCoefficients(1);
+    Pcon.CacheCoefficients(1);
+}
+
+// cheap checksum of the solver coefficients: two index-hashed moments of each
+// MultiFab plus theta_alpha, computed with one global reduction
+void GMRES::CoefFingerprint(const std::array<MultiFab, AMREX_SPACEDIM> & alpha_fc,
+                            const MultiFab & beta, const std::array<MultiFab, NUM_EDGE> & beta_ed,
+                            const MultiFab & gamma, Real theta_alpha,
+                            Vector<Real> & fingerprint)
+{
+    BL_PROFILE_VAR("GMRES::CoefFingerprint()", GMRES_CoefFingerprint);
+
+    Vector<const MultiFab*> coefs;
+    for (int d=0; d<AMREX_SPACEDIM; ++d) {
+        coefs.push_back(&alpha_fc[d]);
+    }
+    coefs.push_back(&beta);
+    coefs.push_back(&gamma);
+    for (int d=0; d<NUM_EDGE; ++d) {
+        coefs.push_back(&beta_ed[d]);
+    }
+
+    const int ncoefs = coefs.size();
+    fingerprint.resize(2*ncoefs+1);
+
+    ReduceOps<ReduceOpSum,ReduceOpSum> reduce_op;
+
+    for (int n=0; n<ncoefs; ++n) {
+
+        ReduceData<Real,Real> reduce_data(reduce_op);
+        using ReduceTuple = typename decltype(reduce_data)::Type;
+
+        for (MFIter mfi(*coefs[n],TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+
+            const Box& bx = mfi.tilebox();
+
+            const Array4<const Real> & coef = coefs[n]->const_array(mfi);
+
+            reduce_op.eval(bx, reduce_data,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
+            {
+                // position-dependent weights so that shifted or permuted
+                // coefficient fields give a different fingerprint
+                unsigned int hash = (unsigned int)(i)*73856093u
+                                  ^ (unsigned int)(j)*19349663u
+                                  ^ (unsigned int)(k)*83492791u;
+                Real w1 = 1. + Real(hash & 1023u)/1024.;
+                Real w2 = 1. + Real((hash >> 10) & 1023u)/1024.;
+                Real c = coef(i,j,k);
+                return {w1*c, w2*c*c};
+            });
+        }
+
+        ReduceTuple hv = reduce_data.value();
+        fingerprint[2*n  ] = amrex::get<0>(hv);
+        fingerprint[2*n+1] = amrex::get<1>(hv);
+    }
+
+    ParallelDescriptor::ReduceRealSum(fingerprint.dataPtr(),2*ncoefs);
+
+    fingerprint[2*ncoefs] = theta_alpha;
 }
 
 
 void GMRES::Solve (std::array<MultiFab, AMREX_SPACEDIM> & b_u, const MultiFab & b_p,
                    std::array<MultiFab, AMREX_SPACEDIM> & x_u, MultiFab & x_p,
                    std::array<MultiFab, AMREX_SPACEDIM> & alpha_fc,
-                   MultiFab & beta, std::array<MultiFab, NUM_EDGE> & beta_ed,
-                   MultiFab & gamma,
+                   MultiFab & beta_in, std::array<MultiFab, NUM_EDGE> & beta_ed_in,
+                   MultiFab & gamma_in,
                    Real theta_alpha,
                    const Geometry & geom,
                    Real & norm_pre_rhs)
@@ -49,6 +114,12 @@ void GMRES::Solve (std::array<MultiFab, AMREX_SPACEDIM> & b_u, const MultiFab &
 
     Vector<Vector<Real>> H(gmres_max_inner + 1, Vector<Real>(gmres_max_inner));
 
+    // recycling (gmres_recycle_dim > 0): unrotated Hessenberg matrix, E = C^H M^{-1} A V,
+    // and a work array for products with C
+    Vector<Vector<Real>> Hbar(gmres_max_inner + 1, Vector<Real>(gmres_max_inner));
+    Vector<Vector<Real>> E(amrex::max(gmres_recycle_dim,1), Vector<Real>(gmres_max_inner));
+    Vector<Real> hc(gmres_recycle_dim+1);
+
     int outer_iter, total_iter, i_copy; // for looping iteration
     int i=0;
 
@@ -67,6 +138,10 @@ void GMRES::Solve (std::array<MultiFab, AMREX_SPACEDIM> & b_u, const MultiFab &
 
     Vector<Real> inner_prod_vel(AMREX_SPACEDIM);
     Real inner_prod_pres;
+
+    // block inner products for gmres_orth_type=1 (CGS2)
+    Vector<Real> h1(gmres_max_inner+1);
+    Vector<Real> h2(gmres_max_inner+1);
     
     //////////////////////////////////////
 
@@ -76,10 +151,63 @@ void GMRES::Solve (std::array<MultiFab, AMREX_SPACEDIM> & b_u, const MultiFab &
      *                                                                          *
      ***************************************************************************/
 
-    // set alphainv_fc to 1/alpha_fc
-    for (int d=0; d<AMREX_SPACEDIM; ++d) {
-        alphainv_fc[d].setVal(1.);
-        alphainv_fc[d].divide(alpha_fc[d],0,1,0);
+    // the coefficient-dependent state (alphainv_fc, scaled viscosities and the
+    // multigrid coefficient hierarchies) is rebuilt only if the coefficients changed
+    bool coefs_changed = true;
+    bool recycle_stale = true;
+    if (gmres_cache_coefs == 1 || gmres_recycle_dim > 0) {
+        Vector<Real> fingerprint;
+        CoefFingerprint(alpha_fc, beta_in, beta_ed_in, gamma_in, theta_alpha, fingerprint);
+        recycle_stale = (fingerprint != coef_fingerprint);
+        if (gmres_cache_coefs == 1) {
+            coefs_changed = (coefs_valid == 0 || recycle_stale);
+        }
+        coef_fingerprint = fingerprint;
+    }
+
+    if (coefs_changed) {
+
+        // set alphainv_fc to 1/alpha_fc
+        for (int d=0; d<AMREX_SPACEDIM; ++d) {
+            alphainv_fc[d].setVal(1.);
+            alphainv_fc[d].divide(alpha_fc[d],0,1,0);
+        }
+
+        // scale the viscosities into our own copies; the caller's are left untouched
+        if (scale_factor != 1.) {
+            if (beta_s.boxArray() != beta_in.boxArray()) {
+                beta_s.define (beta_in.boxArray(),  beta_in.DistributionMap(),  1, beta_in.nGrow());
+                gamma_s.define(gamma_in.boxArray(), gamma_in.DistributionMap(), 1, gamma_in.nGrow());
+                for (int d=0; d<NUM_EDGE; ++d) {
+                    beta_ed_s[d].define(beta_ed_in[d].boxArray(), beta_ed_in[d].DistributionMap(),
+                                        1, beta_ed_in[d].nGrow());
+                }
+            }
+            MultiFab::Copy(beta_s, beta_in, 0, 0, 1, beta_s.nGrow());
+            beta_s.mult(scale_factor, 0, 1, beta_s.nGrow());
+            MultiFab::Copy(gamma_s, gamma_in, 0, 0, 1, gamma_s.nGrow());
+            gamma_s.mult(scale_factor, 0, 1, gamma_s.nGrow());
+            for (int d=0; d<NUM_EDGE; ++d) {
+                MultiFab::Copy(beta_ed_s[d], beta_ed_in[d], 0, 0, 1, beta_ed_s[d].nGrow());
+                beta_ed_s[d].mult(scale_factor, 0, 1, beta_ed_s[d].nGrow());
+            }
+        }
+
+        StagSolver.InvalidateCoefficients();
+        Pcon.InvalidateCoefficients();
+        coefs_valid = 1;
+    }
+
+    MultiFab& beta  = (scale_factor != 1.) ? beta_s  : beta_in;
+    MultiFab& gamma = (scale_factor != 1.) ? gamma_s : gamma_in;
+    std::array<MultiFab, NUM_EDGE>& beta_ed = (scale_factor != 1.) ? beta_ed_s : beta_ed_in;
+
+    // start from the solution of the previous call
+    if (gmres_warm_start == 1 && have_prev == 1) {
+        for (int d=0; d<AMREX_SPACEDIM; ++d) {
+            MultiFab::Copy(x_u[d], x_u_prev[d], 0, 0, 1, 0);
+        }
+        MultiFab::Copy(x_p, x_p_prev, 0, 0, 1, 0);
     }
 
     // apply scaling factor
@@ -92,12 +220,34 @@ void GMRES::Solve (std::array<MultiFab, AMREX_SPACEDIM> & b_u, const MultiFab &
         // scale the rhs:
         for (int d=0; d<AMREX_SPACEDIM; ++d)
             b_u[d].mult(scale_factor,0,1,b_u[d].nGrow());
+    }
+
+    // set up the recycled subspace
+    if (gmres_recycle_dim > 0) {
 
-        // scale the viscosities:
-        beta.mult(scale_factor, 0, 1, beta.nGrow());
-        gamma.mult(scale_factor, 0, 1, gamma.nGrow());
-        for (int d=0; d<NUM_EDGE; ++d)
-            beta_ed[d].mult(scale_factor, 0, 1, beta_ed[d].nGrow());
+        if (U_p.nComp() != gmres_recycle_dim) {
+            for (int d=0; d<AMREX_SPACEDIM; ++d) {
+                U_u[d].define(V_u[d].boxArray(), V_u[d].DistributionMap(), gmres_recycle_dim, 0);
+                C_u[d].define(V_u[d].boxArray(), V_u[d].DistributionMap(), gmres_recycle_dim, 0);
+            }
+            U_p.define(V_p.boxArray(), V_p.DistributionMap(), gmres_recycle_dim, 0);
+            C_p.define(V_p.boxArray(), V_p.DistributionMap(), gmres_recycle_dim, 0);
+            nrecycle = 0;
+            recycle_slot = 0;
+        }
+
+        // the operator changed, so C = M^{-1} A U no longer holds; rebuilding C
+        // would cost nrecycle preconditioner applications per call, which is no
+        // cheaper than the iterations it saves when the coefficients change every
+        // step, so the recycled subspace is discarded and refilled by this solve
+        if (recycle_stale) {
+            nrecycle = 0;
+            recycle_slot = 0;
+        }
+
+        if (gmres_verbose >= 2) {
+            Print() << "GMRES.cpp: recycling " << nrecycle << " Krylov directions" << std::endl;
+        }
     }
 
 
@@ -161,19 +311,8 @@ void GMRES::Solve (std::array<MultiFab, AMREX_SPACEDIM> & b_u, const MultiFab &
         // Calculate tmp = Ax
         ApplyMatrix(tmp_u, tmp_p, x_u, x_p, alpha_fc, beta, beta_ed, gamma, theta_alpha, geom);
 
-        // tmp = b - Ax
-        for (int d=0; d<AMREX_SPACEDIM; ++d) {
-            MultiFab::Subtract(tmp_u[d], b_u[d], 0, 0, 1, 0);
-            tmp_u[d].mult(-1., 0, 1, 0);
-        }
-        MultiFab::Subtract(tmp_p, b_p, 0, 0, 1, 0);
-        tmp_p.mult(-1., 0, 1, 0);
-
-
-        //_______________________________________________________________________
-        // un-preconditioned residuals
-        StagL2Norm(geom, tmp_u, 0, scr_u, norm_u_noprecon);
-        CCL2Norm(tmp_p, 0, scr_p, norm_p_noprecon);
+        // tmp = b - Ax, and the un-preconditioned residuals in the same pass
+        StagCCAxpbyNorm(1., b_u, b_p, -1., tmp_u, tmp_p, norm_u_noprecon, norm_p_noprecon);
         norm_p_noprecon   = p_norm_weight*norm_p_noprecon;
         norm_resid_Stokes = sqrt(norm_u_noprecon*norm_u_noprecon + norm_p_noprecon*norm_p_noprecon);
 
@@ -282,13 +421,38 @@ void GMRES::Solve (std::array<MultiFab, AMREX_SPACEDIM> & b_u, const MultiFab &
 
 
         //_______________________________________________________________________
-        // Create the first basis in Krylov space: V(1) = r / norm(r)
-        for (int d=0; d<AMREX_SPACEDIM; ++d) {
-            MultiFab::Copy(V_u[d], r_u[d], 0, 0, 1, 0);
-            V_u[d].mult(1./norm_resid, 0, 1, 0);
+        // With a recycled subspace, remove the part of r in range(C):
+        // x = x + U C^H r, r = r - C C^H r
+        if (nrecycle > 0) {
+            StagCCMultiInnerProd(geom, r_u, r_p, 0, C_u, C_p, nrecycle, p_norm_weight, hc, true);
+
+            StagCCMultiAxpy(x_u, x_p, 0, hc, U_u, U_p, nrecycle);
+
+            Real norm_sq = hc[nrecycle];
+            for (int j=0; j<nrecycle; ++j) {
+                norm_sq -= hc[j]*hc[j];
+                hc[j] = -hc[j];
+            }
+            StagCCMultiAxpy(r_u, r_p, 0, hc, C_u, C_p, nrecycle);
+
+            if (norm_sq > 1.e-2*hc[nrecycle]) {
+                norm_resid = sqrt(norm_sq);
+            } else {
+                StagL2Norm(geom, r_u, 0, scr_u, norm_u);
+                CCL2Norm(r_p, 0, scr_p, norm_p);
+                norm_p     = p_norm_weight*norm_p;
+                norm_resid = sqrt(norm_u*norm_u + norm_p*norm_p);
+            }
+
+            if (norm_resid == 0.) {
+                break; // exit OuterLoop; the recycled subspace contained the solution
+            }
         }
-        MultiFab::Copy(V_p, r_p, 0, 0, 1, 0);
-        V_p.mult(1./norm_resid, 0, 1, 0);
+
+
+        //_______________________________________________________________________
+        // Create the first basis in Krylov space: V(1) = r / norm(r)
+        StagCCAxpby(1./norm_resid, r_u, r_p, 0, 0., V_u, V_p, 0);
 
         // s = norm(r) * e_0
         std::fill(s.begin(), s.end(), 0.);
@@ -333,45 +497,85 @@ void GMRES::Solve (std::array<MultiFab, AMREX_SPACEDIM> & b_u, const MultiFab &
                        beta, beta_ed, gamma, theta_alpha, geom, StagSolver);
 
 
+            //___________________________________________________________________
+            // w = (I - C C^H) w, E(:,i) = C^H w
+            if (nrecycle > 0) {
+                StagCCMultiInnerProd(geom, w_u, w_p, 0, C_u, C_p, nrecycle, p_norm_weight, hc);
+                for (int j=0; j<nrecycle; ++j) {
+                    E[j][i] = hc[j];
+                    hc[j] = -hc[j];
+                }
+                StagCCMultiAxpy(w_u, w_p, 0, hc, C_u, C_p, nrecycle);
+            }
+
+
             //___________________________________________________________________
             // Form Hessenberg matrix H
-            for (int k=0; k<=i; ++k) {
-                // H(k,i) = dot_product(w, V(k))
-                //        = dot_product(w_u, V_u(k))+dot_product(w_p, V_p(k))
-                StagInnerProd(geom,w_u, 0, V_u, k, scr_u, inner_prod_vel);
-                CCInnerProd(w_p, 0, V_p, k, scr_p, inner_prod_pres);
-                H[k][i] = std::accumulate(inner_prod_vel.begin(), inner_prod_vel.end(), 0.) 
-                          + pow(p_norm_weight, 2.0)*inner_prod_pres;
+            if (gmres_orth_type == 1) {
 
+                // CGS2: two classical Gram-Schmidt passes against all of V(0:i),
+                // each with a single block reduction and a single fused update
+                // H(0:i,i) = dot_product(w, V(0:i))
+                StagCCMultiInnerProd(geom, w_u, w_p, 0, V_u, V_p, i+1, p_norm_weight, h1);
 
-                // w = w - H(k,i) * V(k)
-                // use tmp_u and tmp_p as temporaries to hold kth component of V(k)
-                for (int d=0; d<AMREX_SPACEDIM; ++d) {
-                    MultiFab::Copy(tmp_u[d], V_u[d], k, 0, 1, 0);
-                    tmp_u[d].mult(H[k][i], 0, 1, 0);
-                    MultiFab::Subtract(w_u[d], tmp_u[d], 0, 0, 1, 0);
+                // w = w - V(0:i) * H(0:i,i)
+                for (int k=0; k<=i; ++k) {
+                    h1[k] = -h1[k];
                 }
-                MultiFab::Copy(tmp_p, V_p, k, 0, 1, 0);
-                tmp_p.mult(H[k][i], 0, 1, 0);
-                MultiFab::Subtract(w_p,tmp_p, 0, 0, 1, 0);
-            }
+                StagCCMultiAxpy(w_u, w_p, 0, h1, V_u, V_p, i+1);
+
+                // re-orthogonalize; the same reduction also returns <w,w>
+                StagCCMultiInnerProd(geom, w_u, w_p, 0, V_u, V_p, i+1, p_norm_weight, h2, true);
+
+                Real proj_sq = 0.;
+                for (int k=0; k<=i; ++k) {
+                    H[k][i] = h2[k] - h1[k];
+                    proj_sq += h2[k]*h2[k];
+                    h2[k] = -h2[k];
+                }
+
+                StagCCMultiAxpy(w_u, w_p, 0, h2, V_u, V_p, i+1);
+
+                // H(i+1,i) = norm(w) = sqrt(<w,w> - |h2|^2) by Pythagoras;
+                // recompute directly if that difference suffers from cancellation
+                Real norm_sq = h2[i+1] - proj_sq;
+                if (norm_sq > 1.e-2*h2[i+1]) {
+                    H[i+1][i] = sqrt(norm_sq);
+                } else {
+                    StagL2Norm(geom, w_u, 0, scr_u, norm_u);
+                    CCL2Norm(w_p, 0, scr_p, norm_p);
+                    norm_p    = p_norm_weight*norm_p;
+                    H[i+1][i] = sqrt(norm_u*norm_u + norm_p*norm_p);
+                }
+
+            } else {
 
-            // H(i+1,i) = norm(w)
-            StagL2Norm(geom, w_u, 0, scr_u, norm_u);
-            CCL2Norm(w_p, 0, scr_p, norm_p);
-            norm_p    = p_norm_weight*norm_p;
-            H[i+1][i] = sqrt(norm_u*norm_u + norm_p*norm_p);
+                for (int k=0; k<=i; ++k) {
+                    // H(k,i) = dot_product(w, V(k))
+                    //        = dot_product(w_u, V_u(k))+dot_product(w_p, V_p(k))
+                    StagInnerProd(geom,w_u, 0, V_u, k, scr_u, inner_prod_vel);
+                    CCInnerProd(w_p, 0, V_p, k, scr_p, inner_prod_pres);
+                    H[k][i] = std::accumulate(inner_prod_vel.begin(), inner_prod_vel.end(), 0.) 
+                              + pow(p_norm_weight, 2.0)*inner_prod_pres;
+
+
+                    // w = w - H(k,i) * V(k)
+                    StagCCAxpby(-H[k][i], V_u, V_p, k, 1., w_u, w_p, 0);
+                }
+
+                // H(i+1,i) = norm(w)
+                StagL2Norm(geom, w_u, 0, scr_u, norm_u);
+                CCL2Norm(w_p, 0, scr_p, norm_p);
+                norm_p    = p_norm_weight*norm_p;
+                H[i+1][i] = sqrt(norm_u*norm_u + norm_p*norm_p);
+
+            }
 
 
             //___________________________________________________________________
             // V(i+1) = w / H(i+1,i)
             if (H[i+1][i] != 0.) {
-                for (int d=0; d<AMREX_SPACEDIM; ++d) {
-                    MultiFab::Copy(V_u[d], w_u[d], 0, i + 1, 1, 0);
-                    V_u[d].mult(1./H[i+1][i], i + 1, 1, 0);
-                }
-                MultiFab::Copy(V_p, w_p, 0, i + 1, 1, 0);
-                V_p.mult(1./H[i+1][i], i + 1, 1, 0);
+                StagCCAxpby(1./H[i+1][i], w_u, w_p, 0, 0., V_u, V_p, i+1);
             } else {
                 Abort("GMRES.cpp: error in orthogonalization");
             }
@@ -379,6 +583,9 @@ void GMRES::Solve (std::array<MultiFab, AMREX_SPACEDIM> & b_u, const MultiFab &
 
             //___________________________________________________________________
             // solve least square problem
+            for (int k=0; k<=i+1; ++k) {
+                Hbar[k][i] = H[k][i];
+            }
             LeastSquares(i, H, cs, sn, s);
             norm_resid_est = amrex::Math::abs(s[i+1]);
 
@@ -412,8 +619,56 @@ void GMRES::Solve (std::array<MultiFab, AMREX_SPACEDIM> & b_u, const MultiFab &
         // first, solve for y
         SolveUTriangular(i_copy-1, H, s, y);
 
-        // then, x = x + dot(V(1:i),y(1:i))
-        UpdateSol(x_u,x_p,V_u,V_p,y,i_copy);
+        if (gmres_recycle_dim > 0) {
+
+            // z = V(0:i) y - U E y; x = x + z
+            for (int d=0; d<AMREX_SPACEDIM; ++d) {
+                tmp_u[d].setVal(0.);
+            }
+            tmp_p.setVal(0.);
+            StagCCMultiAxpy(tmp_u, tmp_p, 0, y, V_u, V_p, i_copy+1);
+            if (nrecycle > 0) {
+                for (int j=0; j<nrecycle; ++j) {
+                    hc[j] = 0.;
+                    for (int l=0; l<=i_copy; ++l) {
+                        hc[j] -= E[j][l]*y[l];
+                    }
+                }
+                StagCCMultiAxpy(tmp_u, tmp_p, 0, hc, U_u, U_p, nrecycle);
+            }
+            StagCCAxpby(1., tmp_u, tmp_p, 0, 1., x_u, x_p, 0);
+
+            // M^{-1} A z = V(0:i+1) Hbar y is already orthogonal to C, with norm |Hbar y|;
+            // store the normalized pair (z, M^{-1} A z), replacing the oldest one if full
+            Vector<Real> hy(i_copy+2, 0.);
+            Real hy_norm_sq = 0.;
+            for (int k=0; k<=i_copy+1; ++k) {
+                for (int l=amrex::max(k-1,0); l<=i_copy; ++l) {
+                    hy[k] += Hbar[k][l]*y[l];
+                }
+                hy_norm_sq += hy[k]*hy[k];
+            }
+
+            if (hy_norm_sq > 0.) {
+                Real hy_norm_inv = 1./sqrt(hy_norm_sq);
+
+                StagCCAxpby(hy_norm_inv, tmp_u, tmp_p, 0, 0., U_u, U_p, recycle_slot);
+
+                for (int d=0; d<AMREX_SPACEDIM; ++d) {
+                    tmp_u[d].setVal(0.);
+                }
+                tmp_p.setVal(0.);
+                StagCCMultiAxpy(tmp_u, tmp_p, 0, hy, V_u, V_p, i_copy+2);
+                StagCCAxpby(hy_norm_inv, tmp_u, tmp_p, 0, 0., C_u, C_p, recycle_slot);
+
+                recycle_slot = (recycle_slot+1) % gmres_recycle_dim;
+                nrecycle = amrex::min(nrecycle+1, gmres_recycle_dim);
+            }
+
+        } else {
+            // then, x = x + dot(V(1:i),y(1:i))
+            UpdateSol(x_u,x_p,V_u,V_p,y,i_copy);
+        }
 
     } while (true); // end of outer loop (do iter=1,gmres_max_outer)
 
@@ -434,12 +689,21 @@ void GMRES::Solve (std::array<MultiFab, AMREX_SPACEDIM> & b_u, const MultiFab &
 
         for (int d=0; d<AMREX_SPACEDIM; ++d)
             b_u[d].mult(1./scale_factor,0,1,b_u[d].nGrow());
+    }
 
-        // unscale the viscosities
-        beta.mult(1./scale_factor, 0, 1, beta.nGrow());
-        gamma.mult(1./scale_factor, 0, 1, gamma.nGrow());
-        for (int d=0; d<NUM_EDGE; ++d)
-            beta_ed[d].mult(1./scale_factor, 0, 1, beta_ed[d].nGrow());
+    // save the solution as the initial guess for the next call
+    if (gmres_warm_start == 1) {
+        if (have_prev == 0) {
+            for (int d=0; d<AMREX_SPACEDIM; ++d) {
+                x_u_prev[d].define(x_u[d].boxArray(), x_u[d].DistributionMap(), 1, 0);
+            }
+            x_p_prev.define(x_p.boxArray(), x_p.DistributionMap(), 1, 0);
+            have_prev = 1;
+        }
+        for (int d=0; d<AMREX_SPACEDIM; ++d) {
+            MultiFab::Copy(x_u_prev[d], x_u[d], 0, 0, 1, 0);
+        }
+        MultiFab::Copy(x_p_prev, x_p, 0, 0, 1, 0);
     }
 
     if (gmres_verbose >= 1) {
@@ -458,16 +722,8 @@ void UpdateSol(std::array<MultiFab, AMREX_SPACEDIM>& x_u,
                Vector<Real>& y,
                int i)
 {
-    // set V(i) = V(i)*y(i)
-    // set x = x + V(i)
-    for (int iter=0; iter<=i; ++iter) {
-        V_p.mult(y[iter],iter,1,0);
-        MultiFab::Add(x_p,V_p,iter,0,1,0);
-        for (int d=0; d<AMREX_SPACEDIM; ++d) {
-            V_u[d].mult(y[iter],iter,1,0);
-            MultiFab::Add(x_u[d],V_u[d],iter,0,1,0);
-        }
-    }
+    // x = x + sum_{iter=0}^{i} y(iter)*V(iter)
+    StagCCMultiAxpy(x_u,x_p,0,y,V_u,V_p,i+1);
 }
 
 void LeastSquares(int i,
@@ -44,7 +44,10 @@ void MacProj::Solve(const std::array<MultiFab, AMREX_SPACEDIM>& alphainv_fc,
     mlabec.setLevelBC(lev, &phi);
 
     // coefficients for solver (alpha already set to zero via setScalars)
-    mlabec.setBCoeffs(lev,amrex::GetArrOfConstPtrs(alphainv_fc));
+    if (cache_coefs == 0 || coefs_valid == 0) {
+        mlabec.setBCoeffs(lev,amrex::GetArrOfConstPtrs(alphainv_fc));
+        coefs_valid = 1;
+    }
 
     MLMG mlmg(mlabec);
 
@@ -95,43 +95,45 @@ void Precon::Apply(const std::array<MultiFab, AMREX_SPACEDIM> & b_u,
             // if precon_type = +1, or theta_alpha=0 then x_p = theta_alpha*Phi - c*beta*(mac_rhs)
             // if precon_type = -1                   then x_p = theta_alpha*Phi - c*beta*L_alpha Phi
 
-            if (precon_type == 1 || theta_alpha == 0) {
-                // first set x_p = -mac_rhs
-                MultiFab::Copy(x_p,mac_rhs,0,0,1,0);
-                x_p.mult(-1.,0,1,0);
-            }
-            else {
-                // first set x_p = -L_alpha Phi
+            // s = -mac_rhs (precon_type = +1 or theta_alpha=0) or s = -L_alpha Phi
+            const MultiFab* s_mf = &mac_rhs;
+            Real s_sign = -1.;
+            if (precon_type != 1 && theta_alpha != 0) {
+                // x_p holds -L_alpha Phi until it is overwritten below
                 CCApplyNegLap(phi,x_p,alphainv_fc,geom);
+                s_mf = &x_p;
+                s_sign = 1.;
             }
 
-            if ( amrex::Math::abs(visc_type) == 1 || amrex::Math::abs(visc_type) == 2) {
-                // multiply x_p by beta; x_p = -beta L_alpha Phi
-                MultiFab::Multiply(x_p,beta,0,0,1,0);
-
-                if (amrex::Math::abs(visc_type) == 2) {
-                    // multiply by c=2; x_p = -2*beta L_alpha Phi
-                    x_p.mult(2.,0,1,0);
-                }
+            // visc_type = 1: x_p = theta_alpha*Phi + beta*s
+            // visc_type = 2: x_p = theta_alpha*Phi + 2*beta*s
+            // visc_type = 3: x_p = theta_alpha*Phi + (4/3 beta + gamma)*s
+            // otherwise      x_p = theta_alpha*Phi + s
+            const int vtype = amrex::Math::abs(visc_type);
+
+            for (MFIter mfi(x_p,TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+
+                const Box& bx = mfi.tilebox();
+
+                const Array4<Real>       & xp   = x_p.array(mfi);
+                const Array4<const Real> & s    = s_mf->const_array(mfi);
+                const Array4<const Real> & ph   = phi.const_array(mfi);
+                const Array4<const Real> & bfab = beta.const_array(mfi);
+                const Array4<const Real> & gfab = gamma.const_array(mfi);
+
+                amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+                {
+                    Real coef = 1.;
+                    if (vtype == 1) {
+                        coef = bfab(i,j,k);
+                    } else if (vtype == 2) {
+                        coef = 2.*bfab(i,j,k);
+                    } else if (vtype == 3) {
+                        coef = (4./3.)*bfab(i,j,k) + gfab(i,j,k);
+                    }
+                    xp(i,j,k) = theta_alpha*ph(i,j,k) + coef*s_sign*s(i,j,k);
+                });
             }
-            else if (amrex::Math::abs(visc_type) == 3) {
-
-                // multiply x_p by gamma, use mac_rhs a temparary to save x_p
-                MultiFab::Copy(mac_rhs,x_p,0,0,1,0);
-                MultiFab::Multiply(mac_rhs,gamma,0,0,1,0);
-                // multiply x_p by beta; x_p = -beta L_alpha Phi
-                MultiFab::Multiply(x_p,beta,0,0,1,0);
-                // multiply by c=4/3; x_p = -(4/3) beta L_alpha Phi
-                x_p.mult(4./3.,0,1,0);
-                // x_p = -(4/3) beta L_alpha Phi - gamma L_alpha Phi
-                MultiFab::Add(x_p,mac_rhs,0,0,1,0);
-            }
-
-            // multiply Phi by theta_alpha
-            phi.mult(theta_alpha,0,1,0);
-
-            // add theta_alpha*Phi to x_p
-            MultiFab::Add(x_p,phi,0,0,1,0);
         }
         else {
             Abort("StagApplyOp: visc_schur_approx != 0 not supported");
@@ -3,23 +3,29 @@
 
 // compute (alpha - L_beta) phi
 
+// the kernels and StagApplyOp are templated on the data type so that the same
+// code applies the operator to the single-precision StagMGSolver hierarchy
+
 // we must retain custom lambda's because the boxes sometimes loop with stride 2
+// the red/black color of a face comes from its global index, so ghost faces
+// (possibly at negative indices) get the same color as the valid faces they copy
 
+template <typename T>
 AMREX_GPU_HOST_DEVICE
 inline
 void stag_applyop_visc_p1 (Box const& tbx,
 			   AMREX_D_DECL(Box const& xbx,
 					Box const& ybx,
 					Box const& zbx),
-                           AMREX_D_DECL(Array4<Real const> const& alphax,
-					Array4<Real const> const& alphay,
-					Array4<Real const> const& alphaz),
-                           AMREX_D_DECL(Array4<Real const> const& phix,
-					Array4<Real const> const& phiy,
-					Array4<Real const> const& phiz),
-                           AMREX_D_DECL(Array4<Real> const& Lphix,
-					Array4<Real> const& Lphiy,
-					Array4<Real> const& Lphiz),
+                           AMREX_D_DECL(Array4<T const> const& alphax,
+					Array4<T const> const& alphay,
+					Array4<T const> const& alphaz),
+                           AMREX_D_DECL(Array4<T const> const& phix,
+					Array4<T const> const& phiy,
+					Array4<T const> const& phiz),
+                           AMREX_D_DECL(Array4<T> const& Lphix,
+					Array4<T> const& Lphiy,
+					Array4<T> const& Lphiz),
 			   AMREX_D_DECL(bool do_x,
 					bool do_y,
 					bool do_z),
@@ -79,7 +85,7 @@ void stag_applyop_visc_p1 (Box const& tbx,
         for (int k = xlo.z; k <= xhi.z; ++k) {
         for (int j = xlo.y; j <= xhi.y; ++j) {
         ioff = 0;
-	if (offset == 2 && (xlo.x+j+k)%2 != (color+1)%2 ) {
+	if (offset == 2 && amrex::Math::abs(xlo.x+j+k)%2 != (color+1)%2 ) {
 	  ioff = 1;
 	}
         AMREX_PRAGMA_SIMD
@@ -102,7 +108,7 @@ void stag_applyop_visc_p1 (Box const& tbx,
         for (int k = ylo.z; k <= yhi.z; ++k) {
         for (int j = ylo.y; j <= yhi.y; ++j) {
         ioff = 0;
-        if (offset == 2 && (ylo.x+j+k)%2 != (color+1)%2 ) {
+        if (offset == 2 && amrex::Math::abs(ylo.x+j+k)%2 != (color+1)%2 ) {
 	  ioff = 1;
 	}
         AMREX_PRAGMA_SIMD
@@ -126,7 +132,7 @@ void stag_applyop_visc_p1 (Box const& tbx,
         for (int k = zlo.z; k <= zhi.z; ++k) {
         for (int j = zlo.y; j <= zhi.y; ++j) {
         ioff = 0;
-        if (offset == 2 && (zlo.x+j+k)%2 != (color+1)%2 ) {
+        if (offset == 2 && amrex::Math::abs(zlo.x+j+k)%2 != (color+1)%2 ) {
 	  ioff = 1;
 	}
         AMREX_PRAGMA_SIMD
@@ -144,26 +150,27 @@ void stag_applyop_visc_p1 (Box const& tbx,
 
 }
 
+template <typename T>
 AMREX_GPU_HOST_DEVICE
 inline
 void stag_applyop_visc_m1 (Box const& tbx,
 			   AMREX_D_DECL(Box const& xbx,
 					Box const& ybx,
 					Box const& zbx),
-                           AMREX_D_DECL(Array4<Real const> const& alphax,
-					Array4<Real const> const& alphay,
-					Array4<Real const> const& alphaz),
-                           AMREX_D_DECL(Array4<Real const> const& phix,
-					Array4<Real const> const& phiy,
-					Array4<Real const> const& phiz),
-                           AMREX_D_DECL(Array4<Real> const& Lphix,
-					Array4<Real> const& Lphiy,
-					Array4<Real> const& Lphiz),
-                           Array4<Real const> const& betacc,
-                           Array4<Real const> const& betaxy,
+                           AMREX_D_DECL(Array4<T const> const& alphax,
+					Array4<T const> const& alphay,
+					Array4<T const> const& alphaz),
+                           AMREX_D_DECL(Array4<T const> const& phix,
+					Array4<T const> const& phiy,
+					Array4<T const> const& phiz),
+                           AMREX_D_DECL(Array4<T> const& Lphix,
+					Array4<T> const& Lphiy,
+					Array4<T> const& Lphiz),
+                           Array4<T const> const& betacc,
+                           Array4<T const> const& betaxy,
 #if (AMREX_SPACEDIM == 3)
-                           Array4<Real const> const& betaxz,
-                           Array4<Real const> const& betayz,
+                           Array4<T const> const& betaxz,
+                           Array4<T const> const& betayz,
 #endif
 			   AMREX_D_DECL(bool do_x,
 					bool do_y,
@@ -211,7 +218,7 @@ void stag_applyop_visc_m1 (Box const& tbx,
         for (int k = xlo.z; k <= xhi.z; ++k) {
         for (int j = xlo.y; j <= xhi.y; ++j) {
         ioff = 0;
-	if (offset == 2 && (xlo.x+j+k)%2 != (color+1)%2 ) {
+	if (offset == 2 && amrex::Math::abs(xlo.x+j+k)%2 != (color+1)%2 ) {
 	  ioff = 1;
 	}
         AMREX_PRAGMA_SIMD
@@ -240,7 +247,7 @@ void stag_applyop_visc_m1 (Box const& tbx,
         for (int k = ylo.z; k <= yhi.z; ++k) {
         for (int j = ylo.y; j <= yhi.y; ++j) {
         ioff = 0;
-        if (offset == 2 && (ylo.x+j+k)%2 != (color+1)%2 ) {
+        if (offset == 2 && amrex::Math::abs(ylo.x+j+k)%2 != (color+1)%2 ) {
 	  ioff = 1;
 	}
         AMREX_PRAGMA_SIMD
@@ -270,7 +277,7 @@ void stag_applyop_visc_m1 (Box const& tbx,
         for (int k = zlo.z; k <= zhi.z; ++k) {
         for (int j = zlo.y; j <= zhi.y; ++j) {
         ioff = 0;
-        if (offset == 2 && (zlo.x+j+k)%2 != (color+1)%2 ) {
+        if (offset == 2 && amrex::Math::abs(zlo.x+j+k)%2 != (color+1)%2 ) {
 	  ioff = 1;
 	}
         AMREX_PRAGMA_SIMD
@@ -291,21 +298,22 @@ void stag_applyop_visc_m1 (Box const& tbx,
     
 }
 
+template <typename T>
 AMREX_GPU_HOST_DEVICE
 inline
 void stag_applyop_visc_p2 (Box const& tbx,
 			   AMREX_D_DECL(Box const& xbx,
 					Box const& ybx,
 					Box const& zbx),
-                           AMREX_D_DECL(Array4<Real const> const& alphax,
-					Array4<Real const> const& alphay,
-					Array4<Real const> const& alphaz),
-                           AMREX_D_DECL(Array4<Real const> const& phix,
-					Array4<Real const> const& phiy,
-					Array4<Real const> const& phiz),
-                           AMREX_D_DECL(Array4<Real> const& Lphix,
-					Array4<Real> const& Lphiy,
-					Array4<Real> const& Lphiz),
+                           AMREX_D_DECL(Array4<T const> const& alphax,
+					Array4<T const> const& alphay,
+					Array4<T const> const& alphaz),
+                           AMREX_D_DECL(Array4<T const> const& phix,
+					Array4<T const> const& phiy,
+					Array4<T const> const& phiz),
+                           AMREX_D_DECL(Array4<T> const& Lphix,
+					Array4<T> const& Lphiy,
+					Array4<T> const& Lphiz),
 			   AMREX_D_DECL(bool do_x,
 					bool do_y,
 					bool do_z),
@@ -361,7 +369,7 @@ void stag_applyop_visc_p2 (Box const& tbx,
         for (int k = xlo.z; k <= xhi.z; ++k) {
         for (int j = xlo.y; j <= xhi.y; ++j) {
         ioff = 0;
-	if (offset == 2 && (xlo.x+j+k)%2 != (color+1)%2 ) {
+	if (offset == 2 && amrex::Math::abs(xlo.x+j+k)%2 != (color+1)%2 ) {
 	  ioff = 1;
 	}
         AMREX_PRAGMA_SIMD
@@ -391,7 +399,7 @@ void stag_applyop_visc_p2 (Box const& tbx,
         for (int k = ylo.z; k <= yhi.z; ++k) {
         for (int j = ylo.y; j <= yhi.y; ++j) {
         ioff = 0;
-        if (offset == 2 && (ylo.x+j+k)%2 != (color+1)%2 ) {
+        if (offset == 2 && amrex::Math::abs(ylo.x+j+k)%2 != (color+1)%2 ) {
 	  ioff = 1;
 	}
         AMREX_PRAGMA_SIMD
@@ -418,7 +426,7 @@ void stag_applyop_visc_p2 (Box const& tbx,
         for (int k = zlo.z; k <= zhi.z; ++k) {
         for (int j = zlo.y; j <= zhi.y; ++j) {
         ioff = 0;
-        if (offset == 2 && (zlo.x+j+k)%2 != (color+1)%2 ) {
+        if (offset == 2 && amrex::Math::abs(zlo.x+j+k)%2 != (color+1)%2 ) {
 	  ioff = 1;
 	}
         AMREX_PRAGMA_SIMD
@@ -437,26 +445,27 @@ void stag_applyop_visc_p2 (Box const& tbx,
 
 }
 
+template <typename T>
 AMREX_GPU_HOST_DEVICE
 inline
 void stag_applyop_visc_m2 (Box const& tbx,
 			   AMREX_D_DECL(Box const& xbx,
 					Box const& ybx,
 					Box const& zbx),
-                           AMREX_D_DECL(Array4<Real const> const& alphax,
-					Array4<Real const> const& alphay,
-					Array4<Real const> const& alphaz),
-                           AMREX_D_DECL(Array4<Real const> const& phix,
-					Array4<Real const> const& phiy,
-					Array4<Real const> const& phiz),
-                           AMREX_D_DECL(Array4<Real> const& Lphix,
-					Array4<Real> const& Lphiy,
-					Array4<Real> const& Lphiz),
-                           Array4<Real const> const& betacc,
-                           Array4<Real const> const& betaxy,
+                           AMREX_D_DECL(Array4<T const> const& alphax,
+					Array4<T const> const& alphay,
+					Array4<T const> const& alphaz),
+                           AMREX_D_DECL(Array4<T const> const& phix,
+					Array4<T const> const& phiy,
+					Array4<T const> const& phiz),
+                           AMREX_D_DECL(Array4<T> const& Lphix,
+					Array4<T> const& Lphiy,
+					Array4<T> const& Lphiz),
+                           Array4<T const> const& betacc,
+                           Array4<T const> const& betaxy,
 #if (AMREX_SPACEDIM == 3)
-                           Array4<Real const> const& betaxz,
-                           Array4<Real const> const& betayz,
+                           Array4<T const> const& betaxz,
+                           Array4<T const> const& betayz,
 #endif
 			   AMREX_D_DECL(bool do_x,
 					bool do_y,
@@ -507,7 +516,7 @@ void stag_applyop_visc_m2 (Box const& tbx,
         for (int k = xlo.z; k <= xhi.z; ++k) {
         for (int j = xlo.y; j <= xhi.y; ++j) {
         ioff = 0;
-	if (offset == 2 && (xlo.x+j+k)%2 != (color+1)%2 ) {
+	if (offset == 2 && amrex::Math::abs(xlo.x+j+k)%2 != (color+1)%2 ) {
 	  ioff = 1;
 	}
         AMREX_PRAGMA_SIMD
@@ -553,7 +562,7 @@ void stag_applyop_visc_m2 (Box const& tbx,
         for (int k = ylo.z; k <= yhi.z; ++k) {
         for (int j = ylo.y; j <= yhi.y; ++j) {
         ioff = 0;
-        if (offset == 2 && (ylo.x+j+k)%2 != (color+1)%2 ) {
+        if (offset == 2 && amrex::Math::abs(ylo.x+j+k)%2 != (color+1)%2 ) {
 	  ioff = 1;
 	}
         AMREX_PRAGMA_SIMD
@@ -600,7 +609,7 @@ void stag_applyop_visc_m2 (Box const& tbx,
         for (int k = zlo.z; k <= zhi.z; ++k) {
         for (int j = zlo.y; j <= zhi.y; ++j) {
         ioff = 0;
-        if (offset == 2 && (zlo.x+j+k)%2 != (color+1)%2 ) {
+        if (offset == 2 && amrex::Math::abs(zlo.x+j+k)%2 != (color+1)%2 ) {
 	  ioff = 1;
 	}
         AMREX_PRAGMA_SIMD
@@ -635,19 +644,23 @@ void stag_applyop_visc_m2 (Box const& tbx,
 #endif
 }
 
+template <class MF>
 void StagApplyOp(const Geometry & geom,
-                 const MultiFab& beta_cc,
-                 const MultiFab& gamma_cc,
-                 const std::array<MultiFab, NUM_EDGE>& beta_ed,
-                 const std::array<MultiFab, AMREX_SPACEDIM>& phi,
-                 std::array<MultiFab, AMREX_SPACEDIM>& Lphi,
-                 const std::array<MultiFab, AMREX_SPACEDIM>& alpha_fc,
+                 const MF& beta_cc,
+                 const MF& gamma_cc,
+                 const std::array<MF, NUM_EDGE>& beta_ed,
+                 const std::array<MF, AMREX_SPACEDIM>& phi,
+                 std::array<MF, AMREX_SPACEDIM>& Lphi,
+                 const std::array<MF, AMREX_SPACEDIM>& alpha_fc,
                  const Real* dx,
                  const amrex::Real& theta_alpha,
-                 const int& color)
+                 const int& color,
+                 const int& ngrow)
 {
 
     BL_PROFILE_VAR("StagApplyOp()",StagApplyOp);
+
+    typedef typename MF::value_type T;
     
     GpuArray<Real,AMREX_SPACEDIM> dx_gpu{AMREX_D_DECL(dx[0], dx[1], dx[2])};
     
@@ -685,35 +698,48 @@ void StagApplyOp(const Geometry & geom,
         Abort("StagApplyOp: Invalid Color");
     }
 
+    // faces of the problem domain; with ngrow > 0 ghost faces are included in
+    // periodic directions, but never the ghost faces outside a physical boundary
+    std::array<Box, AMREX_SPACEDIM> face_dom;
+    for (int d=0; d<AMREX_SPACEDIM; ++d) {
+        face_dom[d] = convert(geom.Domain(), nodal_flag_dir[d]);
+        for (int i=0; i<AMREX_SPACEDIM; ++i) {
+            if (geom.isPeriodic(i)) {
+                face_dom[d].grow(i,ngrow);
+            }
+        }
+    }
+
     // Loop over boxes (make sure mfi takes a cell-centered multifab as an argument)
     for (MFIter mfi(beta_cc,TilingIfNotGPU()); mfi.isValid(); ++mfi) {
 
         const Box & bx = mfi.tilebox();
 
-        Array4<Real const> const& beta_cc_fab = beta_cc.array(mfi);
-        Array4<Real const> const& gamma_cc_fab = gamma_cc.array(mfi);
+        Array4<T const> const& beta_cc_fab = beta_cc.array(mfi);
+        Array4<T const> const& gamma_cc_fab = gamma_cc.array(mfi);
 
-        Array4<Real const> const& beta_xy_fab = beta_ed[0].array(mfi);
+        Array4<T const> const& beta_xy_fab = beta_ed[0].array(mfi);
 #if (AMREX_SPACEDIM == 3)
-        Array4<Real const> const& beta_xz_fab = beta_ed[1].array(mfi);
-        Array4<Real const> const& beta_yz_fab = beta_ed[2].array(mfi);
+        Array4<T const> const& beta_xz_fab = beta_ed[1].array(mfi);
+        Array4<T const> const& beta_yz_fab = beta_ed[2].array(mfi);
 #endif
 
-        AMREX_D_TERM(Array4<Real const> const& phix_fab = phi[0].array(mfi);,
-                     Array4<Real const> const& phiy_fab = phi[1].array(mfi);,
-                     Array4<Real const> const& phiz_fab = phi[2].array(mfi););
+        AMREX_D_TERM(Array4<T const> const& phix_fab = phi[0].array(mfi);,
+                     Array4<T const> const& phiy_fab = phi[1].array(mfi);,
+                     Array4<T const> const& phiz_fab = phi[2].array(mfi););
 
-        AMREX_D_TERM(Array4<Real> const& Lphix_fab = Lphi[0].array(mfi);,
-                     Array4<Real> const& Lphiy_fab = Lphi[1].array(mfi);,
-                     Array4<Real> const& Lphiz_fab = Lphi[2].array(mfi););
+        AMREX_D_TERM(Array4<T> const& Lphix_fab = Lphi[0].array(mfi);,
+                     Array4<T> const& Lphiy_fab = Lphi[1].array(mfi);,
+                     Array4<T> const& Lphiz_fab = Lphi[2].array(mfi););
 
-        AMREX_D_TERM(Array4<Real const> const& alphax_fab = alpha_fc[0].array(mfi);,
-                     Array4<Real const> const& alphay_fab = alpha_fc[1].array(mfi);,
-                     Array4<Real const> const& alphaz_fab = alpha_fc[2].array(mfi););
+        AMREX_D_TERM(Array4<T const> const& alphax_fab = alpha_fc[0].array(mfi);,
+                     Array4<T const> const& alphay_fab = alpha_fc[1].array(mfi);,
+                     Array4<T const> const& alphaz_fab = alpha_fc[2].array(mfi););
 
-        AMREX_D_TERM(const Box& bx_x = mfi.nodaltilebox(0);,
-                     const Box& bx_y = mfi.nodaltilebox(1);,
-                     const Box& bx_z = mfi.nodaltilebox(2););
+        // face boxes, grown by ngrow ghost faces
+        AMREX_D_TERM(const Box& bx_x = mfi.grownnodaltilebox(0,ngrow) & face_dom[0];,
+                     const Box& bx_y = mfi.grownnodaltilebox(1,ngrow) & face_dom[1];,
+                     const Box& bx_z = mfi.grownnodaltilebox(2,ngrow) & face_dom[2];);
 
         const Box& index_bounds = amrex::getIndexBounds(AMREX_D_DECL(bx_x,bx_y,bx_z));
 
@@ -788,3 +814,18 @@ void StagApplyOp(const Geometry & geom,
     }
     
 }
+
+template void StagApplyOp<MultiFab>(const Geometry&, const MultiFab&, const MultiFab&,
+                                    const std::array<MultiFab, NUM_EDGE>&,
+                                    const std::array<MultiFab, AMREX_SPACEDIM>&,
+                                    std::array<MultiFab, AMREX_SPACEDIM>&,
+                                    const std::array<MultiFab, AMREX_SPACEDIM>&,
+                                    const Real*, const Real&, const int&, const int&);
+
+template void StagApplyOp<FabArray<BaseFab<float> > >(const Geometry&,
+                                    const FabArray<BaseFab<float> >&, const FabArray<BaseFab<float> >&,
+                                    const std::array<FabArray<BaseFab<float> >, NUM_EDGE>&,
+                                    const std::array<FabArray<BaseFab<float> >, AMREX_SPACEDIM>&,
+                                    std::array<FabArray<BaseFab<float> >, AMREX_SPACEDIM>&,
+                                    const std::array<FabArray<BaseFab<float> >, AMREX_SPACEDIM>&,
+                                    const Real*, const Real&, const int&, const int&);
@@ -0,0 +1,184 @@
+#include "gmres_functions.H"
+
+// Fused linear algebra on the (staggered velocity, cell-centered pressure) pair
+// used by the Stokes solvers.  Each routine makes a single pass over the data
+// instead of the Copy/mult/Add sequences it replaces.
+
+// y(ycomp) = a*x(xcomp) + b*y(ycomp) for one component of a MultiFab
+// if b = 0, y is not read
+static void Axpby(const Real a, const MultiFab& x, const int xcomp,
+                  const Real b, MultiFab& y, const int ycomp)
+{
+    for (MFIter mfi(y,TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+
+        const Box& bx = mfi.tilebox();
+
+        const Array4<const Real> & xfab = x.const_array(mfi);
+        const Array4<Real>       & yfab = y.array(mfi);
+
+        if (b == 0.) {
+            amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+            {
+                yfab(i,j,k,ycomp) = a*xfab(i,j,k,xcomp);
+            });
+        } else {
+            amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+            {
+                yfab(i,j,k,ycomp) = a*xfab(i,j,k,xcomp) + b*yfab(i,j,k,ycomp);
+            });
+        }
+    }
+}
+
+// y(ycomp) += sum_n coef[n]*V(vcomp+n), n=0..nvec-1, for one MultiFab
+static void MultiAxpy(MultiFab& y, const int ycomp, const Real* coef,
+                      const MultiFab& V, const int vcomp, const int nvec)
+{
+    for (MFIter mfi(y,TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+
+        const Box& bx = mfi.tilebox();
+
+        const Array4<Real>       & yfab = y.array(mfi);
+        const Array4<const Real> & Vfab = V.const_array(mfi);
+
+        amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+        {
+            Real sum = 0.;
+            for (int n=0; n<nvec; ++n) {
+                sum += coef[n]*Vfab(i,j,k,vcomp+n);
+            }
+            yfab(i,j,k,ycomp) += sum;
+        });
+    }
+}
+
+void CCAxpby(const Real& a, const MultiFab& x_p, const int& xcomp,
+             const Real& b, MultiFab& y_p, const int& ycomp)
+{
+    BL_PROFILE_VAR("CCAxpby()",CCAxpby);
+
+    Axpby(a,x_p,xcomp,b,y_p,ycomp);
+}
+
+void StagCCAxpby(const Real& a,
+                 const std::array<MultiFab, AMREX_SPACEDIM>& x_u,
+                 const MultiFab& x_p,
+                 const int& xcomp,
+                 const Real& b,
+                 std::array<MultiFab, AMREX_SPACEDIM>& y_u,
+                 MultiFab& y_p,
+                 const int& ycomp)
+{
+    BL_PROFILE_VAR("StagCCAxpby()",StagCCAxpby);
+
+    for (int d=0; d<AMREX_SPACEDIM; ++d) {
+        Axpby(a,x_u[d],xcomp,b,y_u[d],ycomp);
+    }
+    Axpby(a,x_p,xcomp,b,y_p,ycomp);
+}
+
+void StagCCMultiAxpy(std::array<MultiFab, AMREX_SPACEDIM>& y_u,
+                     MultiFab& y_p,
+                     const int& ycomp,
+                     const Vector<Real>& coef,
+                     const std::array<MultiFab, AMREX_SPACEDIM>& V_u,
+                     const MultiFab& V_p,
+                     const int& nvec)
+{
+    BL_PROFILE_VAR("StagCCMultiAxpy()",StagCCMultiAxpy);
+
+    if (nvec <= 0) return;
+
+    Gpu::DeviceVector<Real> coef_vect(nvec);
+    Gpu::copy(Gpu::hostToDevice, coef.begin(), coef.begin()+nvec, coef_vect.begin());
+    const Real* coef_gpu = coef_vect.dataPtr();
+
+    for (int d=0; d<AMREX_SPACEDIM; ++d) {
+        MultiAxpy(y_u[d],ycomp,coef_gpu,V_u[d],0,nvec);
+    }
+    MultiAxpy(y_p,ycomp,coef_gpu,V_p,0,nvec);
+
+    // coef_vect must outlive the kernels
+    Gpu::synchronize();
+}
+
+// y = a*x + b*y, returning the staggered (SumStag-weighted) and cell-centered
+// L2 norms of the updated y, computed in the same pass and combined in a
+// single global reduction
+void StagCCAxpbyNorm(const Real& a,
+                     const std::array<MultiFab, AMREX_SPACEDIM>& x_u,
+                     const MultiFab& x_p,
+                     const Real& b,
+                     std::array<MultiFab, AMREX_SPACEDIM>& y_u,
+                     MultiFab& y_p,
+                     Real& norm_u,
+                     Real& norm_p)
+{
+    BL_PROFILE_VAR("StagCCAxpbyNorm()",StagCCAxpbyNorm);
+
+    ReduceOps<ReduceOpSum> reduce_op;
+
+    Real sum[2] = {0., 0.};
+
+    for (int d=0; d<AMREX_SPACEDIM; ++d) {
+
+        ReduceData<Real> reduce_data(reduce_op);
+        using ReduceTuple = typename decltype(reduce_data)::Type;
+
+        for (MFIter mfi(y_u[d],TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+
+            const Box& bx = mfi.tilebox();
+            const Box& bx_grid = mfi.validbox();
+
+            const Array4<const Real> & xfab = x_u[d].const_array(mfi);
+            const Array4<Real>       & yfab = y_u[d].array(mfi);
+
+            const int dir = d;
+            const int lo = bx_grid.smallEnd(d);
+            const int hi = bx_grid.bigEnd(d);
+
+            reduce_op.eval(bx, reduce_data,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
+            {
+                Real y = a*xfab(i,j,k);
+                if (b != 0.) y += b*yfab(i,j,k);
+                yfab(i,j,k) = y;
+
+                const int idx = (dir == 0) ? i : ((dir == 1) ? j : k);
+                Real weight = (idx>lo && idx<hi) ? 1.0 : 0.5;
+                return {y*y*weight};
+            });
+        }
+
+        sum[0] += amrex::get<0>(reduce_data.value());
+    }
+
+    {
+        ReduceData<Real> reduce_data(reduce_op);
+        using ReduceTuple = typename decltype(reduce_data)::Type;
+
+        for (MFIter mfi(y_p,TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+
+            const Box& bx = mfi.tilebox();
+
+            const Array4<const Real> & xfab = x_p.const_array(mfi);
+            const Array4<Real>       & yfab = y_p.array(mfi);
+
+            reduce_op.eval(bx, reduce_data,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
+            {
+                Real y = a*xfab(i,j,k);
+                if (b != 0.) y += b*yfab(i,j,k);
+                yfab(i,j,k) = y;
+                return {y*y};
+            });
+        }
+
+        sum[1] = amrex::get<0>(reduce_data.value());
+    }
+
+    ParallelDescriptor::ReduceRealSum(sum,2);
+
+    norm_u = sqrt(sum[0]);
+    norm_p = sqrt(sum[1]);
+}
@@ -5,9 +5,152 @@ using namespace amrex;
 
 StagMGSolver::StagMGSolver() {}
 
+// dst = scale*src on the valid region grown by ngrow; dst and src may differ
+// in precision (MultiFab <-> StagMGFab)
+template <class DST, class SRC>
+static void MGCopy(DST& dst, const SRC& src, int ngrow, Real scale=1.)
+{
+    typedef typename DST::value_type T;
+
+    for (MFIter mfi(dst,TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+
+        const Box& bx = mfi.growntilebox(ngrow);
+
+        const auto& dst_fab = dst.array(mfi);
+        const auto& src_fab = src.array(mfi);
+
+        amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+        {
+            dst_fab(i,j,k) = static_cast<T>(scale*src_fab(i,j,k));
+        });
+    }
+}
+
+// a = sign*(a - b) on the valid region grown by ngrow
+static void MGSubtract(StagMGFab& a, const StagMGFab& b, int ngrow, Real sign=1.)
+{
+    for (MFIter mfi(a,TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+
+        const Box& bx = mfi.growntilebox(ngrow);
+
+        const Array4<StagMGReal      >& a_fab = a.array(mfi);
+        const Array4<StagMGReal const>& b_fab = b.array(mfi);
+
+        amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+        {
+            a_fab(i,j,k) = sign*(a_fab(i,j,k) - b_fab(i,j,k));
+        });
+    }
+}
+
+// max norm over the valid region, returned in double precision
+static Real MGNorm0(const StagMGFab& a)
+{
+    ReduceOps<ReduceOpMax> reduce_op;
+    ReduceData<Real> reduce_data(reduce_op);
+    using ReduceTuple = typename decltype(reduce_data)::Type;
+
+    for (MFIter mfi(a,TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+
+        const Box& bx = mfi.tilebox();
+
+        const Array4<StagMGReal const>& a_fab = a.array(mfi);
+
+        reduce_op.eval(bx, reduce_data,
+        [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
+        {
+            return {amrex::Math::abs(static_cast<Real>(a_fab(i,j,k)))};
+        });
+    }
+
+    Real norm = amrex::get<0>(reduce_data.value());
+    ParallelDescriptor::ReduceRealMax(norm);
+    return norm;
+}
+
+// y = b*y + a*x on the valid region
+static void MGAxpy(StagMGFab& y, Real a, const StagMGFab& x, Real b=1.)
+{
+    for (MFIter mfi(y,TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+
+        const Box& bx = mfi.tilebox();
+
+        const Array4<StagMGReal      >& y_fab = y.array(mfi);
+        const Array4<StagMGReal const>& x_fab = x.array(mfi);
+
+        amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+        {
+            y_fab(i,j,k) = b*y_fab(i,j,k) + a*x_fab(i,j,k);
+        });
+    }
+}
+
+// fill the interior and periodic ghost faces of a face-centered field, posting
+// every component's exchange before waiting on any of them
+static void MGFillBoundary(std::array<StagMGFab, AMREX_SPACEDIM>& a, const Geometry& geom)
+{
+    for (int d=0; d<AMREX_SPACEDIM; ++d) {
+        a[d].FillBoundary_nowait(geom.periodicity());
+    }
+    for (int d=0; d<AMREX_SPACEDIM; ++d) {
+        a[d].FillBoundary_finish();
+    }
+}
+
+// staggered inner product with the SumStag weighting (faces on grid boundaries
+// count 1/2), accumulated in double precision; if owner >= 0 all the data lives
+// on that rank, so its sum is broadcast instead of reduced over all ranks
+static Real MGStagDot(const std::array<StagMGFab, AMREX_SPACEDIM>& a,
+                      const std::array<StagMGFab, AMREX_SPACEDIM>& b,
+                      int owner)
+{
+    Real sum = 0.;
+
+    ReduceOps<ReduceOpSum> reduce_op;
+
+    for (int d=0; d<AMREX_SPACEDIM; ++d) {
+
+        ReduceData<Real> reduce_data(reduce_op);
+        using ReduceTuple = typename decltype(reduce_data)::Type;
+
+        for (MFIter mfi(a[d],TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+
+            const Box& bx = mfi.tilebox();
+            const Box& bx_grid = mfi.validbox();
+
+            const Array4<StagMGReal const>& a_fab = a[d].array(mfi);
+            const Array4<StagMGReal const>& b_fab = b[d].array(mfi);
+
+            const int dir = d;
+            const int lo = bx_grid.smallEnd(d);
+            const int hi = bx_grid.bigEnd(d);
+
+            reduce_op.eval(bx, reduce_data,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
+            {
+                const int idx = (dir == 0) ? i : ((dir == 1) ? j : k);
+                Real weight = (idx>lo && idx<hi) ? 1.0 : 0.5;
+                return {static_cast<Real>(a_fab(i,j,k))*static_cast<Real>(b_fab(i,j,k))*weight};
+            });
+        }
+
+        sum += amrex::get<0>(reduce_data.value());
+    }
+
+    if (owner >= 0) {
+        ParallelDescriptor::Bcast(&sum, 1, owner);
+    }
+    else {
+        ParallelDescriptor::ReduceRealSum(sum);
+    }
+
+    return sum;
+}
+
 void StagMGSolver::Define(const BoxArray& ba_in,
                           const DistributionMapping& dmap_in,
-                          const Geometry& geom_in) {
+                          const Geometry& geom_in,
+                          const int& is_bottom_in) {
 
     BL_PROFILE_VAR("StagMGSolver::Define()",StagMGSolver_Define);
     
@@ -16,10 +159,15 @@ void StagMGSolver::Define(const BoxArray& ba_in,
     ba_base = ba_in;
     
     dmap = dmap_in;    
+
+    is_bottom = is_bottom_in;
     
     // compute the number of multigrid levels assuming stag_mg_minwidth is the length of the
     // smallest dimension of the smallest grid at the coarsest multigrid level
     nlevs_mg = ComputeNlevsMG(ba_base);
+    if (is_bottom == 1) {
+        nlevs_mg = amrex::min(nlevs_mg, stag_mg_max_bottom_nlevels+1);
+    }
     if (stag_mg_verbosity >= 3) {
         Print() << "Total number of multigrid levels: " << nlevs_mg << std::endl;
     }
@@ -48,6 +196,13 @@ void StagMGSolver::Define(const BoxArray& ba_in,
         is_periodic[i] = geom_in.isPeriodic(i);
     }
     
+    // the smoother recomputes up to ng_phi-1 ghost faces of phi between halo
+    // exchanges, which needs rhs, alpha, Lphi, and beta_ed on those faces
+    // and beta_cc and gamma_cc one cell further out
+    const int ng_phi = amrex::max(stag_mg_nghost,1);
+    const int ng_fc = amrex::max(ng_phi-1,1);
+    const int ng_coef = ng_phi-1;
+
     for (int n=0; n<nlevs_mg; ++n) {
         for (int d=0; d<AMREX_SPACEDIM; ++d) {
             // compute dx at this level of multigrid
@@ -69,14 +224,14 @@ void StagMGSolver::Define(const BoxArray& ba_in,
         }
 
         // build multifabs used in multigrid coarsening
-         beta_cc_mg[n].define(ba, dmap, 1, 1);
-        gamma_cc_mg[n].define(ba, dmap, 1, 1);
+         beta_cc_mg[n].define(ba, dmap, 1, ng_phi);
+        gamma_cc_mg[n].define(ba, dmap, 1, ng_phi);
 
         for (int d=0; d<AMREX_SPACEDIM; d++) {
-            alpha_fc_mg[n][d].define(convert(ba, nodal_flag_dir[d]), dmap, 1, 0);
-              rhs_fc_mg[n][d].define(convert(ba, nodal_flag_dir[d]), dmap, 1, 1);
-              phi_fc_mg[n][d].define(convert(ba, nodal_flag_dir[d]), dmap, 1, 1);
-             Lphi_fc_mg[n][d].define(convert(ba, nodal_flag_dir[d]), dmap, 1, 1);
+            alpha_fc_mg[n][d].define(convert(ba, nodal_flag_dir[d]), dmap, 1, ng_coef);
+              rhs_fc_mg[n][d].define(convert(ba, nodal_flag_dir[d]), dmap, 1, ng_fc);
+              phi_fc_mg[n][d].define(convert(ba, nodal_flag_dir[d]), dmap, 1, ng_phi);
+             Lphi_fc_mg[n][d].define(convert(ba, nodal_flag_dir[d]), dmap, 1, ng_fc);
             resid_fc_mg[n][d].define(convert(ba, nodal_flag_dir[d]), dmap, 1, 0);
 
             // Put in to fix FPE traps
@@ -87,14 +242,53 @@ void StagMGSolver::Define(const BoxArray& ba_in,
 
         // build beta_ed_mg
         if (AMREX_SPACEDIM == 2) {
-            beta_ed_mg[n][0].define(convert(ba, nodal_flag), dmap, 1, 0);
+            beta_ed_mg[n][0].define(convert(ba, nodal_flag), dmap, 1, ng_coef);
         }
         else if (AMREX_SPACEDIM == 3) {
             for (int d=0; d<AMREX_SPACEDIM; d++)
-                beta_ed_mg[n][d].define(convert(ba, nodal_flag_edge[d]), dmap, 1, 0);
+                beta_ed_mg[n][d].define(convert(ba, nodal_flag_edge[d]), dmap, 1, ng_coef);
+        }
+
+        // with ng_phi > 1, faces on physical boundaries in the ghost region read
+        // coefficient ghosts that no copy or exchange fills (the faces themselves
+        // are then reset by the boundary conditions), so start them at zero
+         beta_cc_mg[n].setVal(0);
+        gamma_cc_mg[n].setVal(0);
+        for (int d=0; d<AMREX_SPACEDIM; d++) {
+            alpha_fc_mg[n][d].setVal(0);
+        }
+        for (int d=0; d<NUM_EDGE; d++) {
+            beta_ed_mg[n][d].setVal(0);
+        }
+
+        // search direction for the conjugate gradient bottom solver
+        if (n == nlevs_mg-1 && (stag_mg_bottom_solver == 1 || is_bottom == 1)) {
+            for (int d=0; d<AMREX_SPACEDIM; d++) {
+                cg_p_fc[d].define(convert(ba, nodal_flag_dir[d]), dmap, 1, 1);
+                cg_p_fc[d].setVal(0);
+            }
         }
     } // end loop over multigrid levels
-    
+
+    // stag_mg_bottom_solver = 4: agglomerate the coarsest level onto a single grid
+    // covering the whole domain, owned by the I/O rank, and keep coarsening there
+    // (up to stag_mg_max_bottom_nlevels more levels) so the V-cycle reaches a
+    // coarse global grid regardless of the domain decomposition
+    if (stag_mg_bottom_solver == 4 && is_bottom == 0) {
+
+        BoxArray ba_bottom(geom_mg[nlevs_mg-1].Domain());
+
+        Vector<int> pmap(1, ParallelDescriptor::IOProcessorNumber());
+        DistributionMapping dmap_bottom(pmap);
+
+        bottom_solver.reset(new StagMGSolver());
+        bottom_solver->Define(ba_bottom, dmap_bottom, geom_mg[nlevs_mg-1], 1);
+
+        if (stag_mg_verbosity >= 3) {
+            Print() << "Number of agglomerated bottom multigrid levels: "
+                    << bottom_solver->nlevs_mg << std::endl;
+        }
+    }
 }
 
 
@@ -127,56 +321,30 @@ void StagMGSolver::Solve(const std::array<MultiFab, AMREX_SPACEDIM> & alpha_fc,
     Vector<Real> resid0_l2(AMREX_SPACEDIM);
     Vector<Real> resid(AMREX_SPACEDIM);
     Vector<Real> resid_l2(AMREX_SPACEDIM);
-    Real resid_temp;
 
-    int n, color_start, color_end;
-
-    // copy level 1 coefficients into mg array of coefficients
-    MultiFab::Copy(beta_cc_mg[0],  beta_cc,  0, 0, 1, 1);
-    MultiFab::Copy(gamma_cc_mg[0], gamma_cc, 0, 0, 1, 1);
-
-    for (int d=0; d<AMREX_SPACEDIM; ++d) {
-        MultiFab::Copy(alpha_fc_mg[0][d], alpha_fc[d], 0, 0, 1, 0);
-        // multiply alpha_fc_mg by theta_alpha
-        alpha_fc_mg[0][d].mult(theta_alpha,0,1,0);
-    }
+    // the coefficient hierarchy only needs to be rebuilt if the caller changed it
+    if (cache_coefs == 0 || coefs_valid == 0 || theta_alpha != theta_alpha_valid) {
 
-    MultiFab::Copy(    beta_ed_mg[0][0], beta_ed[0], 0, 0, 1, 0);
-    if (AMREX_SPACEDIM == 3) {
-        MultiFab::Copy(beta_ed_mg[0][1], beta_ed[1], 0, 0, 1, 0);
-        MultiFab::Copy(beta_ed_mg[0][2], beta_ed[2], 0, 0, 1, 0);
-    }
+        // copy level 1 coefficients into mg array of coefficients
+        // (converting to StagMGReal if the hierarchy is single precision)
+        MGCopy(beta_cc_mg[0],  beta_cc,  1);
+        MGCopy(gamma_cc_mg[0], gamma_cc, 1);
 
-    // coarsen coefficients
-    for (n=1; n<nlevs_mg; ++n) {
-        // need ghost cells set to zero to prevent intermediate NaN states
-        // that cause some compilers to fail
-         beta_cc_mg[n].setVal(0.);
-        gamma_cc_mg[n].setVal(0.);
-
-        // cc_restriction on beta_cc_mg and gamma_cc_mg
-        // NOTE: CCRestriction calls FillBoundary
-
-        CCRestriction( beta_cc_mg[n],  beta_cc_mg[n-1], geom_mg[n]);
-        CCRestriction(gamma_cc_mg[n], gamma_cc_mg[n-1], geom_mg[n]);
-
-        // stag_restriction on alpha_fc_mg
-        StagRestriction(alpha_fc_mg[n], alpha_fc_mg[n-1], 1);
-
-        // NOTE: StagRestriction, NodalRestriction, and EdgeRestriction do not
-        // call FillBoundary => Do them here for now
+        for (int d=0; d<AMREX_SPACEDIM; ++d) {
+            // multiply alpha_fc_mg by theta_alpha
+            MGCopy(alpha_fc_mg[0][d], alpha_fc[d], 0, theta_alpha);
+        }
 
-        for (int d=0; d<AMREX_SPACEDIM; d++) {
-            alpha_fc_mg[n][d].FillBoundary(geom_mg[n].periodicity());
+        MGCopy(    beta_ed_mg[0][0], beta_ed[0], 0);
+        if (AMREX_SPACEDIM == 3) {
+            MGCopy(beta_ed_mg[0][1], beta_ed[1], 0);
+            MGCopy(beta_ed_mg[0][2], beta_ed[2], 0);
         }
 
-#if (AMREX_SPACEDIM == 2)
-        // nodal_restriction on beta_ed_mg
-        NodalRestriction(beta_ed_mg[n][0],beta_ed_mg[n-1][0]);
-#elif (AMREX_SPACEDIM == 3)
-        // edge_restriction on beta_ed_mg
-        EdgeRestriction(beta_ed_mg[n],beta_ed_mg[n-1]);
-#endif
+        CoarsenCoefficients();
+
+        coefs_valid = 1;
+        theta_alpha_valid = theta_alpha;
     }
 
     /*!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
@@ -186,7 +354,7 @@ void StagMGSolver::Solve(const std::array<MultiFab, AMREX_SPACEDIM> & alpha_fc,
     for (int d=0; d<AMREX_SPACEDIM; ++d) {
 
         // initialize phi_fc_mg = phi_fc as an initial guess
-        MultiFab::Copy(phi_fc_mg[0][d],phi_fc[d],0,0,1,0);
+        MGCopy(phi_fc_mg[0][d],phi_fc[d],0);
 
         // set values on physical boundaries
         MultiFabPhysBCDomainVel(phi_fc_mg[0][d], geom_mg[0],d);
@@ -198,7 +366,12 @@ void StagMGSolver::Solve(const std::array<MultiFab, AMREX_SPACEDIM> & alpha_fc,
         MultiFabPhysBCMacVel(phi_fc_mg[0][d], geom_mg[0], d);
 
         // set rhs_fc_mg at level 1 by copying in passed-in rhs_fc
-        MultiFab::Copy(rhs_fc_mg[0][d], rhs_fc[d], 0, 0, 1, 0);
+        MGCopy(rhs_fc_mg[0][d], rhs_fc[d], 0);
+    }
+
+    // the smoother also updates ghost faces if stag_mg_nghost > 1
+    if (stag_mg_nghost > 1) {
+        MGFillBoundary(rhs_fc_mg[0], geom_mg[0]);
     }
 
     // compute norm of initial residual
@@ -209,10 +382,10 @@ void StagMGSolver::Solve(const std::array<MultiFab, AMREX_SPACEDIM> & alpha_fc,
     // now subtract the rest of the RHS from Lphi.
     for (int d=0; d<AMREX_SPACEDIM; ++d) {
         // compute Lphi - rhs
-        MultiFab::Subtract(Lphi_fc_mg[0][d],rhs_fc_mg[0][d],0,0,1,1);
+        MGSubtract(Lphi_fc_mg[0][d],rhs_fc_mg[0][d],1);
 
         // compute L0 norm of Lphi - rhs
-        resid0[d] = Lphi_fc_mg[0][d].norm0();
+        resid0[d] = MGNorm0(Lphi_fc_mg[0][d]);
 // FIXME - need to write an L2 norm for staggered fields
 //        resid0_l2[d] = Lphi_fc_mg[0][d].norm2();
         if (stag_mg_verbosity >= 2) {
@@ -235,6 +408,201 @@ void StagMGSolver::Solve(const std::array<MultiFab, AMREX_SPACEDIM> & alpha_fc,
 //        std::fill(resid0_l2.begin(), resid0_l2.end(), *max_element(resid0_l2.begin(), resid0_l2.end()));
     }
 
+    for (int vcycle=1; vcycle<=stag_mg_max_vcycles; ++vcycle) {
+
+        if (stag_mg_verbosity >= 2) {
+            Print() << "Begin V-Cycle " << vcycle << std::endl;
+        }
+
+        VCycle();
+
+        if (stag_mg_verbosity >= 2) {
+            Print() << "End   V-Cycle " << vcycle << std::endl;
+        }
+
+        // compute norm of residual
+
+        // compute Lphi
+        StagApplyOp(geom_mg[0],beta_cc_mg[0],gamma_cc_mg[0],beta_ed_mg[0],
+                    phi_fc_mg[0],Lphi_fc_mg[0],alpha_fc_mg[0],dx_mg[0].data(),1.);
+
+        // compute Lphi - rhs
+        for (int d=0; d<AMREX_SPACEDIM; ++d) {
+            // compute Lphi - rhs
+            MGSubtract(Lphi_fc_mg[0][d],rhs_fc_mg[0][d],0);
+        }
+
+        // compute L0 norm of Lphi - rhs and determine if the problem is solved
+        for (int d=0; d<AMREX_SPACEDIM; ++d) {
+            resid[d] = MGNorm0(Lphi_fc_mg[0][d]);
+// FIXME - need to write an L2 norm for staggered fields
+//            resid_l2[d] = Lphi_fc_mg[0][d].norm2();
+            if (stag_mg_verbosity >= 2) {
+                Print() << "Residual     " << d << " " << resid[d] << std::endl;
+                Print() << "resid/resid0 " << d << " " << resid[d]/resid0[d] << std::endl;
+            }
+        }
+        if (stag_mg_verbosity >= 1) {
+// FIXME - need to write an L2 norm for staggered fields
+/*
+            Real sum1=0., sum2=0.;
+            for (int d=0; d<AMREX_SPACEDIM; ++d) {
+                sum1 += pow(resid_l2[d],2.0);
+                sum2 += pow(resid0_l2[d],2.0);
+            }
+            Print() << "StagMG: L2 |r|/|r0|: " << vcycle
+                    << sqrt(sum1)/sqrt(sum2);
+            for (int d=0; d<AMREX_SPACEDIM; ++d) {
+                Print() << " " << resid_l2[d]/resid0_l2[d];
+            }
+            Print() << std::endl;
+*/
+        }
+
+        for (int d=0; d<AMREX_SPACEDIM; ++d) {
+            resid[d] /= resid0[d];
+        }
+
+        if ( std::all_of(resid.begin(), resid.end(), [](Real x){return x <= stag_mg_rel_tol;}) ) {
+            if (stag_mg_verbosity >= 1) {
+                Print() << "Solved in " << vcycle << " staggered V-cycles" << std::endl;
+                for (int d=0; d<AMREX_SPACEDIM; ++d) {
+                    Print() << "resid/resid0 " << d << " " << resid[d] << std::endl;
+                }
+            }
+	    break;
+        }
+
+        if (vcycle == stag_mg_max_vcycles) {
+            if (stag_mg_verbosity >= 1) {
+                Print() << "Exiting staggered multigrid; maximum number of V-Cycles reached" << std::endl;
+                for (int d=0; d<AMREX_SPACEDIM; ++d) {
+                    Print() << "resid/resid0 " << d << " " << resid[d] << std::endl;
+                }
+            }
+        }
+
+    } // end loop over stag_mg_max_vcycles
+
+    //////////////////////////////////
+    // Done with multigrid
+    //////////////////////////////////
+
+    for (int d=0; d<AMREX_SPACEDIM; ++d) {
+
+        // copy solution back into phi_fc
+        MGCopy(phi_fc[d],phi_fc_mg[0][d],0);
+
+        // set values on physical boundaries
+        MultiFabPhysBCDomainVel(phi_fc[d], geom_mg[0],d);
+
+        // fill periodic ghost cells
+        phi_fc[d].FillBoundary(geom_mg[0].periodicity());
+
+        // fill physical ghost cells
+        MultiFabPhysBCMacVel(phi_fc[d], geom_mg[0],d);
+    }
+
+    // vcycle_counter += AMREX_SPACEDIM*stag_mg_max_vcycles;
+
+    if (stag_mg_verbosity >= 1) {
+        Print() << "End call to stag_mg_solver\n";
+    }
+}
+
+// coarsen the level 0 coefficients onto levels 1:nlevs_mg-1, and onto the
+// agglomerated bottom hierarchy if there is one
+void StagMGSolver::CoarsenCoefficients()
+{
+    BL_PROFILE_VAR("StagMGSolver::CoarsenCoefficients()",CoarsenCoefficients);
+
+    // the smoother reads the coefficients beyond the ghost cells that were
+    // copied in (see Define)
+    if (stag_mg_nghost > 1) {
+         beta_cc_mg[0].FillBoundary(geom_mg[0].periodicity());
+        gamma_cc_mg[0].FillBoundary(geom_mg[0].periodicity());
+        for (int d=0; d<AMREX_SPACEDIM; d++) {
+            alpha_fc_mg[0][d].FillBoundary(geom_mg[0].periodicity());
+        }
+        for (int d=0; d<NUM_EDGE; d++) {
+            beta_ed_mg[0][d].FillBoundary(geom_mg[0].periodicity());
+        }
+    }
+
+    for (int n=1; n<nlevs_mg; ++n) {
+        // need ghost cells set to zero to prevent intermediate NaN states
+        // that cause some compilers to fail
+         beta_cc_mg[n].setVal(0.);
+        gamma_cc_mg[n].setVal(0.);
+
+        // cc_restriction on beta_cc_mg and gamma_cc_mg
+        // NOTE: CCRestriction calls FillBoundary
+
+        CCRestriction( beta_cc_mg[n],  beta_cc_mg[n-1], geom_mg[n]);
+        CCRestriction(gamma_cc_mg[n], gamma_cc_mg[n-1], geom_mg[n]);
+
+        // stag_restriction on alpha_fc_mg
+        StagRestriction(alpha_fc_mg[n], alpha_fc_mg[n-1], 1);
+
+        // NOTE: StagRestriction, NodalRestriction, and EdgeRestriction do not
+        // call FillBoundary => Do them here for now
+
+        for (int d=0; d<AMREX_SPACEDIM; d++) {
+            alpha_fc_mg[n][d].FillBoundary(geom_mg[n].periodicity());
+        }
+
+#if (AMREX_SPACEDIM == 2)
+        // nodal_restriction on beta_ed_mg
+        NodalRestriction(beta_ed_mg[n][0],beta_ed_mg[n-1][0]);
+#elif (AMREX_SPACEDIM == 3)
+        // edge_restriction on beta_ed_mg
+        EdgeRestriction(beta_ed_mg[n],beta_ed_mg[n-1]);
+#endif
+        if (stag_mg_nghost > 1) {
+            for (int d=0; d<NUM_EDGE; d++) {
+                beta_ed_mg[n][d].FillBoundary(geom_mg[n].periodicity());
+            }
+        }
+    }
+
+    if (bottom_solver) {
+
+        StagMGSolver& bottom = *bottom_solver;
+
+        int n = nlevs_mg-1;
+
+        // as on the coarse levels above, physical ghost cells are left at zero
+         bottom.beta_cc_mg[0].setVal(0.);
+        bottom.gamma_cc_mg[0].setVal(0.);
+
+         bottom.beta_cc_mg[0].ParallelCopy( beta_cc_mg[n],0,0,1);
+        bottom.gamma_cc_mg[0].ParallelCopy(gamma_cc_mg[n],0,0,1);
+
+         bottom.beta_cc_mg[0].FillBoundary(bottom.geom_mg[0].periodicity());
+        bottom.gamma_cc_mg[0].FillBoundary(bottom.geom_mg[0].periodicity());
+
+        for (int d=0; d<AMREX_SPACEDIM; d++) {
+            bottom.alpha_fc_mg[0][d].ParallelCopy(alpha_fc_mg[n][d],0,0,1);
+        }
+
+        for (int d=0; d<NUM_EDGE; d++) {
+            bottom.beta_ed_mg[0][d].ParallelCopy(beta_ed_mg[n][d],0,0,1);
+        }
+
+        bottom.CoarsenCoefficients();
+    }
+}
+
+// one V-cycle on the residual equation; phi_fc_mg[0] holds the initial guess
+// and rhs_fc_mg[0] the right-hand side
+void StagMGSolver::VCycle()
+{
+    BL_PROFILE_VAR("StagMGSolver::VCycle()",VCycle);
+
+    Real resid_temp;
+
+    int n, color_start, color_end;
+
     if (stag_mg_smoother == 0) {
         color_start = 0;
         color_end = 0;
@@ -244,24 +612,43 @@ void StagMGSolver::Solve(const std::array<MultiFab, AMREX_SPACEDIM> & alpha_fc,
         color_end = 2*AMREX_SPACEDIM;
     }
 
-    for (int vcycle=1; vcycle<=stag_mg_max_vcycles; ++vcycle) {
-
-        if (stag_mg_verbosity >= 2) {
-            Print() << "Begin V-Cycle " << vcycle << std::endl;
+    // set phi to zero at coarser levels as initial guess for residual equation
+    for (int d=0; d<AMREX_SPACEDIM; ++d) {
+        for (n=1; n<nlevs_mg; ++n) {
+            phi_fc_mg[n][d].setVal(0.);
         }
+    }
 
-        // set phi to zero at coarser levels as initial guess for residual equation
-        for (int d=0; d<AMREX_SPACEDIM; ++d) {
-            for (n=1; n<nlevs_mg; ++n) {
-                phi_fc_mg[n][d].setVal(0.);
+    // down the V-cycle
+    for (n=0; n<=nlevs_mg-2; ++n) {
+
+        // print out residual
+        if (stag_mg_verbosity >= 3) {
+
+            // compute Lphi
+            StagApplyOp(geom_mg[n],beta_cc_mg[n],gamma_cc_mg[n],beta_ed_mg[n],
+                        phi_fc_mg[n],Lphi_fc_mg[n],alpha_fc_mg[n],dx_mg[n].data(),1.);
+
+            // now subtract the rest of the RHS from Lphi.
+            for (int d=0; d<AMREX_SPACEDIM; ++d) {
+                // compute Lphi - rhs, and report residual
+                MGSubtract(Lphi_fc_mg[n][d],rhs_fc_mg[n][d],0);
+                resid_temp = MGNorm0(Lphi_fc_mg[n][d]);
+                Print() << "Residual for comp " << d << " before    smooths at level "
+                        << n << " " << resid_temp << std::endl;
             }
         }
 
-        // down the V-cycle
-        for (n=0; n<=nlevs_mg-2; ++n) {
+        // do the smooths, all in one call unless the residual is printed
+        // after each one (see Smooth)
+        int nsweeps = (stag_mg_verbosity >= 4) ? 1 : amrex::max(stag_mg_nsmooths_down,1);
+
+        for (int m=nsweeps; m<=stag_mg_nsmooths_down; m+=nsweeps) {
+
+            Smooth(n,color_start,color_end,nsweeps);
 
             // print out residual
-            if (stag_mg_verbosity >= 3) {
+            if (stag_mg_verbosity >= 4) {
 
                 // compute Lphi
                 StagApplyOp(geom_mg[n],beta_cc_mg[n],gamma_cc_mg[n],beta_ed_mg[n],
@@ -270,65 +657,179 @@ void StagMGSolver::Solve(const std::array<MultiFab, AMREX_SPACEDIM> & alpha_fc,
                 // now subtract the rest of the RHS from Lphi.
                 for (int d=0; d<AMREX_SPACEDIM; ++d) {
                     // compute Lphi - rhs, and report residual
-                    MultiFab::Subtract(Lphi_fc_mg[n][d],rhs_fc_mg[n][d],0,0,1,0);
-                    resid_temp = Lphi_fc_mg[n][d].norm0();
-                    Print() << "Residual for comp " << d << " before    smooths at level "
+                    MGSubtract(Lphi_fc_mg[n][d],rhs_fc_mg[n][d],0);
+                    resid_temp = MGNorm0(Lphi_fc_mg[n][d]);
+                    Print() << "Residual for comp " << d << " after    smooth " << m << " at level "
                             << n << " " << resid_temp << std::endl;
                 }
             }
 
-            for (int m=1; m<=stag_mg_nsmooths_down; ++m) {
+        } // end loop over nsmooths
 
-                // do the smooths
-                for (int color=color_start; color<=color_end; ++color) {
+        /////////////////
+        // compute residual
 
-                    // the form of weighted Jacobi we are using is
-                    // phi^{k+1} = phi^k + omega*D^{-1}*(rhs-Lphi)
-                    // where D is the diagonal matrix containing the diagonal elements of L
+        // compute Lphi
+        StagApplyOp(geom_mg[n],beta_cc_mg[n],gamma_cc_mg[n],beta_ed_mg[n],
+                    phi_fc_mg[n],Lphi_fc_mg[n],alpha_fc_mg[n],dx_mg[n].data(),1.);
 
-                    // compute Lphi
-                    StagApplyOp(geom_mg[n],beta_cc_mg[n],gamma_cc_mg[n],beta_ed_mg[n],
-                                phi_fc_mg[n],Lphi_fc_mg[n],alpha_fc_mg[n],dx_mg[n].data(),1.,color);
+        // now subtract the rest of the RHS from Lphi.
+        for (int d=0; d<AMREX_SPACEDIM; ++d) {
 
-                    // update phi = phi + omega*D^{-1}*(rhs-Lphi)
-                    StagMGUpdate(phi_fc_mg[n],rhs_fc_mg[n],Lphi_fc_mg[n],alpha_fc_mg[n],
-                                 beta_cc_mg[n],beta_ed_mg[n],gamma_cc_mg[n],dx_mg[n].data(),color);
+            // compute Lphi - rhs, and then multiply by -1
+            MGSubtract(Lphi_fc_mg[n][d],rhs_fc_mg[n][d],0,-1.);
+            if (stag_mg_verbosity >= 3) {
+                resid_temp = MGNorm0(Lphi_fc_mg[n][d]);
+                Print() << "Residual for comp " << d << " after all smooths at level "
+                        << n << " " << resid_temp << std::endl;
+            }
+
+            // set values on physical boundaries
+            MultiFabPhysBCDomainVel(Lphi_fc_mg[n][d], geom_mg[n],d);
+
+            // fill periodic ghost cells
+            Lphi_fc_mg[n][d].FillBoundary(geom_mg[n].periodicity());
+
+            // fill physical ghost cells
+            MultiFabPhysBCMacVel(Lphi_fc_mg[n][d], geom_mg[n],d);
+        }
+
+        // restrict/coarsen residual and put it in rhs_fc
+        StagRestriction(rhs_fc_mg[n+1],Lphi_fc_mg[n]);
+
+        for (int d=0; d<AMREX_SPACEDIM; d++) {
+            // set residual to zero on physical boundaries
+            MultiFabPhysBCDomainVel(rhs_fc_mg[n+1][d], geom_mg[n+1], d);
+        }
+
+        if (stag_mg_nghost > 1) {
+            MGFillBoundary(rhs_fc_mg[n+1], geom_mg[n+1]);
+        }
+
+    }  // end loop over nlevs_mg (bottom of V-cycle)
+
+    // bottom solve
+    n = nlevs_mg-1;
+
+    if (stag_mg_verbosity >= 3) {
+        Print() << "Begin bottom solve" << std::endl;
+    }
+
+    // print out residual
+    if (stag_mg_verbosity >= 3) {
+
+        // compute Lphi
+        StagApplyOp(geom_mg[n],beta_cc_mg[n],gamma_cc_mg[n],beta_ed_mg[n],
+                    phi_fc_mg[n],Lphi_fc_mg[n],alpha_fc_mg[n],dx_mg[n].data(),1.);
+
+        // now subtract the rest of the RHS from Lphi.
+        for (int d=0; d<AMREX_SPACEDIM; ++d) {
+            // compute Lphi - rhs, and report residual
+
+            MGSubtract(Lphi_fc_mg[n][d],rhs_fc_mg[n][d],0);
+            resid_temp = MGNorm0(Lphi_fc_mg[n][d]);
+            Print() << "Residual for comp " << d << " before    smooths at level "
+                    << n << " " << resid_temp << std::endl;
+        }
+    }
+
+    BottomSolve(color_start,color_end);
+
+    ////////////////////
+    // compute residual
+
+    // compute Lphi
+    StagApplyOp(geom_mg[n],beta_cc_mg[n],gamma_cc_mg[n],beta_ed_mg[n],
+                phi_fc_mg[n],Lphi_fc_mg[n],alpha_fc_mg[n],dx_mg[n].data(),1.);
+
+    // now subtract the rest of the RHS from Lphi.
+    for (int d=0; d<AMREX_SPACEDIM; ++d) {
+
+        // compute Lphi - rhs, and then multiply by -1
+        MGSubtract(Lphi_fc_mg[n][d],rhs_fc_mg[n][d],0,-1.);
+        if (stag_mg_verbosity >= 3) {
+            resid_temp = MGNorm0(Lphi_fc_mg[n][d]);
+            Print() << "Residual for comp " << d << " after all smooths at level "
+                    << n << " " << resid_temp << std::endl;
+        }
+
+        // set values on physical boundaries
+        MultiFabPhysBCDomainVel(Lphi_fc_mg[n][d], geom_mg[n],d);
+
+        // fill periodic ghost cells
+        Lphi_fc_mg[n][d].FillBoundary(geom_mg[n].periodicity());
+
+        // fill physical ghost cells
+        MultiFabPhysBCMacVel(Lphi_fc_mg[n][d], geom_mg[n],d);
+    }
+
+    if (stag_mg_verbosity >= 3) {
+        Print() << "End bottom solve" << std::endl;
+    }
+
+    // up the V-cycle
+    for (n=nlevs_mg-2; n>=0; --n) {
+
+        // prolongate/interpolate correction to update phi
+        StagProlongation(phi_fc_mg[n+1],phi_fc_mg[n]);
+
+        for (int d=0; d<AMREX_SPACEDIM; ++d) {
+
+            // set values on physical boundaries
+            MultiFabPhysBCDomainVel(phi_fc_mg[n][d], geom_mg[n],d);
+
+            // fill periodic ghost cells
+            phi_fc_mg[n][d].FillBoundary(geom_mg[n].periodicity());
+
+            // fill physical ghost cells
+            MultiFabPhysBCMacVel(phi_fc_mg[n][d], geom_mg[n],d);
+        }
+
+        // print out residual
+        if (stag_mg_verbosity >= 3) {
+
+            // compute Lphi
+            StagApplyOp(geom_mg[n],beta_cc_mg[n],gamma_cc_mg[n],beta_ed_mg[n],
+                        phi_fc_mg[n],Lphi_fc_mg[n],alpha_fc_mg[n],dx_mg[n].data(),1.);
 
-                    for (int d=0; d<AMREX_SPACEDIM; ++d) {
+            // now subtract the rest of the RHS from Lphi.
+            for (int d=0; d<AMREX_SPACEDIM; ++d) {
+                // compute Lphi - rhs, and report residual
+                MGSubtract(Lphi_fc_mg[n][d],rhs_fc_mg[n][d],0);
+                resid_temp = MGNorm0(Lphi_fc_mg[n][d]);
+                Print() << "Residual for comp " << d << " before    smooths at level "
+                        << n << " " << resid_temp << std::endl;
+            }
+        }
 
-                        // set values on physical boundaries
-                        MultiFabPhysBCDomainVel(phi_fc_mg[n][d], geom_mg[n],d);
+        // do the smooths, all in one call unless the residual is printed
+        // after each one (see Smooth)
+        int nsweeps = (stag_mg_verbosity >= 4) ? 1 : amrex::max(stag_mg_nsmooths_up,1);
 
-                        // fill periodic ghost cells
-                        phi_fc_mg[n][d].FillBoundary(geom_mg[n].periodicity());
+        for (int m=nsweeps; m<=stag_mg_nsmooths_up; m+=nsweeps) {
 
-                        // fill physical ghost cells
-                        MultiFabPhysBCMacVel(phi_fc_mg[n][d], geom_mg[n],d);
-                    }
+            Smooth(n,color_start,color_end,nsweeps);
 
-                } // end loop over colors
+            // print out residual
+            if (stag_mg_verbosity >= 4) {
 
-                // print out residual
-                if (stag_mg_verbosity >= 4) {
+                // compute Lphi
+                StagApplyOp(geom_mg[n],beta_cc_mg[n],gamma_cc_mg[n],beta_ed_mg[n],
+                            phi_fc_mg[n],Lphi_fc_mg[n],alpha_fc_mg[n],dx_mg[n].data(),1.);
 
-                    // compute Lphi
-                    StagApplyOp(geom_mg[n],beta_cc_mg[n],gamma_cc_mg[n],beta_ed_mg[n],
-                                phi_fc_mg[n],Lphi_fc_mg[n],alpha_fc_mg[n],dx_mg[n].data(),1.);
-
-                    // now subtract the rest of the RHS from Lphi.
-                    for (int d=0; d<AMREX_SPACEDIM; ++d) {
-                        // compute Lphi - rhs, and report residual
-                        MultiFab::Subtract(Lphi_fc_mg[n][d],rhs_fc_mg[n][d],0,0,1,0);
-                        resid_temp = Lphi_fc_mg[n][d].norm0();
-                        Print() << "Residual for comp " << d << " after    smooth " << m << " at level "
-                                << n << " " << resid_temp << std::endl;
-                    }
+                // now subtract the rest of the RHS from Lphi.
+                for (int d=0; d<AMREX_SPACEDIM; ++d) {
+                    // compute Lphi - rhs, and report residual
+                    MGSubtract(Lphi_fc_mg[n][d],rhs_fc_mg[n][d],0);
+                    resid_temp = MGNorm0(Lphi_fc_mg[n][d]);
+                    Print() << "Residual for comp " << d << " after    smooth " << m << " at level "
+                            << n << " " << resid_temp << std::endl;
                 }
+            }
 
-            } // end loop over nsmooths
+        } // end loop over stag_mg_nsmooths_up
 
-            /////////////////
-            // compute residual
+        if (stag_mg_verbosity >= 3) {
 
             // compute Lphi
             StagApplyOp(geom_mg[n],beta_cc_mg[n],gamma_cc_mg[n],beta_ed_mg[n],
@@ -336,173 +837,219 @@ void StagMGSolver::Solve(const std::array<MultiFab, AMREX_SPACEDIM> & alpha_fc,
 
             // now subtract the rest of the RHS from Lphi.
             for (int d=0; d<AMREX_SPACEDIM; ++d) {
+                // compute Lphi - rhs, and report residual
+                MGSubtract(Lphi_fc_mg[n][d],rhs_fc_mg[n][d],0);
+                resid_temp = MGNorm0(Lphi_fc_mg[n][d]);
+                Print() << "Residual for comp " << d << " after all smooths at level "
+                        << n << " " << resid_temp << std::endl;
+            }
+        }
 
-                // compute Lphi - rhs, and then multiply by -1
-                MultiFab::Subtract(Lphi_fc_mg[n][d],rhs_fc_mg[n][d],0,0,1,0);
-                Lphi_fc_mg[n][d].mult(-1.,0,1,0);
-                if (stag_mg_verbosity >= 3) {
-                    resid_temp = Lphi_fc_mg[n][d].norm0();
-                    Print() << "Residual for comp " << d << " after all smooths at level "
-                            << n << " " << resid_temp << std::endl;
-                }
-
-                // set values on physical boundaries
-                MultiFabPhysBCDomainVel(Lphi_fc_mg[n][d], geom_mg[n],d);
+    } // end loop over nlevs_mg (top of V-cycle)
+}
 
-                // fill periodic ghost cells
-                Lphi_fc_mg[n][d].FillBoundary(geom_mg[n].periodicity());
+// solve the residual equation on the coarsest level, nlevs_mg-1
+// stag_mg_bottom_solver = 0: stag_mg_nsmooths_bottom smooths
+// stag_mg_bottom_solver = 1: conjugate gradient
+// stag_mg_bottom_solver = 4: restrict the residual onto the single-grid bottom
+//                            hierarchy, do one V-cycle there (ending in
+//                            conjugate gradient), and add the correction back
+void StagMGSolver::BottomSolve(int color_start, int color_end)
+{
+    BL_PROFILE_VAR("StagMGSolver::BottomSolve()",BottomSolve);
 
-                // fill physical ghost cells
-                MultiFabPhysBCMacVel(Lphi_fc_mg[n][d], geom_mg[n],d);
-            }
+    int n = nlevs_mg-1;
 
-            // restrict/coarsen residual and put it in rhs_fc
-            StagRestriction(rhs_fc_mg[n+1],Lphi_fc_mg[n]);
+    if (bottom_solver) {
 
-            for (int d=0; d<AMREX_SPACEDIM; d++) {
-                // set residual to zero on physical boundaries
-                MultiFabPhysBCDomainVel(rhs_fc_mg[n+1][d], geom_mg[n+1], d);
-            }
+        StagMGSolver& bottom = *bottom_solver;
 
-        }  // end loop over nlevs_mg (bottom of V-cycle)
+        // rhs - Lphi goes to the bottom hierarchy as its right-hand side
+        // (phi is zero here unless nlevs_mg = 1)
+        StagApplyOp(geom_mg[n],beta_cc_mg[n],gamma_cc_mg[n],beta_ed_mg[n],
+                    phi_fc_mg[n],Lphi_fc_mg[n],alpha_fc_mg[n],dx_mg[n].data(),1.);
 
-        // bottom solve
-        n = nlevs_mg-1;
+        for (int d=0; d<AMREX_SPACEDIM; ++d) {
+            MGSubtract(Lphi_fc_mg[n][d],rhs_fc_mg[n][d],0,-1.);
+            bottom.rhs_fc_mg[0][d].ParallelCopy(Lphi_fc_mg[n][d],0,0,1);
+            bottom.phi_fc_mg[0][d].setVal(0.);
+        }
 
-        if (stag_mg_verbosity >= 3) {
-            Print() << "Begin bottom solve" << std::endl;
+        if (stag_mg_nghost > 1) {
+            MGFillBoundary(bottom.rhs_fc_mg[0], bottom.geom_mg[0]);
         }
 
-        ////////////////////////////
-        // just do smooths at the current level as the bottom solve
+        bottom.VCycle();
 
-        // print out residual
-        if (stag_mg_verbosity >= 3) {
+        // add the correction to phi
+        for (int d=0; d<AMREX_SPACEDIM; ++d) {
+            Lphi_fc_mg[n][d].ParallelCopy(bottom.phi_fc_mg[0][d],0,0,1);
+            MGAxpy(phi_fc_mg[n][d],1.,Lphi_fc_mg[n][d]);
 
-            // compute Lphi
-            StagApplyOp(geom_mg[n],beta_cc_mg[n],gamma_cc_mg[n],beta_ed_mg[n],
-                        phi_fc_mg[n],Lphi_fc_mg[n],alpha_fc_mg[n],dx_mg[n].data(),1.);
+            // set values on physical boundaries
+            MultiFabPhysBCDomainVel(phi_fc_mg[n][d], geom_mg[n],d);
 
-            // now subtract the rest of the RHS from Lphi.
-            for (int d=0; d<AMREX_SPACEDIM; ++d) {
-                // compute Lphi - rhs, and report residual
+            // fill periodic ghost cells
+            phi_fc_mg[n][d].FillBoundary(geom_mg[n].periodicity());
 
-                MultiFab::Subtract(Lphi_fc_mg[n][d],rhs_fc_mg[n][d],0,0,1,0);
-                resid_temp = Lphi_fc_mg[n][d].norm0();
-                Print() << "Residual for comp " << d << " before    smooths at level "
-                        << n << " " << resid_temp << std::endl;
-            }
+            // fill physical ghost cells
+            MultiFabPhysBCMacVel(phi_fc_mg[n][d], geom_mg[n],d);
         }
+    }
+    else if (stag_mg_bottom_solver == 1 || is_bottom == 1) {
 
-        for (int m=1; m<=stag_mg_nsmooths_bottom; ++m) {
+        BottomCG();
+    }
+    else {
 
-            // do the smooths
-            for (int color=color_start; color<=color_end; ++color) {
+        ////////////////////////////
+        // just do smooths at the current level as the bottom solve
 
-                // the form of weighted Jacobi we are using is
-                // phi^{k+1} = phi^k + omega*D^{-1}*(rhs-Lphi)
-                // where D is the diagonal matrix containing the diagonal elements of L
+        Smooth(n,color_start,color_end,stag_mg_nsmooths_bottom);
+    }
+}
 
-                // compute Lphi
-                StagApplyOp(geom_mg[n],beta_cc_mg[n],gamma_cc_mg[n],beta_ed_mg[n],
-                            phi_fc_mg[n],Lphi_fc_mg[n],alpha_fc_mg[n],dx_mg[n].data(),1.,color);
+// conjugate gradient on the coarsest level, starting from the current phi,
+// until the residual is reduced by stag_mg_bottom_rel_tol or
+// stag_mg_bottom_max_iter iterations are done.
+// The operator is symmetric in the SumStag-weighted inner product.
+// On the agglomerated bottom hierarchy there is a single grid owned by the I/O
+// rank; it broadcasts the inner products, so every rank takes the same number
+// of iterations and posts the same sequence of halo exchanges.
+void StagMGSolver::BottomCG()
+{
+    BL_PROFILE_VAR("StagMGSolver::BottomCG()",BottomCG);
 
-                // update phi = phi + omega*D^{-1}*(rhs-Lphi)
-                StagMGUpdate(phi_fc_mg[n],rhs_fc_mg[n],Lphi_fc_mg[n],alpha_fc_mg[n],
-                             beta_cc_mg[n],beta_ed_mg[n],gamma_cc_mg[n],dx_mg[n].data(),color);
+    int n = nlevs_mg-1;
 
-                for (int d=0; d<AMREX_SPACEDIM; d++) {
+    const int owner = (is_bottom == 1) ? ParallelDescriptor::IOProcessorNumber() : -1;
 
-                    // set values on physical boundaires
-                    MultiFabPhysBCDomainVel(phi_fc_mg[n][d], geom_mg[n],d);
+    std::array<StagMGFab, AMREX_SPACEDIM>& x  = phi_fc_mg[n];
+    std::array<StagMGFab, AMREX_SPACEDIM>& r  = resid_fc_mg[n];
+    std::array<StagMGFab, AMREX_SPACEDIM>& Ap = Lphi_fc_mg[n];
+    std::array<StagMGFab, AMREX_SPACEDIM>& p  = cg_p_fc;
 
-                    // fill periodic ghost cells
-                    phi_fc_mg[n][d].FillBoundary(geom_mg[n].periodicity());
+    // r = rhs - L x; p = r
+    StagApplyOp(geom_mg[n],beta_cc_mg[n],gamma_cc_mg[n],beta_ed_mg[n],
+                x,Ap,alpha_fc_mg[n],dx_mg[n].data(),1.);
 
-                    // fill physical ghost cells
-                    MultiFabPhysBCMacVel(phi_fc_mg[n][d], geom_mg[n],d);
-                }
+    for (int d=0; d<AMREX_SPACEDIM; ++d) {
+        MGCopy(r[d],rhs_fc_mg[n][d],0);
+        MGSubtract(r[d],Ap[d],0);
+        MGCopy(p[d],r[d],0);
+
+        MultiFabPhysBCDomainVel(p[d], geom_mg[n],d);
+        p[d].FillBoundary(geom_mg[n].periodicity());
+        MultiFabPhysBCMacVel(p[d], geom_mg[n],d);
+    }
 
-            } // end loop over colors
+    Real rr = MGStagDot(r,r,owner);
+    const Real rr0 = rr;
 
-        } // end loop over nsmooths
+    if (rr0 == 0.) {
+        return;
+    }
 
-        ////////////////////
-        // compute residual
+    int iter;
+    for (iter=1; iter<=stag_mg_bottom_max_iter; ++iter) {
 
-        // compute Lphi
         StagApplyOp(geom_mg[n],beta_cc_mg[n],gamma_cc_mg[n],beta_ed_mg[n],
-                    phi_fc_mg[n],Lphi_fc_mg[n],alpha_fc_mg[n],dx_mg[n].data(),1.);
+                    p,Ap,alpha_fc_mg[n],dx_mg[n].data(),1.);
 
-        // now subtract the rest of the RHS from Lphi.
-        for (int d=0; d<AMREX_SPACEDIM; ++d) {
+        Real pAp = MGStagDot(p,Ap,owner);
+        if (pAp <= 0.) {
+            break;
+        }
 
-            // compute Lphi - rhs, and then multiply by -1
-            MultiFab::Subtract(Lphi_fc_mg[n][d],rhs_fc_mg[n][d],0,0,1,0);
-            Lphi_fc_mg[n][d].mult(-1.,0,1,0);
-            if (stag_mg_verbosity >= 3) {
-                resid_temp = Lphi_fc_mg[n][d].norm0();
-                Print() << "Residual for comp " << d << " after all smooths at level "
-                        << n << " " << resid_temp << std::endl;
-            }
+        Real alpha = rr/pAp;
 
-            // set values on physical boundaries
-            MultiFabPhysBCDomainVel(Lphi_fc_mg[n][d], geom_mg[n],d);
+        for (int d=0; d<AMREX_SPACEDIM; ++d) {
+            MGAxpy(x[d], alpha,p[d]);
+            MGAxpy(r[d],-alpha,Ap[d]);
+        }
 
-            // fill periodic ghost cells
-            Lphi_fc_mg[n][d].FillBoundary(geom_mg[n].periodicity());
+        Real rr_new = MGStagDot(r,r,owner);
 
-            // fill physical ghost cells
-            MultiFabPhysBCMacVel(Lphi_fc_mg[n][d], geom_mg[n],d);
+        if (rr_new <= stag_mg_bottom_rel_tol*stag_mg_bottom_rel_tol*rr0) {
+            break;
         }
 
-        if (stag_mg_verbosity >= 3) {
-            Print() << "End bottom solve" << std::endl;
+        // p = r + (rr_new/rr) p
+        for (int d=0; d<AMREX_SPACEDIM; ++d) {
+            MGAxpy(p[d],1.,r[d],rr_new/rr);
+
+            MultiFabPhysBCDomainVel(p[d], geom_mg[n],d);
+            p[d].FillBoundary(geom_mg[n].periodicity());
+            MultiFabPhysBCMacVel(p[d], geom_mg[n],d);
         }
 
-        // up the V-cycle
-        for (n=nlevs_mg-2; n>=0; --n) {
+        rr = rr_new;
+    }
 
-            // prolongate/interpolate correction to update phi
-            StagProlongation(phi_fc_mg[n+1],phi_fc_mg[n]);
+    for (int d=0; d<AMREX_SPACEDIM; ++d) {
 
-            for (int d=0; d<AMREX_SPACEDIM; ++d) {
+        // set values on physical boundaries
+        MultiFabPhysBCDomainVel(x[d], geom_mg[n],d);
 
-                // set values on physical boundaries
-                MultiFabPhysBCDomainVel(phi_fc_mg[n][d], geom_mg[n],d);
+        // fill periodic ghost cells
+        x[d].FillBoundary(geom_mg[n].periodicity());
 
-                // fill periodic ghost cells
-                phi_fc_mg[n][d].FillBoundary(geom_mg[n].periodicity());
+        // fill physical ghost cells
+        MultiFabPhysBCMacVel(x[d], geom_mg[n],d);
+    }
 
-                // fill physical ghost cells
-                MultiFabPhysBCMacVel(phi_fc_mg[n][d], geom_mg[n],d);
+    if (stag_mg_verbosity >= 3) {
+        Print() << "Bottom CG iterations: " << amrex::min(iter,stag_mg_bottom_max_iter) << std::endl;
+    }
+}
+
+// nsweeps smoothing sweeps over the colors at level n
+// the form of weighted Jacobi we are using is
+// phi^{k+1} = phi^k + omega*D^{-1}*(rhs-Lphi)
+// where D is the diagonal matrix containing the diagonal elements of L
+// phi comes in and leaves with its first layer of ghost faces filled.
+// With stag_mg_nghost = 1, each color only changes one velocity component (all of
+// them for color 0), so only that component's ghost cells are refilled, and the
+// halo exchanges for several components are posted before waiting on any of them.
+// With stag_mg_nghost > 1 the exchanges are stag_mg_nghost faces wide and are done
+// once for several colors (see SmoothWideGhost).
+void StagMGSolver::Smooth(int n, int color_start, int color_end, int nsweeps)
+{
+    BL_PROFILE_VAR("StagMGSolver::Smooth()",Smooth);
+
+    if (phi_fc_mg[n][0].nGrow() > 1) {
+
+        // recomputing the ghost faces locally needs them to have the same
+        // red/black color as the faces they copy, which fails across a
+        // periodic boundary with an odd number of faces
+        bool colors_match = true;
+        if (color_start != 0) {
+            for (int i=0; i<AMREX_SPACEDIM; ++i) {
+                if (geom_mg[n].isPeriodic(i) && geom_mg[n].Domain().length(i)%2 != 0) {
+                    colors_match = false;
+                }
             }
+        }
 
-            // print out residual
-            if (stag_mg_verbosity >= 3) {
+        if (colors_match) {
+            SmoothWideGhost(n,color_start,color_end,nsweeps);
+            return;
+        }
+    }
 
-                // compute Lphi
-                StagApplyOp(geom_mg[n],beta_cc_mg[n],gamma_cc_mg[n],beta_ed_mg[n],
-                            phi_fc_mg[n],Lphi_fc_mg[n],alpha_fc_mg[n],dx_mg[n].data(),1.);
+    for (int m=1; m<=nsweeps; ++m) {
 
-                // now subtract the rest of the RHS from Lphi.
-                for (int d=0; d<AMREX_SPACEDIM; ++d) {
-                    // compute Lphi - rhs, and report residual
-                    MultiFab::Subtract(Lphi_fc_mg[n][d],rhs_fc_mg[n][d],0,0,1,0);
-                    resid_temp = Lphi_fc_mg[n][d].norm0();
-                    Print() << "Residual for comp " << d << " before    smooths at level "
-                            << n << " " << resid_temp << std::endl;
-                }
-            }
+        if (color_start == 1 && amrex::Math::abs(visc_type) == 1) {
 
-            for (int m=1; m<=stag_mg_nsmooths_up; ++m) {
+            // for L = div beta grad the velocity components decouple, so we do
+            // the first color of every component, then the second color of every
+            // component; each component's exchange is in flight while the next
+            // component is being smoothed
+            for (int parity=0; parity<2; ++parity) {
 
-                // do the smooths
-                for (int color=color_start; color<=color_end; ++color) {
+                for (int d=0; d<AMREX_SPACEDIM; ++d) {
 
-                    // the form of weighted Jacobi we are using is
-                    // phi^{k+1} = phi^k + omega*D^{-1}*(rhs-Lphi)
-                    // where D is the diagonal matrix containing the diagonal elements of L
+                    int color = 2*d+1+parity;
 
                     // compute Lphi
                     StagApplyOp(geom_mg[n],beta_cc_mg[n],gamma_cc_mg[n],beta_ed_mg[n],
@@ -510,149 +1057,156 @@ void StagMGSolver::Solve(const std::array<MultiFab, AMREX_SPACEDIM> & alpha_fc,
 
                     // update phi = phi + omega*D^{-1}*(rhs-Lphi)
                     StagMGUpdate(phi_fc_mg[n],rhs_fc_mg[n],Lphi_fc_mg[n],alpha_fc_mg[n],
-                                 beta_cc_mg[n],beta_ed_mg[n],gamma_cc_mg[n],dx_mg[n].data(),color);
+                                 beta_cc_mg[n],beta_ed_mg[n],gamma_cc_mg[n],dx_mg[n].data(),
+                                 geom_mg[n],color);
 
-                    for (int d=0; d<AMREX_SPACEDIM; d++) {
+                    // set values on physical boundaries
+                    MultiFabPhysBCDomainVel(phi_fc_mg[n][d], geom_mg[n],d);
 
-                        // set values on physical boundaries
-                        MultiFabPhysBCDomainVel(phi_fc_mg[n][d], geom_mg[n],d);
+                    // start filling periodic ghost cells
+                    phi_fc_mg[n][d].FillBoundary_nowait(geom_mg[n].periodicity());
+                }
 
-                        // fill periodic ghost cells
-                        phi_fc_mg[n][d].FillBoundary(geom_mg[n].periodicity());
+                for (int d=0; d<AMREX_SPACEDIM; ++d) {
 
-                        // fill physical ghost cells
-                        MultiFabPhysBCMacVel(phi_fc_mg[n][d], geom_mg[n],d);
-                    }
+                    phi_fc_mg[n][d].FillBoundary_finish();
 
-                } // end loop over colors
+                    // fill physical ghost cells
+                    MultiFabPhysBCMacVel(phi_fc_mg[n][d], geom_mg[n],d);
+                }
+            }
 
-                // print out residual
-                if (stag_mg_verbosity >= 4) {
+            continue;
+        }
 
-                    // compute Lphi
-                    StagApplyOp(geom_mg[n],beta_cc_mg[n],gamma_cc_mg[n],beta_ed_mg[n],
-                                phi_fc_mg[n],Lphi_fc_mg[n],alpha_fc_mg[n],dx_mg[n].data(),1.);
-
-                    // now subtract the rest of the RHS from Lphi.
-                    for (int d=0; d<AMREX_SPACEDIM; ++d) {
-                        // compute Lphi - rhs, and report residual
-                        MultiFab::Subtract(Lphi_fc_mg[n][d],rhs_fc_mg[n][d],0,0,1,0);
-                        resid_temp = Lphi_fc_mg[n][d].norm0();
-                        Print() << "Residual for comp " << d << " after    smooth " << m << " at level "
-                                << n << " " << resid_temp << std::endl;
-                    }
-                }
+        for (int color=color_start; color<=color_end; ++color) {
 
-            } // end loop over stag_mg_nsmooths_up
+            // compute Lphi
+            StagApplyOp(geom_mg[n],beta_cc_mg[n],gamma_cc_mg[n],beta_ed_mg[n],
+                        phi_fc_mg[n],Lphi_fc_mg[n],alpha_fc_mg[n],dx_mg[n].data(),1.,color);
 
-            if (stag_mg_verbosity >= 3) {
+            // update phi = phi + omega*D^{-1}*(rhs-Lphi)
+            StagMGUpdate(phi_fc_mg[n],rhs_fc_mg[n],Lphi_fc_mg[n],alpha_fc_mg[n],
+                         beta_cc_mg[n],beta_ed_mg[n],gamma_cc_mg[n],dx_mg[n].data(),
+                         geom_mg[n],color);
 
-                // compute Lphi
-                StagApplyOp(geom_mg[n],beta_cc_mg[n],gamma_cc_mg[n],beta_ed_mg[n],
-                            phi_fc_mg[n],Lphi_fc_mg[n],alpha_fc_mg[n],dx_mg[n].data(),1.);
+            // components updated by this color
+            int dlo = (color == 0) ? 0 : (color-1)/2;
+            int dhi = (color == 0) ? AMREX_SPACEDIM-1 : dlo;
 
-                for (int d=0; d<AMREX_SPACEDIM; ++d) {
-                    // compute Lphi - rhs, and report residual
-                    MultiFab::Subtract(Lphi_fc_mg[n][d],rhs_fc_mg[n][d],0,0,1,0);
-                    resid_temp = Lphi_fc_mg[n][d].norm0();
-                    Print() << "Residual for comp " << d << " after all smooths at level "
-                            << n << " " << resid_temp << std::endl;
-                }
+            for (int d=dlo; d<=dhi; ++d) {
+
+                // set values on physical boundaries
+                MultiFabPhysBCDomainVel(phi_fc_mg[n][d], geom_mg[n],d);
+
+                // start filling periodic ghost cells
+                phi_fc_mg[n][d].FillBoundary_nowait(geom_mg[n].periodicity());
             }
 
-        } // end loop over nlevs_mg (top of V-cycle)
+            for (int d=dlo; d<=dhi; ++d) {
 
-        if (stag_mg_verbosity >= 2) {
-            Print() << "End   V-Cycle " << vcycle << std::endl;
-        }
+                phi_fc_mg[n][d].FillBoundary_finish();
 
-        // compute norm of residual
+                // fill physical ghost cells
+                MultiFabPhysBCMacVel(phi_fc_mg[n][d], geom_mg[n],d);
+            }
 
-        // compute Lphi
-        StagApplyOp(geom_mg[0],beta_cc_mg[0],gamma_cc_mg[0],beta_ed_mg[0],
-                    phi_fc_mg[0],Lphi_fc_mg[0],alpha_fc_mg[0],dx_mg[0].data(),1.);
+        } // end loop over colors
 
-        // compute Lphi - rhs
-        for (int d=0; d<AMREX_SPACEDIM; ++d) {
-            // compute Lphi - rhs
-            MultiFab::Subtract(Lphi_fc_mg[0][d],rhs_fc_mg[0][d],0,0,1,0);
-        }
+    } // end loop over sweeps
+}
 
-        // compute L0 norm of Lphi - rhs and determine if the problem is solved
-        for (int d=0; d<AMREX_SPACEDIM; ++d) {
-            resid[d] = Lphi_fc_mg[0][d].norm0();
-// FIXME - need to write an L2 norm for staggered fields
-//            resid_l2[d] = Lphi_fc_mg[0][d].norm2();
-            if (stag_mg_verbosity >= 2) {
-                Print() << "Residual     " << d << " " << resid[d] << std::endl;
-                Print() << "resid/resid0 " << d << " " << resid[d]/resid0[d] << std::endl;
-            }
-        }
-        if (stag_mg_verbosity >= 1) {
-// FIXME - need to write an L2 norm for staggered fields
-/*
-            Real sum1=0., sum2=0.;
-            for (int d=0; d<AMREX_SPACEDIM; ++d) {
-                sum1 += pow(resid_l2[d],2.0);
-                sum2 += pow(resid0_l2[d],2.0);
-            }
-            Print() << "StagMG: L2 |r|/|r0|: " << vcycle
-                    << sqrt(sum1)/sqrt(sum2);
-            for (int d=0; d<AMREX_SPACEDIM; ++d) {
-                Print() << " " << resid_l2[d]/resid0_l2[d];
-            }
-            Print() << std::endl;
-*/
-        }
+// Smooth with phi_fc_mg[n] carrying ng = stag_mg_nghost > 1 ghost faces.
+// A color computes Lphi and updates phi on the valid faces grown by r ghost
+// faces, which needs phi valid r+1 faces out, and leaves the updated component
+// valid r faces out.  We track how many layers of each component are still
+// valid and only exchange (all stale components at once, ng faces wide) when a
+// color would have r < 0.  The ghost faces are updated with the same stencil,
+// coefficients, and color as the valid faces they copy, so the result is the
+// same as exchanging after every color.  For |visc_type| = 1 the stencil of a
+// component only involves that component, so a color only uses up layers of the
+// component it updates.
+void StagMGSolver::SmoothWideGhost(int n, int color_start, int color_end, int nsweeps)
+{
+    const int ng = phi_fc_mg[n][0].nGrow();
 
-        for (int d=0; d<AMREX_SPACEDIM; ++d) {
-            resid[d] /= resid0[d];
-        }
+    // number of valid layers of ghost faces of each component
+    std::array<int, AMREX_SPACEDIM> nvalid;
+    nvalid.fill(1);
 
-        if ( std::all_of(resid.begin(), resid.end(), [](Real x){return x <= stag_mg_rel_tol;}) ) {
-            if (stag_mg_verbosity >= 1) {
-                Print() << "Solved in " << vcycle << " staggered V-cycles" << std::endl;
-                for (int d=0; d<AMREX_SPACEDIM; ++d) {
-                    Print() << "resid/resid0 " << d << " " << resid[d] << std::endl;
-                }
+    for (int m=1; m<=nsweeps; ++m) {
+
+        for (int color=color_start; color<=color_end; ++color) {
+
+            // components updated by this color
+            int dlo = (color == 0) ? 0 : (color-1)/2;
+            int dhi = (color == 0) ? AMREX_SPACEDIM-1 : dlo;
+
+            // components in the stencil of the updated ones
+            int slo = (amrex::Math::abs(visc_type) == 1) ? dlo : 0;
+            int shi = (amrex::Math::abs(visc_type) == 1) ? dhi : AMREX_SPACEDIM-1;
+
+            int ngrow = ng;
+            for (int d=slo; d<=shi; ++d) {
+                ngrow = amrex::min(ngrow, nvalid[d]-1);
             }
-	    break;
-        }
 
-        if (vcycle == stag_mg_max_vcycles) {
-            if (stag_mg_verbosity >= 1) {
-                Print() << "Exiting staggered multigrid; maximum number of V-Cycles reached" << std::endl;
-                for (int d=0; d<AMREX_SPACEDIM; ++d) {
-                    Print() << "resid/resid0 " << d << " " << resid[d] << std::endl;
-                }
+            if (ngrow < 0) {
+                SmoothFillBoundary(n, nvalid, ng);
+                ngrow = ng-1;
             }
-        }
 
-    } // end loop over stag_mg_max_vcycles
+            // compute Lphi
+            StagApplyOp(geom_mg[n],beta_cc_mg[n],gamma_cc_mg[n],beta_ed_mg[n],
+                        phi_fc_mg[n],Lphi_fc_mg[n],alpha_fc_mg[n],dx_mg[n].data(),1.,color,
+                        ngrow);
 
-    //////////////////////////////////
-    // Done with multigrid
-    //////////////////////////////////
+            // update phi = phi + omega*D^{-1}*(rhs-Lphi)
+            StagMGUpdate(phi_fc_mg[n],rhs_fc_mg[n],Lphi_fc_mg[n],alpha_fc_mg[n],
+                         beta_cc_mg[n],beta_ed_mg[n],gamma_cc_mg[n],dx_mg[n].data(),
+                         geom_mg[n],color,ngrow);
 
-    for (int d=0; d<AMREX_SPACEDIM; ++d) {
+            for (int d=dlo; d<=dhi; ++d) {
 
-        // copy solution back into phi_fc
-        MultiFab::Copy(phi_fc[d],phi_fc_mg[0][d],0,0,1,0);
+                // set values on physical boundaries and in the physical ghost
+                // cells; both only read faces inside the domain
+                MultiFabPhysBCDomainVel(phi_fc_mg[n][d], geom_mg[n],d);
+                MultiFabPhysBCMacVel(phi_fc_mg[n][d], geom_mg[n],d);
 
-        // set values on physical boundaries
-        MultiFabPhysBCDomainVel(phi_fc[d], geom_mg[0],d);
+                nvalid[d] = ngrow;
+            }
 
-        // fill periodic ghost cells
-        phi_fc[d].FillBoundary(geom_mg[0].periodicity());
+        } // end loop over colors
 
-        // fill physical ghost cells
-        MultiFabPhysBCMacVel(phi_fc[d], geom_mg[0],d);
+    } // end loop over sweeps
+
+    // leave the first layer of ghost faces valid
+    SmoothFillBoundary(n, nvalid, 1);
+}
+
+// refill the ghost faces of the components of phi_fc_mg[n] that have fewer
+// than nmin valid layers, posting their exchanges before waiting on any of them
+void StagMGSolver::SmoothFillBoundary(int n, std::array<int, AMREX_SPACEDIM>& nvalid, int nmin)
+{
+    for (int d=0; d<AMREX_SPACEDIM; ++d) {
+        if (nvalid[d] < nmin) {
+            phi_fc_mg[n][d].FillBoundary_nowait(geom_mg[n].periodicity());
+        }
     }
 
-    // vcycle_counter += AMREX_SPACEDIM*stag_mg_max_vcycles;
+    for (int d=0; d<AMREX_SPACEDIM; ++d) {
+        if (nvalid[d] < nmin) {
 
-    if (stag_mg_verbosity >= 1) {
-        Print() << "End call to stag_mg_solver\n";
+            phi_fc_mg[n][d].FillBoundary_finish();
+
+            // set values on physical boundaries
+            MultiFabPhysBCDomainVel(phi_fc_mg[n][d], geom_mg[n],d);
+
+            // fill physical ghost cells
+            MultiFabPhysBCMacVel(phi_fc_mg[n][d], geom_mg[n],d);
+
+            nvalid[d] = phi_fc_mg[n][d].nGrow();
+        }
     }
 }
 
@@ -688,7 +1242,7 @@ int StagMGSolver::ComputeNlevsMG(const BoxArray& ba) {
     return nlevs_mg;
 }
 
-void StagMGSolver::CCRestriction(MultiFab& phi_c, const MultiFab& phi_f, const Geometry& geom_c)
+void StagMGSolver::CCRestriction(StagMGFab& phi_c, const StagMGFab& phi_f, const Geometry& geom_c)
 {
     BL_PROFILE_VAR("CCRestriction()",CCRestriction);
 
@@ -698,8 +1252,8 @@ void StagMGSolver::CCRestriction(MultiFab& phi_c, const MultiFab& phi_f, const G
         // Get the index space of the valid region
         const Box& bx = mfi.tilebox();
 
-        Array4<Real      > const& phi_c_fab = phi_c.array(mfi);
-        Array4<Real const> const& phi_f_fab = phi_f.array(mfi);
+        Array4<StagMGReal      > const& phi_c_fab = phi_c.array(mfi);
+        Array4<StagMGReal const> const& phi_f_fab = phi_f.array(mfi);
 
         amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
 #if (AMREX_SPACEDIM==2)
@@ -720,8 +1274,8 @@ void StagMGSolver::CCRestriction(MultiFab& phi_c, const MultiFab& phi_f, const G
     phi_c.FillBoundary(geom_c.periodicity());
 }
 
-void StagMGSolver::StagRestriction(std::array< MultiFab, AMREX_SPACEDIM >& phi_c,
-                     const std::array< MultiFab, AMREX_SPACEDIM >& phi_f,
+void StagMGSolver::StagRestriction(std::array< StagMGFab, AMREX_SPACEDIM >& phi_c,
+                     const std::array< StagMGFab, AMREX_SPACEDIM >& phi_f,
                      int simple_stencil)
 {
 
@@ -738,13 +1292,13 @@ void StagMGSolver::StagRestriction(std::array< MultiFab, AMREX_SPACEDIM >& phi_c
 
         const Box& index_bounds = amrex::getIndexBounds(AMREX_D_DECL(bx_x, bx_y, bx_z));
 
-        AMREX_D_TERM(Array4<Real> const& phix_c_fab = phi_c[0].array(mfi);,
-                     Array4<Real> const& phiy_c_fab = phi_c[1].array(mfi);,
-                     Array4<Real> const& phiz_c_fab = phi_c[2].array(mfi););
+        AMREX_D_TERM(Array4<StagMGReal> const& phix_c_fab = phi_c[0].array(mfi);,
+                     Array4<StagMGReal> const& phiy_c_fab = phi_c[1].array(mfi);,
+                     Array4<StagMGReal> const& phiz_c_fab = phi_c[2].array(mfi););
 
-        AMREX_D_TERM(Array4<Real const> const& phix_f_fab = phi_f[0].array(mfi);,
-                     Array4<Real const> const& phiy_f_fab = phi_f[1].array(mfi);,
-                     Array4<Real const> const& phiz_f_fab = phi_f[2].array(mfi););
+        AMREX_D_TERM(Array4<StagMGReal const> const& phix_f_fab = phi_f[0].array(mfi);,
+                     Array4<StagMGReal const> const& phiy_f_fab = phi_f[1].array(mfi);,
+                     Array4<StagMGReal const> const& phiz_f_fab = phi_f[2].array(mfi););
 
         if (simple_stencil == 0) {
 
@@ -826,7 +1380,7 @@ void StagMGSolver::StagRestriction(std::array< MultiFab, AMREX_SPACEDIM >& phi_c
     }
 }
 
-void StagMGSolver::NodalRestriction(MultiFab& phi_c, const MultiFab& phi_f)
+void StagMGSolver::NodalRestriction(StagMGFab& phi_c, const StagMGFab& phi_f)
 {
     BL_PROFILE_VAR("NodalRestriction()",NodalRestriction);
 
@@ -838,8 +1392,8 @@ void StagMGSolver::NodalRestriction(MultiFab& phi_c, const MultiFab& phi_f)
         // note this is NODAL
         const Box& bx = mfi.tilebox();
 
-        Array4<Real      > const& phi_c_fab = phi_c.array(mfi);
-        Array4<Real const> const& phi_f_fab = phi_f.array(mfi);
+        Array4<StagMGReal      > const& phi_c_fab = phi_c.array(mfi);
+        Array4<StagMGReal const> const& phi_f_fab = phi_f.array(mfi);
 
         amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
         {
@@ -848,8 +1402,8 @@ void StagMGSolver::NodalRestriction(MultiFab& phi_c, const MultiFab& phi_f)
     }
 }
 
-void StagMGSolver::EdgeRestriction(std::array< MultiFab, NUM_EDGE >& phi_c,
-                     const std::array< MultiFab, NUM_EDGE >& phi_f)
+void StagMGSolver::EdgeRestriction(std::array< StagMGFab, NUM_EDGE >& phi_c,
+                     const std::array< StagMGFab, NUM_EDGE >& phi_f)
 {
     BL_PROFILE_VAR("EdgeRestriction()",EdgeRestriction);
 
@@ -868,13 +1422,13 @@ void StagMGSolver::EdgeRestriction(std::array< MultiFab, NUM_EDGE >& phi_c,
 
         const Box& index_bounds = amrex::getIndexBounds(bx_xy, bx_xz, bx_yz);
 
-        Array4<Real> const& phixy_c_fab = phi_c[0].array(mfi);
-        Array4<Real> const& phixz_c_fab = phi_c[1].array(mfi);
-        Array4<Real> const& phiyz_c_fab = phi_c[2].array(mfi);
+        Array4<StagMGReal> const& phixy_c_fab = phi_c[0].array(mfi);
+        Array4<StagMGReal> const& phixz_c_fab = phi_c[1].array(mfi);
+        Array4<StagMGReal> const& phiyz_c_fab = phi_c[2].array(mfi);
 
-        Array4<Real const> const& phixy_f_fab = phi_f[0].array(mfi);
-        Array4<Real const> const& phixz_f_fab = phi_f[1].array(mfi);
-        Array4<Real const> const& phiyz_f_fab = phi_f[2].array(mfi);
+        Array4<StagMGReal const> const& phixy_f_fab = phi_f[0].array(mfi);
+        Array4<StagMGReal const> const& phixz_f_fab = phi_f[1].array(mfi);
+        Array4<StagMGReal const> const& phiyz_f_fab = phi_f[2].array(mfi);
 
         amrex::ParallelFor(bx_xy, bx_xz, bx_yz, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
         {
@@ -891,8 +1445,8 @@ void StagMGSolver::EdgeRestriction(std::array< MultiFab, NUM_EDGE >& phi_c,
     }
 }
 
-void StagMGSolver::StagProlongation(const std::array< MultiFab, AMREX_SPACEDIM >& phi_c_in,
-                                    std::array< MultiFab, AMREX_SPACEDIM >& phi_f_in)
+void StagMGSolver::StagProlongation(const std::array< StagMGFab, AMREX_SPACEDIM >& phi_c_in,
+                                    std::array< StagMGFab, AMREX_SPACEDIM >& phi_f_in)
 {
 
     BL_PROFILE_VAR("StagProlongation()",StagProlongation);
@@ -906,13 +1460,13 @@ void StagMGSolver::StagProlongation(const std::array< MultiFab, AMREX_SPACEDIM >
                      Box bx_y = mfi.tilebox(nodal_flag_y);,
                      Box bx_z = mfi.tilebox(nodal_flag_z););
 
-        AMREX_D_TERM(Array4<Real const> const& phix_c = phi_c_in[0].array(mfi);,
-                     Array4<Real const> const& phiy_c = phi_c_in[1].array(mfi);,
-                     Array4<Real const> const& phiz_c = phi_c_in[2].array(mfi););
+        AMREX_D_TERM(Array4<StagMGReal const> const& phix_c = phi_c_in[0].array(mfi);,
+                     Array4<StagMGReal const> const& phiy_c = phi_c_in[1].array(mfi);,
+                     Array4<StagMGReal const> const& phiz_c = phi_c_in[2].array(mfi););
 
-        AMREX_D_TERM(Array4<Real> const& phix_f = phi_f_in[0].array(mfi);,
-                     Array4<Real> const& phiy_f = phi_f_in[1].array(mfi);,
-                     Array4<Real> const& phiz_f = phi_f_in[2].array(mfi););
+        AMREX_D_TERM(Array4<StagMGReal> const& phix_f = phi_f_in[0].array(mfi);,
+                     Array4<StagMGReal> const& phiy_f = phi_f_in[1].array(mfi);,
+                     Array4<StagMGReal> const& phiz_f = phi_f_in[2].array(mfi););
 
 #if (AMREX_SPACEDIM == 2)
         amrex::ParallelFor(bx_x, bx_y, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
@@ -1049,18 +1603,18 @@ void stag_mg_update_visc_p1 (Box const& tbx,
                              AMREX_D_DECL(Box const& xbx,
                                           Box const& ybx,
                                           Box const& zbx),
-                             AMREX_D_DECL(Array4<Real> const& phix,
-                                          Array4<Real> const& phiy,
-                                          Array4<Real> const& phiz),
-                             AMREX_D_DECL(Array4<Real const> const& rhsx,
-                                          Array4<Real const> const& rhsy,
-                                          Array4<Real const> const& rhsz),
-                             AMREX_D_DECL(Array4<Real const> const& Lpx,
-                                          Array4<Real const> const& Lpy,
-                                          Array4<Real const> const& Lpz),
-                             AMREX_D_DECL(Array4<Real const> const& alphax,
-                                          Array4<Real const> const& alphay,
-                                          Array4<Real const> const& alphaz),
+                             AMREX_D_DECL(Array4<StagMGReal> const& phix,
+                                          Array4<StagMGReal> const& phiy,
+                                          Array4<StagMGReal> const& phiz),
+                             AMREX_D_DECL(Array4<StagMGReal const> const& rhsx,
+                                          Array4<StagMGReal const> const& rhsy,
+                                          Array4<StagMGReal const> const& rhsz),
+                             AMREX_D_DECL(Array4<StagMGReal const> const& Lpx,
+                                          Array4<StagMGReal const> const& Lpy,
+                                          Array4<StagMGReal const> const& Lpz),
+                             AMREX_D_DECL(Array4<StagMGReal const> const& alphax,
+                                          Array4<StagMGReal const> const& alphay,
+                                          Array4<StagMGReal const> const& alphaz),
                              AMREX_D_DECL(bool do_x,
                                           bool do_y,
                                           bool do_z),
@@ -1103,7 +1657,7 @@ void stag_mg_update_visc_p1 (Box const& tbx,
         for (int k = xlo.z; k <= xhi.z; ++k) {
         for (int j = xlo.y; j <= xhi.y; ++j) {
         ioff = 0;
-	if (offset == 2 && (xlo.x+j+k)%2 != (color+1)%2 ) {
+	if (offset == 2 && amrex::Math::abs(xlo.x+j+k)%2 != (color+1)%2 ) {
 	  ioff = 1;
 	}
         AMREX_PRAGMA_SIMD
@@ -1120,7 +1674,7 @@ void stag_mg_update_visc_p1 (Box const& tbx,
         for (int k = ylo.z; k <= yhi.z; ++k) {
         for (int j = ylo.y; j <= yhi.y; ++j) {
         ioff = 0;
-        if (offset == 2 && (ylo.x+j+k)%2 != (color+1)%2 ) {
+        if (offset == 2 && amrex::Math::abs(ylo.x+j+k)%2 != (color+1)%2 ) {
 	  ioff = 1;
 	}
         AMREX_PRAGMA_SIMD
@@ -1138,7 +1692,7 @@ void stag_mg_update_visc_p1 (Box const& tbx,
         for (int k = zlo.z; k <= zhi.z; ++k) {
         for (int j = zlo.y; j <= zhi.y; ++j) {
         ioff = 0;
-        if (offset == 2 && (zlo.x+j+k)%2 != (color+1)%2 ) {
+        if (offset == 2 && amrex::Math::abs(zlo.x+j+k)%2 != (color+1)%2 ) {
 	  ioff = 1;
 	}
         AMREX_PRAGMA_SIMD
@@ -1159,23 +1713,23 @@ void stag_mg_update_visc_m1 (Box const& tbx,
                              AMREX_D_DECL(Box const& xbx,
                                           Box const& ybx,
                                           Box const& zbx),
-                             AMREX_D_DECL(Array4<Real> const& phix,
-                                          Array4<Real> const& phiy,
-                                          Array4<Real> const& phiz),
-                             AMREX_D_DECL(Array4<Real const> const& rhsx,
-                                          Array4<Real const> const& rhsy,
-                                          Array4<Real const> const& rhsz),
-                             AMREX_D_DECL(Array4<Real const> const& Lpx,
-                                          Array4<Real const> const& Lpy,
-                                          Array4<Real const> const& Lpz),
-                             AMREX_D_DECL(Array4<Real const> const& alphax,
-                                          Array4<Real const> const& alphay,
-                                          Array4<Real const> const& alphaz),
-                             Array4<Real const> const& beta,
-                             Array4<Real const> const& beta_xy,
+                             AMREX_D_DECL(Array4<StagMGReal> const& phix,
+                                          Array4<StagMGReal> const& phiy,
+                                          Array4<StagMGReal> const& phiz),
+                             AMREX_D_DECL(Array4<StagMGReal const> const& rhsx,
+                                          Array4<StagMGReal const> const& rhsy,
+                                          Array4<StagMGReal const> const& rhsz),
+                             AMREX_D_DECL(Array4<StagMGReal const> const& Lpx,
+                                          Array4<StagMGReal const> const& Lpy,
+                                          Array4<StagMGReal const> const& Lpz),
+                             AMREX_D_DECL(Array4<StagMGReal const> const& alphax,
+                                          Array4<StagMGReal const> const& alphay,
+                                          Array4<StagMGReal const> const& alphaz),
+                             Array4<StagMGReal const> const& beta,
+                             Array4<StagMGReal const> const& beta_xy,
 #if (AMREX_SPACEDIM == 3)
-                             Array4<Real const> const& beta_xz,
-                             Array4<Real const> const& beta_yz,
+                             Array4<StagMGReal const> const& beta_xz,
+                             Array4<StagMGReal const> const& beta_yz,
 #endif
                              AMREX_D_DECL(bool do_x,
                                           bool do_y,
@@ -1219,7 +1773,7 @@ void stag_mg_update_visc_m1 (Box const& tbx,
         for (int k = xlo.z; k <= xhi.z; ++k) {
         for (int j = xlo.y; j <= xhi.y; ++j) {
         ioff = 0;
-	if (offset == 2 && (xlo.x+j+k)%2 != (color+1)%2 ) {
+	if (offset == 2 && amrex::Math::abs(xlo.x+j+k)%2 != (color+1)%2 ) {
 	  ioff = 1;
 	}
         AMREX_PRAGMA_SIMD
@@ -1244,7 +1798,7 @@ void stag_mg_update_visc_m1 (Box const& tbx,
         for (int k = ylo.z; k <= yhi.z; ++k) {
         for (int j = ylo.y; j <= yhi.y; ++j) {
         ioff = 0;
-        if (offset == 2 && (ylo.x+j+k)%2 != (color+1)%2 ) {
+        if (offset == 2 && amrex::Math::abs(ylo.x+j+k)%2 != (color+1)%2 ) {
 	  ioff = 1;
 	}
         AMREX_PRAGMA_SIMD
@@ -1271,7 +1825,7 @@ void stag_mg_update_visc_m1 (Box const& tbx,
         for (int k = zlo.z; k <= zhi.z; ++k) {
         for (int j = zlo.y; j <= zhi.y; ++j) {
         ioff = 0;
-        if (offset == 2 && (zlo.x+j+k)%2 != (color+1)%2 ) {
+        if (offset == 2 && amrex::Math::abs(zlo.x+j+k)%2 != (color+1)%2 ) {
 	  ioff = 1;
 	}
         AMREX_PRAGMA_SIMD
@@ -1298,18 +1852,18 @@ void stag_mg_update_visc_p2 (Box const& tbx,
                              AMREX_D_DECL(Box const& xbx,
                                           Box const& ybx,
                                           Box const& zbx),
-                             AMREX_D_DECL(Array4<Real> const& phix,
-                                          Array4<Real> const& phiy,
-                                          Array4<Real> const& phiz),
-                             AMREX_D_DECL(Array4<Real const> const& rhsx,
-                                          Array4<Real const> const& rhsy,
-                                          Array4<Real const> const& rhsz),
-                             AMREX_D_DECL(Array4<Real const> const& Lpx,
-                                          Array4<Real const> const& Lpy,
-                                          Array4<Real const> const& Lpz),
-                             AMREX_D_DECL(Array4<Real const> const& alphax,
-                                          Array4<Real const> const& alphay,
-                                          Array4<Real const> const& alphaz),
+                             AMREX_D_DECL(Array4<StagMGReal> const& phix,
+                                          Array4<StagMGReal> const& phiy,
+                                          Array4<StagMGReal> const& phiz),
+                             AMREX_D_DECL(Array4<StagMGReal const> const& rhsx,
+                                          Array4<StagMGReal const> const& rhsy,
+                                          Array4<StagMGReal const> const& rhsz),
+                             AMREX_D_DECL(Array4<StagMGReal const> const& Lpx,
+                                          Array4<StagMGReal const> const& Lpy,
+                                          Array4<StagMGReal const> const& Lpz),
+                             AMREX_D_DECL(Array4<StagMGReal const> const& alphax,
+                                          Array4<StagMGReal const> const& alphay,
+                                          Array4<StagMGReal const> const& alphaz),
                              AMREX_D_DECL(bool do_x,
                                           bool do_y,
                                           bool do_z),
@@ -1352,7 +1906,7 @@ void stag_mg_update_visc_p2 (Box const& tbx,
         for (int k = xlo.z; k <= xhi.z; ++k) {
         for (int j = xlo.y; j <= xhi.y; ++j) {
         ioff = 0;
-	if (offset == 2 && (xlo.x+j+k)%2 != (color+1)%2 ) {
+	if (offset == 2 && amrex::Math::abs(xlo.x+j+k)%2 != (color+1)%2 ) {
 	  ioff = 1;
 	}
         AMREX_PRAGMA_SIMD
@@ -1369,7 +1923,7 @@ void stag_mg_update_visc_p2 (Box const& tbx,
         for (int k = ylo.z; k <= yhi.z; ++k) {
         for (int j = ylo.y; j <= yhi.y; ++j) {
         ioff = 0;
-        if (offset == 2 && (ylo.x+j+k)%2 != (color+1)%2 ) {
+        if (offset == 2 && amrex::Math::abs(ylo.x+j+k)%2 != (color+1)%2 ) {
 	  ioff = 1;
 	}
         AMREX_PRAGMA_SIMD
@@ -1387,7 +1941,7 @@ void stag_mg_update_visc_p2 (Box const& tbx,
         for (int k = zlo.z; k <= zhi.z; ++k) {
         for (int j = zlo.y; j <= zhi.y; ++j) {
         ioff = 0;
-        if (offset == 2 && (zlo.x+j+k)%2 != (color+1)%2 ) {
+        if (offset == 2 && amrex::Math::abs(zlo.x+j+k)%2 != (color+1)%2 ) {
 	  ioff = 1;
 	}
         AMREX_PRAGMA_SIMD
@@ -1408,23 +1962,23 @@ void stag_mg_update_visc_m2 (Box const& tbx,
                              AMREX_D_DECL(Box const& xbx,
                                           Box const& ybx,
                                           Box const& zbx),
-                             AMREX_D_DECL(Array4<Real> const& phix,
-                                          Array4<Real> const& phiy,
-                                          Array4<Real> const& phiz),
-                             AMREX_D_DECL(Array4<Real const> const& rhsx,
-                                          Array4<Real const> const& rhsy,
-                                          Array4<Real const> const& rhsz),
-                             AMREX_D_DECL(Array4<Real const> const& Lpx,
-                                          Array4<Real const> const& Lpy,
-                                          Array4<Real const> const& Lpz),
-                             AMREX_D_DECL(Array4<Real const> const& alphax,
-                                          Array4<Real const> const& alphay,
-                                          Array4<Real const> const& alphaz),
-                             Array4<Real const> const& beta,
-                             Array4<Real const> const& beta_xy,
+                             AMREX_D_DECL(Array4<StagMGReal> const& phix,
+                                          Array4<StagMGReal> const& phiy,
+                                          Array4<StagMGReal> const& phiz),
+                             AMREX_D_DECL(Array4<StagMGReal const> const& rhsx,
+                                          Array4<StagMGReal const> const& rhsy,
+                                          Array4<StagMGReal const> const& rhsz),
+                             AMREX_D_DECL(Array4<StagMGReal const> const& Lpx,
+                                          Array4<StagMGReal const> const& Lpy,
+                                          Array4<StagMGReal const> const& Lpz),
+                             AMREX_D_DECL(Array4<StagMGReal const> const& alphax,
+                                          Array4<StagMGReal const> const& alphay,
+                                          Array4<StagMGReal const> const& alphaz),
+                             Array4<StagMGReal const> const& beta,
+                             Array4<StagMGReal const> const& beta_xy,
 #if (AMREX_SPACEDIM == 3)
-                             Array4<Real const> const& beta_xz,
-                             Array4<Real const> const& beta_yz,
+                             Array4<StagMGReal const> const& beta_xz,
+                             Array4<StagMGReal const> const& beta_yz,
 #endif
                              AMREX_D_DECL(bool do_x,
                                           bool do_y,
@@ -1468,7 +2022,7 @@ void stag_mg_update_visc_m2 (Box const& tbx,
         for (int k = xlo.z; k <= xhi.z; ++k) {
         for (int j = xlo.y; j <= xhi.y; ++j) {
         ioff = 0;
-	if (offset == 2 && (xlo.x+j+k)%2 != (color+1)%2 ) {
+	if (offset == 2 && amrex::Math::abs(xlo.x+j+k)%2 != (color+1)%2 ) {
 	  ioff = 1;
 	}
         AMREX_PRAGMA_SIMD
@@ -1491,7 +2045,7 @@ void stag_mg_update_visc_m2 (Box const& tbx,
         for (int k = ylo.z; k <= yhi.z; ++k) {
         for (int j = ylo.y; j <= yhi.y; ++j) {
         ioff = 0;
-        if (offset == 2 && (ylo.x+j+k)%2 != (color+1)%2 ) {
+        if (offset == 2 && amrex::Math::abs(ylo.x+j+k)%2 != (color+1)%2 ) {
 	  ioff = 1;
 	}
         AMREX_PRAGMA_SIMD
@@ -1515,7 +2069,7 @@ void stag_mg_update_visc_m2 (Box const& tbx,
         for (int k = zlo.z; k <= zhi.z; ++k) {
         for (int j = zlo.y; j <= zhi.y; ++j) {
         ioff = 0;
-        if (offset == 2 && (zlo.x+j+k)%2 != (color+1)%2 ) {
+        if (offset == 2 && amrex::Math::abs(zlo.x+j+k)%2 != (color+1)%2 ) {
 	  ioff = 1;
 	}
         AMREX_PRAGMA_SIMD
@@ -1539,18 +2093,18 @@ void stag_mg_update_visc_p3 (Box const& tbx,
                              AMREX_D_DECL(Box const& xbx,
                                           Box const& ybx,
                                           Box const& zbx),
-                             AMREX_D_DECL(Array4<Real> const& phix,
-                                          Array4<Real> const& phiy,
-                                          Array4<Real> const& phiz),
-                             AMREX_D_DECL(Array4<Real const> const& rhsx,
-                                          Array4<Real const> const& rhsy,
-                                          Array4<Real const> const& rhsz),
-                             AMREX_D_DECL(Array4<Real const> const& Lpx,
-                                          Array4<Real const> const& Lpy,
-                                          Array4<Real const> const& Lpz),
-                             AMREX_D_DECL(Array4<Real const> const& alphax,
-                                          Array4<Real const> const& alphay,
-                                          Array4<Real const> const& alphaz),
+                             AMREX_D_DECL(Array4<StagMGReal> const& phix,
+                                          Array4<StagMGReal> const& phiy,
+                                          Array4<StagMGReal> const& phiz),
+                             AMREX_D_DECL(Array4<StagMGReal const> const& rhsx,
+                                          Array4<StagMGReal const> const& rhsy,
+                                          Array4<StagMGReal const> const& rhsz),
+                             AMREX_D_DECL(Array4<StagMGReal const> const& Lpx,
+                                          Array4<StagMGReal const> const& Lpy,
+                                          Array4<StagMGReal const> const& Lpz),
+                             AMREX_D_DECL(Array4<StagMGReal const> const& alphax,
+                                          Array4<StagMGReal const> const& alphay,
+                                          Array4<StagMGReal const> const& alphaz),
                              AMREX_D_DECL(bool do_x,
                                           bool do_y,
                                           bool do_z),
@@ -1594,7 +2148,7 @@ void stag_mg_update_visc_p3 (Box const& tbx,
         for (int k = xlo.z; k <= xhi.z; ++k) {
         for (int j = xlo.y; j <= xhi.y; ++j) {
         ioff = 0;
-	if (offset == 2 && (xlo.x+j+k)%2 != (color+1)%2 ) {
+	if (offset == 2 && amrex::Math::abs(xlo.x+j+k)%2 != (color+1)%2 ) {
 	  ioff = 1;
 	}
         AMREX_PRAGMA_SIMD
@@ -1611,7 +2165,7 @@ void stag_mg_update_visc_p3 (Box const& tbx,
         for (int k = ylo.z; k <= yhi.z; ++k) {
         for (int j = ylo.y; j <= yhi.y; ++j) {
         ioff = 0;
-        if (offset == 2 && (ylo.x+j+k)%2 != (color+1)%2 ) {
+        if (offset == 2 && amrex::Math::abs(ylo.x+j+k)%2 != (color+1)%2 ) {
 	  ioff = 1;
 	}
         AMREX_PRAGMA_SIMD
@@ -1629,7 +2183,7 @@ void stag_mg_update_visc_p3 (Box const& tbx,
         for (int k = zlo.z; k <= zhi.z; ++k) {
         for (int j = zlo.y; j <= zhi.y; ++j) {
         ioff = 0;
-        if (offset == 2 && (zlo.x+j+k)%2 != (color+1)%2 ) {
+        if (offset == 2 && amrex::Math::abs(zlo.x+j+k)%2 != (color+1)%2 ) {
 	  ioff = 1;
 	}
         AMREX_PRAGMA_SIMD
@@ -1650,25 +2204,25 @@ void stag_mg_update_visc_m3 (Box const& tbx,
                              AMREX_D_DECL(Box const& xbx,
                                           Box const& ybx,
                                           Box const& zbx),
-                             AMREX_D_DECL(Array4<Real> const& phix,
-                                          Array4<Real> const& phiy,
-                                          Array4<Real> const& phiz),
-                             AMREX_D_DECL(Array4<Real const> const& rhsx,
-                                          Array4<Real const> const& rhsy,
-                                          Array4<Real const> const& rhsz),
-                             AMREX_D_DECL(Array4<Real const> const& Lpx,
-                                          Array4<Real const> const& Lpy,
-                                          Array4<Real const> const& Lpz),
-                             AMREX_D_DECL(Array4<Real const> const& alphax,
-                                          Array4<Real const> const& alphay,
-                                          Array4<Real const> const& alphaz),
-                             Array4<Real const> const& beta,
-                             Array4<Real const> const& beta_xy,
+                             AMREX_D_DECL(Array4<StagMGReal> const& phix,
+                                          Array4<StagMGReal> const& phiy,
+                                          Array4<StagMGReal> const& phiz),
+                             AMREX_D_DECL(Array4<StagMGReal const> const& rhsx,
+                                          Array4<StagMGReal const> const& rhsy,
+                                          Array4<StagMGReal const> const& rhsz),
+                             AMREX_D_DECL(Array4<StagMGReal const> const& Lpx,
+                                          Array4<StagMGReal const> const& Lpy,
+                                          Array4<StagMGReal const> const& Lpz),
+                             AMREX_D_DECL(Array4<StagMGReal const> const& alphax,
+                                          Array4<StagMGReal const> const& alphay,
+                                          Array4<StagMGReal const> const& alphaz),
+                             Array4<StagMGReal const> const& beta,
+                             Array4<StagMGReal const> const& beta_xy,
 #if (AMREX_SPACEDIM == 3)
-                             Array4<Real const> const& beta_xz,
-                             Array4<Real const> const& beta_yz,
+                             Array4<StagMGReal const> const& beta_xz,
+                             Array4<StagMGReal const> const& beta_yz,
 #endif
-                             Array4<Real const> const& gamma,
+                             Array4<StagMGReal const> const& gamma,
                              AMREX_D_DECL(bool do_x,
                                           bool do_y,
                                           bool do_z),
@@ -1712,7 +2266,7 @@ void stag_mg_update_visc_m3 (Box const& tbx,
         for (int k = xlo.z; k <= xhi.z; ++k) {
         for (int j = xlo.y; j <= xhi.y; ++j) {
         ioff = 0;
-	if (offset == 2 && (xlo.x+j+k)%2 != (color+1)%2 ) {
+	if (offset == 2 && amrex::Math::abs(xlo.x+j+k)%2 != (color+1)%2 ) {
 	  ioff = 1;
 	}
         AMREX_PRAGMA_SIMD
@@ -1738,7 +2292,7 @@ void stag_mg_update_visc_m3 (Box const& tbx,
         for (int k = ylo.z; k <= yhi.z; ++k) {
         for (int j = ylo.y; j <= yhi.y; ++j) {
         ioff = 0;
-        if (offset == 2 && (ylo.x+j+k)%2 != (color+1)%2 ) {
+        if (offset == 2 && amrex::Math::abs(ylo.x+j+k)%2 != (color+1)%2 ) {
 	  ioff = 1;
 	}
         AMREX_PRAGMA_SIMD
@@ -1765,7 +2319,7 @@ void stag_mg_update_visc_m3 (Box const& tbx,
         for (int k = zlo.z; k <= zhi.z; ++k) {
         for (int j = zlo.y; j <= zhi.y; ++j) {
         ioff = 0;
-        if (offset == 2 && (zlo.x+j+k)%2 != (color+1)%2 ) {
+        if (offset == 2 && amrex::Math::abs(zlo.x+j+k)%2 != (color+1)%2 ) {
 	  ioff = 1;
 	}
         AMREX_PRAGMA_SIMD
@@ -1786,15 +2340,17 @@ void stag_mg_update_visc_m3 (Box const& tbx,
 
 }
 
-void StagMGSolver::StagMGUpdate (std::array< MultiFab, AMREX_SPACEDIM >& phi_fc,
-                                 const std::array< MultiFab, AMREX_SPACEDIM >& rhs_fc,
-                                 const std::array< MultiFab, AMREX_SPACEDIM >& Lphi_fc,
-                                 const std::array< MultiFab, AMREX_SPACEDIM >& alpha_fc,
-                                 const MultiFab& beta_cc,
-                                 const std::array< MultiFab, NUM_EDGE >& beta_ed,
-                                 const MultiFab& gamma_cc,
+void StagMGSolver::StagMGUpdate (std::array< StagMGFab, AMREX_SPACEDIM >& phi_fc,
+                                 const std::array< StagMGFab, AMREX_SPACEDIM >& rhs_fc,
+                                 const std::array< StagMGFab, AMREX_SPACEDIM >& Lphi_fc,
+                                 const std::array< StagMGFab, AMREX_SPACEDIM >& alpha_fc,
+                                 const StagMGFab& beta_cc,
+                                 const std::array< StagMGFab, NUM_EDGE >& beta_ed,
+                                 const StagMGFab& gamma_cc,
                                  const Real* dx,
-                                 const int& color)
+                                 const Geometry& geom,
+                                 const int& color,
+                                 const int& ngrow)
 {
     BL_PROFILE_VAR("StagMGUpdate()",StagMGUpdate);
 
@@ -1834,40 +2390,53 @@ void StagMGSolver::StagMGUpdate (std::array< MultiFab, AMREX_SPACEDIM >& phi_fc,
 
     GpuArray<Real,AMREX_SPACEDIM> dx_gpu{AMREX_D_DECL(dx[0], dx[1], dx[2])};
 
+    // faces of the problem domain, including ngrow ghost faces in periodic
+    // directions (as in StagApplyOp)
+    std::array<Box, AMREX_SPACEDIM> face_dom;
+    for (int d=0; d<AMREX_SPACEDIM; ++d) {
+        face_dom[d] = convert(geom.Domain(), nodal_flag_dir[d]);
+        for (int i=0; i<AMREX_SPACEDIM; ++i) {
+            if (geom.isPeriodic(i)) {
+                face_dom[d].grow(i,ngrow);
+            }
+        }
+    }
+
     // loop over boxes (make sure mfi takes a cell-centered multifab as an argument)
     for ( MFIter mfi(beta_cc,TilingIfNotGPU()); mfi.isValid(); ++mfi ) {
 
         // Get the index space of the valid region
         const Box& bx = mfi.tilebox();
 
-        AMREX_D_TERM(Array4<Real> const& phix_fab = phi_fc[0].array(mfi);,
-                     Array4<Real> const& phiy_fab = phi_fc[1].array(mfi);,
-                     Array4<Real> const& phiz_fab = phi_fc[2].array(mfi););
+        AMREX_D_TERM(Array4<StagMGReal> const& phix_fab = phi_fc[0].array(mfi);,
+                     Array4<StagMGReal> const& phiy_fab = phi_fc[1].array(mfi);,
+                     Array4<StagMGReal> const& phiz_fab = phi_fc[2].array(mfi););
 
-        AMREX_D_TERM(Array4<Real const> const& rhsx_fab = rhs_fc[0].array(mfi);,
-                     Array4<Real const> const& rhsy_fab = rhs_fc[1].array(mfi);,
-                     Array4<Real const> const& rhsz_fab = rhs_fc[2].array(mfi););
+        AMREX_D_TERM(Array4<StagMGReal const> const& rhsx_fab = rhs_fc[0].array(mfi);,
+                     Array4<StagMGReal const> const& rhsy_fab = rhs_fc[1].array(mfi);,
+                     Array4<StagMGReal const> const& rhsz_fab = rhs_fc[2].array(mfi););
 
-        AMREX_D_TERM(Array4<Real const> const& Lphix_fab = Lphi_fc[0].array(mfi);,
-                     Array4<Real const> const& Lphiy_fab = Lphi_fc[1].array(mfi);,
-                     Array4<Real const> const& Lphiz_fab = Lphi_fc[2].array(mfi););
+        AMREX_D_TERM(Array4<StagMGReal const> const& Lphix_fab = Lphi_fc[0].array(mfi);,
+                     Array4<StagMGReal const> const& Lphiy_fab = Lphi_fc[1].array(mfi);,
+                     Array4<StagMGReal const> const& Lphiz_fab = Lphi_fc[2].array(mfi););
 
-        AMREX_D_TERM(Array4<Real const> const& alphax_fab = alpha_fc[0].array(mfi);,
-                     Array4<Real const> const& alphay_fab = alpha_fc[1].array(mfi);,
-                     Array4<Real const> const& alphaz_fab = alpha_fc[2].array(mfi););
+        AMREX_D_TERM(Array4<StagMGReal const> const& alphax_fab = alpha_fc[0].array(mfi);,
+                     Array4<StagMGReal const> const& alphay_fab = alpha_fc[1].array(mfi);,
+                     Array4<StagMGReal const> const& alphaz_fab = alpha_fc[2].array(mfi););
 
-        Array4<Real const> const& beta_cc_fab = beta_cc.array(mfi);
-        Array4<Real const> const& gamma_cc_fab = gamma_cc.array(mfi);
+        Array4<StagMGReal const> const& beta_cc_fab = beta_cc.array(mfi);
+        Array4<StagMGReal const> const& gamma_cc_fab = gamma_cc.array(mfi);
 
-        Array4<Real const> const& beta_xy_fab = beta_ed[0].array(mfi);
+        Array4<StagMGReal const> const& beta_xy_fab = beta_ed[0].array(mfi);
 #if (AMREX_SPACEDIM == 3)
-        Array4<Real const> const& beta_xz_fab = beta_ed[1].array(mfi);
-        Array4<Real const> const& beta_yz_fab = beta_ed[2].array(mfi);
+        Array4<StagMGReal const> const& beta_xz_fab = beta_ed[1].array(mfi);
+        Array4<StagMGReal const> const& beta_yz_fab = beta_ed[2].array(mfi);
 #endif
 
-        AMREX_D_TERM(const Box& bx_x = mfi.nodaltilebox(0);,
-                     const Box& bx_y = mfi.nodaltilebox(1);,
-                     const Box& bx_z = mfi.nodaltilebox(2););
+        // face boxes, grown by ngrow ghost faces
+        AMREX_D_TERM(const Box& bx_x = mfi.grownnodaltilebox(0,ngrow) & face_dom[0];,
+                     const Box& bx_y = mfi.grownnodaltilebox(1,ngrow) & face_dom[1];,
+                     const Box& bx_z = mfi.grownnodaltilebox(2,ngrow) & face_dom[2];);
 
         const Box& index_bounds = amrex::getIndexBounds(AMREX_D_DECL(bx_x,bx_y,bx_z));
 
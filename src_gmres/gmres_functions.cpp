@@ -47,13 +47,21 @@ void InitializeGmresNamespace() {
     stag_mg_minwidth = 2;            // length of box at coarsest multigrid level
     stag_mg_bottom_solver = 0;       // bottom solver type
     // 0 = smooths only, controlled by mg_nsmooths_bottom
+    // 1 = conjugate gradient on the coarsest level
+    // 4 = agglomerate the coarsest level onto a single grid and continue
+    //     coarsening there, finishing with conjugate gradient
     stag_mg_nsmooths_down = 2;       // number of smooths at each level on the way down
     stag_mg_nsmooths_up = 2;         // number of smooths at each level on the way up
     stag_mg_nsmooths_bottom = 8;     // number of smooths at the bottom
     stag_mg_max_bottom_nlevels = 10; // for stag_mg_bottom_solver 4, number of additional levels of multigrid
     stag_mg_omega = 1.;              // weightee-jacobi omega coefficient
     stag_mg_smoother = 1;            // 0 = jacobi; 1 = 2*dm-color Gauss-Seidel
+    stag_mg_nghost = 1;              // ghost faces of the multigrid solution; the smoother exchanges them
+                                     // once every stag_mg_nghost colors and recomputes the overlap locally
+                                     // in between (1 = exchange after every color)
     stag_mg_rel_tol = 1.e-9;         // relative tolerance stopping criteria
+    stag_mg_bottom_rel_tol = 1.e-4;  // for stag_mg_bottom_solver 1 and 4, conjugate gradient relative tolerance
+    stag_mg_bottom_max_iter = 100;   // for stag_mg_bottom_solver 1 and 4, max number of conjugate gradient iterations
 
     // GMRES solver parameters
     gmres_rel_tol = 1.e-9;     // relative tolerance stopping criteria
@@ -64,6 +72,21 @@ void InitializeGmresNamespace() {
     gmres_max_iter = 100;      // max number of gmres iterations
     gmres_min_iter = 1;        // min number of gmres iterations
 
+    // orthogonalization of the Krylov basis
+    // 0 = classical Gram-Schmidt, one global reduction per basis vector
+    // 1 = CGS2, all inner products of a pass in one global reduction
+    gmres_orth_type = 0;
+
+    // keep alphainv_fc, the scaled coefficients and the multigrid coefficient
+    // hierarchies between calls to GMRES::Solve while the coefficients are unchanged
+    gmres_cache_coefs = 0;
+
+    // use the previous solution of the same GMRES object as the initial guess
+    gmres_warm_start = 0;
+
+    // number of recycled Krylov directions kept between calls (GCRO-style); 0 = off
+    gmres_recycle_dim = 0;
+
     gmres_spatial_order = 2;   // spatial order of viscous and gradient operators in matrix "A"
 
     ParmParse pp;
@@ -97,7 +120,10 @@ void InitializeGmresNamespace() {
     pp.query("stag_mg_max_bottom_nlevels",stag_mg_max_bottom_nlevels);
     pp.query("stag_mg_omega",stag_mg_omega);
     pp.query("stag_mg_smoother",stag_mg_smoother);
+    pp.query("stag_mg_nghost",stag_mg_nghost);
     pp.query("stag_mg_rel_tol",stag_mg_rel_tol);
+    pp.query("stag_mg_bottom_rel_tol",stag_mg_bottom_rel_tol);
+    pp.query("stag_mg_bottom_max_iter",stag_mg_bottom_max_iter);
     pp.query("gmres_rel_tol",gmres_rel_tol);
     pp.query("gmres_abs_tol",gmres_abs_tol);
     pp.query("gmres_verbose",gmres_verbose);
@@ -105,6 +131,10 @@ void InitializeGmresNamespace() {
     pp.query("gmres_max_inner",gmres_max_inner);
     pp.query("gmres_max_iter",gmres_max_iter);
     pp.query("gmres_min_iter",gmres_min_iter);
+    pp.query("gmres_orth_type",gmres_orth_type);
+    pp.query("gmres_cache_coefs",gmres_cache_coefs);
+    pp.query("gmres_warm_start",gmres_warm_start);
+    pp.query("gmres_recycle_dim",gmres_recycle_dim);
     pp.query("gmres_spatial_order",gmres_spatial_order);
 
 }
@@ -7,6 +7,102 @@
 #include <AMReX_MultiFabUtil.H>
 #include <AMReX_VisMF.H>
 
+// index space of one noise field for the fused (counter_rng=1) path
+struct NoiseDomain {
+    GpuArray<int,3> lo, hi, len, per;
+    // multiplier for samples on a lo/hi wall
+    GpuArray<Real,3> flo, fhi;
+};
+
+// Philox keys and weights of the random number stages
+struct NoiseStages {
+    const Real* wgt;
+    const uint32_t* key1;
+    int nstage;
+    uint32_t key0;
+};
+
+static NoiseDomain MakeNoiseDomain(const Geometry& geom, const IndexType& ixt, const int& walls)
+{
+    NoiseDomain nd;
+    const Box& dom = amrex::convert(geom.Domain(), ixt);
+
+    for (int d=0; d<3; ++d) {
+        nd.lo[d] = 0;
+        nd.hi[d] = 0;
+        nd.len[d] = 1;
+        nd.per[d] = 0;
+        nd.flo[d] = 1.;
+        nd.fhi[d] = 1.;
+    }
+
+    for (int d=0; d<AMREX_SPACEDIM; ++d) {
+        nd.lo[d] = dom.smallEnd(d);
+        nd.hi[d] = dom.bigEnd(d);
+        nd.len[d] = geom.Domain().length(d);
+        nd.per[d] = geom.isPeriodic(d);
+
+        // same wall treatment as MomFluxBC, for fluxes lying on the wall
+        // 1 = slip wall   : multiply fluxes on wall by 0
+        // 2 = no-slip wall: multiply fluxes on wall by sqrt(2)
+        if (walls && ixt.nodeCentered(d)) {
+            if (bc_vel_lo[d] == 1 || bc_vel_lo[d] == 2) {
+                nd.flo[d] = (bc_vel_lo[d] == 1) ? 0. : sqrt(2.);
+            }
+            else if (bc_vel_lo[d] != -1) {
+                Abort("MomFluxBC unsupported bc type");
+            }
+            if (bc_vel_hi[d] == 1 || bc_vel_hi[d] == 2) {
+                nd.fhi[d] = (bc_vel_hi[d] == 1) ? 0. : sqrt(2.);
+            }
+            else if (bc_vel_hi[d] != -1) {
+                Abort("MomFluxBC unsupported bc type");
+            }
+        }
+    }
+
+    return nd;
+}
+
+// weighted sum over stages of the noise at (i,j,k), including the wall factor;
+// periodic copies use the valid index they duplicate and samples outside a
+// non-periodic boundary are zero
+AMREX_GPU_DEVICE AMREX_FORCE_INLINE
+Real StageNoise(int i, int j, int k, const int comp,
+                const NoiseDomain& nd, const NoiseStages& ns) noexcept
+{
+    int idx[3] = {i,j,k};
+    Real factor = 1.;
+
+    for (int d=0; d<3; ++d) {
+        if (nd.per[d]) {
+            idx[d] = nd.lo[d] + ((idx[d]-nd.lo[d])%nd.len[d] + nd.len[d])%nd.len[d];
+        } else if (idx[d] < nd.lo[d] || idx[d] > nd.hi[d]) {
+            return 0.;
+        } else if (idx[d] == nd.lo[d]) {
+            factor *= nd.flo[d];
+        } else if (idx[d] == nd.hi[d]) {
+            factor *= nd.fhi[d];
+        }
+    }
+
+    Real sum = 0.;
+    for (int s=0; s<ns.nstage; ++s) {
+        sum += ns.wgt[s]*PhiloxNormal(idx[0],idx[1],idx[2],comp,ns.key0,ns.key1[s]);
+    }
+    return factor*sum;
+}
+
+// one stochastic flux: scale*sqrt(eta*temperature)*noise
+AMREX_GPU_DEVICE AMREX_FORCE_INLINE
+Real FusedFlux(int i, int j, int k, const int comp,
+               const NoiseDomain& nd, const NoiseStages& ns, const Real scale,
+               const Array4<Real const>& eta, const Array4<Real const>& temp) noexcept
+{
+    const Real noise = StageNoise(i,j,k,comp,nd,ns);
+    return (noise == 0.) ? 0. : scale*sqrt(eta(i,j,k)*temp(i,j,k))*noise;
+}
+
 // initialize n_rngs, geom
 // build MultiFabs to hold random numbers
 StochMomFlux::StochMomFlux(BoxArray ba_in, DistributionMapping dmap_in, Geometry geom_in,
@@ -24,6 +120,13 @@ StochMomFlux::StochMomFlux(BoxArray ba_in, DistributionMapping dmap_in, Geometry
     // keep a local geometry object so we won't always have to pass one in
     geom = geom_in;
 
+    if (counter_rng == 1) {
+        // the noise is generated inside StochMomFluxDiv; nothing is stored
+        fused = 1;
+        stage_key1.resize(n_rngs);
+        return;
+    }
+
     // resize these to hold the number of RNG stages
     mflux_cc.resize(n_rngs);
     mflux_ed.resize(n_rngs);
@@ -77,6 +180,13 @@ void StochMomFlux::fillMomStochastic() {
     
     BL_PROFILE_VAR("fillMomStochastic()",StochMomFlux);
 
+    if (fused) {
+        for (int i=0; i<n_rngs; ++i) {
+            CounterRNGKey(stage_key0, stage_key1[i]);
+        }
+        return;
+    }
+
     for (int i=0; i<n_rngs; ++i) {
 
         switch(stoch_stress_form) {
@@ -683,6 +793,11 @@ void StochMomFlux::StochMomFluxDiv(std::array< MultiFab, AMREX_SPACEDIM >& m_for
 
     BL_PROFILE_VAR("StochMomFluxDiv()",StochMomFluxDiv);
 
+    if (fused) {
+        StochMomFluxDivFused(m_force,increment,eta_cc,eta_ed,temp_cc,temp_ed,weights,dt);
+        return;
+    }
+
     // Take linear combination of mflux multifabs at each stage
     StochMomFlux::weightMomflux(weights);
 
@@ -816,6 +931,200 @@ void StochMomFlux::StochMomFluxDiv(std::array< MultiFab, AMREX_SPACEDIM >& m_for
     }
 }
 
+// compute stochastic momentum flux divergence with the noise generated in
+// the kernel: stage weights, variance*sqrt(eta*temperature) and the wall
+// factors of MomFluxBC are applied to each flux as it is read, so no
+// flux MultiFabs and no communication are needed
+void StochMomFlux::StochMomFluxDivFused(std::array< MultiFab, AMREX_SPACEDIM >& m_force,
+                                        const int& increment,
+                                        const MultiFab& eta_cc,
+                                        const std::array< MultiFab, NUM_EDGE >& eta_ed,
+                                        const MultiFab& temp_cc,
+                                        const std::array< MultiFab, NUM_EDGE >& temp_ed,
+                                        const Vector< amrex::Real >& weights,
+                                        const amrex::Real& dt) {
+
+    BL_PROFILE_VAR("StochMomFluxDivFused()",StochMomFluxDivFused);
+
+    const Real* dx = geom.CellSize();
+    Real dVol = (AMREX_SPACEDIM==2) ? dx[0]*dx[1]*cell_depth : dx[0]*dx[1]*dx[2];
+
+    // Compute variance using computed differential volume
+    Real variance = sqrt(variance_coef_mom*2.0*k_B/(dVol*dt));
+
+    // see fillMomStochastic for the variance of each stored component;
+    // in the symmetric form both edge components share one sample
+    const int sym = (stoch_stress_form != 0);
+    const Real scale_cc = sym ? variance*sqrt(2.) : variance;
+    const Real scale_ed = variance;
+
+    Gpu::DeviceVector<Real> wgt_d(n_rngs);
+    Gpu::DeviceVector<uint32_t> key_d(n_rngs);
+    Gpu::copy(Gpu::hostToDevice, weights.begin(), weights.begin()+n_rngs, wgt_d.begin());
+    Gpu::copy(Gpu::hostToDevice, stage_key1.begin(), stage_key1.end(), key_d.begin());
+
+    NoiseStages ns;
+    ns.wgt = wgt_d.dataPtr();
+    ns.key1 = key_d.dataPtr();
+    ns.nstage = n_rngs;
+    ns.key0 = stage_key0;
+
+    // counter component of each flux: cell-centered fluxes use 0..AMREX_SPACEDIM-1,
+    // edge d component n uses AMREX_SPACEDIM+2*d+n
+    const NoiseDomain nd_cc = MakeNoiseDomain(geom, IndexType::TheCellType(), 0);
+#if (AMREX_SPACEDIM == 2)
+    const NoiseDomain nd_nd = MakeNoiseDomain(geom, eta_ed[0].ixType(), 1);
+    const int c_nd0 = AMREX_SPACEDIM;
+    const int c_nd1 = AMREX_SPACEDIM + (sym ? 0 : 1);
+#elif (AMREX_SPACEDIM == 3)
+    const NoiseDomain nd_xy = MakeNoiseDomain(geom, eta_ed[0].ixType(), 1);
+    const NoiseDomain nd_xz = MakeNoiseDomain(geom, eta_ed[1].ixType(), 1);
+    const NoiseDomain nd_yz = MakeNoiseDomain(geom, eta_ed[2].ixType(), 1);
+    const int c_xy0 = AMREX_SPACEDIM;
+    const int c_xy1 = AMREX_SPACEDIM + (sym ? 0 : 1);
+    const int c_xz0 = AMREX_SPACEDIM + 2;
+    const int c_xz1 = AMREX_SPACEDIM + 2 + (sym ? 0 : 1);
+    const int c_yz0 = AMREX_SPACEDIM + 4;
+    const int c_yz1 = AMREX_SPACEDIM + 4 + (sym ? 0 : 1);
+#endif
+
+    const bool add = (increment == 1);
+
+    // calculate divergence and add to stoch_m_force
+    Real dxinv = 1./(geom.CellSize()[0]);
+
+    // Loop over boxes
+    for (MFIter mfi(eta_cc,TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+
+        const Array4<Real const> & eta_cc_fab = eta_cc.array(mfi);
+        const Array4<Real const> & temp_cc_fab = temp_cc.array(mfi);
+#if (AMREX_SPACEDIM == 2)
+        const Array4<Real const> & eta_nd_fab = eta_ed[0].array(mfi);
+        const Array4<Real const> & temp_nd_fab = temp_ed[0].array(mfi);
+#elif (AMREX_SPACEDIM == 3)
+        const Array4<Real const> & eta_xy_fab = eta_ed[0].array(mfi);
+        const Array4<Real const> & eta_xz_fab = eta_ed[1].array(mfi);
+        const Array4<Real const> & eta_yz_fab = eta_ed[2].array(mfi);
+        const Array4<Real const> & temp_xy_fab = temp_ed[0].array(mfi);
+        const Array4<Real const> & temp_xz_fab = temp_ed[1].array(mfi);
+        const Array4<Real const> & temp_yz_fab = temp_ed[2].array(mfi);
+#endif
+
+        AMREX_D_TERM(const Array4<Real> & divx = m_force[0].array(mfi);,
+                     const Array4<Real> & divy = m_force[1].array(mfi);,
+                     const Array4<Real> & divz = m_force[2].array(mfi););
+
+        AMREX_D_TERM(const Box & bx_x = mfi.nodaltilebox(0);,
+                     const Box & bx_y = mfi.nodaltilebox(1);,
+                     const Box & bx_z = mfi.nodaltilebox(2););
+
+#if (AMREX_SPACEDIM == 2)
+        amrex::ParallelFor(bx_x,bx_y,
+                           [=] AMREX_GPU_DEVICE (int i, int j, int k)
+        {
+            Real div = (FusedFlux(i  ,j  ,k,0,nd_cc,ns,scale_cc,eta_cc_fab,temp_cc_fab) -
+                        FusedFlux(i-1,j  ,k,0,nd_cc,ns,scale_cc,eta_cc_fab,temp_cc_fab) +
+                        FusedFlux(i  ,j+1,k,c_nd0,nd_nd,ns,scale_ed,eta_nd_fab,temp_nd_fab) -
+                        FusedFlux(i  ,j  ,k,c_nd0,nd_nd,ns,scale_ed,eta_nd_fab,temp_nd_fab)) * dxinv;
+            divx(i,j,k) = add ? divx(i,j,k) + div : div;
+        },
+                           [=] AMREX_GPU_DEVICE (int i, int j, int k)
+        {
+            Real div = (FusedFlux(i+1,j  ,k,c_nd1,nd_nd,ns,scale_ed,eta_nd_fab,temp_nd_fab) -
+                        FusedFlux(i  ,j  ,k,c_nd1,nd_nd,ns,scale_ed,eta_nd_fab,temp_nd_fab) +
+                        FusedFlux(i  ,j  ,k,1,nd_cc,ns,scale_cc,eta_cc_fab,temp_cc_fab) -
+                        FusedFlux(i  ,j-1,k,1,nd_cc,ns,scale_cc,eta_cc_fab,temp_cc_fab)) * dxinv;
+            divy(i,j,k) = add ? divy(i,j,k) + div : div;
+        });
+#elif (AMREX_SPACEDIM == 3)
+        amrex::ParallelFor(bx_x,bx_y,bx_z,
+                           [=] AMREX_GPU_DEVICE (int i, int j, int k)
+        {
+            Real div = (FusedFlux(i  ,j  ,k  ,0,nd_cc,ns,scale_cc,eta_cc_fab,temp_cc_fab) -
+                        FusedFlux(i-1,j  ,k  ,0,nd_cc,ns,scale_cc,eta_cc_fab,temp_cc_fab) +
+                        FusedFlux(i  ,j+1,k  ,c_xy0,nd_xy,ns,scale_ed,eta_xy_fab,temp_xy_fab) -
+                        FusedFlux(i  ,j  ,k  ,c_xy0,nd_xy,ns,scale_ed,eta_xy_fab,temp_xy_fab) +
+                        FusedFlux(i  ,j  ,k+1,c_xz0,nd_xz,ns,scale_ed,eta_xz_fab,temp_xz_fab) -
+                        FusedFlux(i  ,j  ,k  ,c_xz0,nd_xz,ns,scale_ed,eta_xz_fab,temp_xz_fab)) * dxinv;
+            divx(i,j,k) = add ? divx(i,j,k) + div : div;
+        },
+                           [=] AMREX_GPU_DEVICE (int i, int j, int k)
+        {
+            Real div = (FusedFlux(i+1,j  ,k  ,c_xy1,nd_xy,ns,scale_ed,eta_xy_fab,temp_xy_fab) -
+                        FusedFlux(i  ,j  ,k  ,c_xy1,nd_xy,ns,scale_ed,eta_xy_fab,temp_xy_fab) +
+                        FusedFlux(i  ,j  ,k  ,1,nd_cc,ns,scale_cc,eta_cc_fab,temp_cc_fab) -
+                        FusedFlux(i  ,j-1,k  ,1,nd_cc,ns,scale_cc,eta_cc_fab,temp_cc_fab) +
+                        FusedFlux(i  ,j  ,k+1,c_yz0,nd_yz,ns,scale_ed,eta_yz_fab,temp_yz_fab) -
+                        FusedFlux(i  ,j  ,k  ,c_yz0,nd_yz,ns,scale_ed,eta_yz_fab,temp_yz_fab)) * dxinv;
+            divy(i,j,k) = add ? divy(i,j,k) + div : div;
+        },
+                           [=] AMREX_GPU_DEVICE (int i, int j, int k)
+        {
+            Real div = (FusedFlux(i+1,j  ,k  ,c_xz1,nd_xz,ns,scale_ed,eta_xz_fab,temp_xz_fab) -
+                        FusedFlux(i  ,j  ,k  ,c_xz1,nd_xz,ns,scale_ed,eta_xz_fab,temp_xz_fab) +
+                        FusedFlux(i  ,j+1,k  ,c_yz1,nd_yz,ns,scale_ed,eta_yz_fab,temp_yz_fab) -
+                        FusedFlux(i  ,j  ,k  ,c_yz1,nd_yz,ns,scale_ed,eta_yz_fab,temp_yz_fab) +
+                        FusedFlux(i  ,j  ,k  ,2,nd_cc,ns,scale_cc,eta_cc_fab,temp_cc_fab) -
+                        FusedFlux(i  ,j  ,k-1,2,nd_cc,ns,scale_cc,eta_cc_fab,temp_cc_fab)) * dxinv;
+            divz(i,j,k) = add ? divz(i,j,k) + div : div;
+        });
+#endif
+    }
+
+    // wgt_d and key_d must outlive the kernels
+    Gpu::synchronize();
+
+    // m_force does not have ghost cells
+    // set the value on physical boundaries to zero
+    for (int d=0; d<AMREX_SPACEDIM; ++d) {
+        MultiFabPhysBCDomainVel(m_force[d], geom, d);
+    }
+}
+
+// write the unweighted noise of one stage, as fillMomStochastic would have
+// stored it, into mf_cc and mf_ed (counter_rng=1)
+void StochMomFlux::FillStageNoise(MultiFab& mf_cc, std::array< MultiFab, NUM_EDGE >& mf_ed,
+                                  const int& stage) {
+
+    const int sym = (stoch_stress_form != 0);
+    const Real scale_cc = sym ? sqrt(2.) : 1.;
+
+    Gpu::DeviceVector<Real> wgt_d(1, 1.);
+    Gpu::DeviceVector<uint32_t> key_d(1, stage_key1[stage]);
+
+    NoiseStages ns;
+    ns.wgt = wgt_d.dataPtr();
+    ns.key1 = key_d.dataPtr();
+    ns.nstage = 1;
+    ns.key0 = stage_key0;
+
+    const NoiseDomain nd_cc = MakeNoiseDomain(geom, mf_cc.ixType(), 0);
+
+    for (MFIter mfi(mf_cc); mfi.isValid(); ++mfi) {
+        const Box& bx = mfi.validbox();
+        const Array4<Real> & fab = mf_cc.array(mfi);
+        amrex::ParallelFor(bx, AMREX_SPACEDIM, [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+        {
+            fab(i,j,k,n) = scale_cc*StageNoise(i,j,k,n,nd_cc,ns);
+        });
+    }
+
+    for (int d=0; d<NUM_EDGE; ++d) {
+        const NoiseDomain nd_ed = MakeNoiseDomain(geom, mf_ed[d].ixType(), 0);
+        const int c_ed = AMREX_SPACEDIM + 2*d;
+        for (MFIter mfi(mf_ed[d]); mfi.isValid(); ++mfi) {
+            const Box& bx = mfi.validbox();
+            const Array4<Real> & fab = mf_ed[d].array(mfi);
+            amrex::ParallelFor(bx, ncomp_ed, [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+            {
+                fab(i,j,k,n) = StageNoise(i,j,k,c_ed + (sym ? 0 : n),nd_ed,ns);
+            });
+        }
+    }
+
+    Gpu::synchronize();
+}
+
 // utility to write out random number MultiFabs to plotfiles
 void StochMomFlux::writeMFs(std::array< MultiFab, AMREX_SPACEDIM >& mfluxdiv) {
     
@@ -824,6 +1133,44 @@ void StochMomFlux::writeMFs(std::array< MultiFab, AMREX_SPACEDIM >& mfluxdiv) {
     std::string plotfilename;
     std::string dimStr = "xyz";
 
+    if (fused) {
+        // nothing is stored; regenerate the stage noise for output
+        const BoxArray& ba = amrex::convert(mfluxdiv[0].boxArray(), IntVect::TheCellVector());
+        const DistributionMapping& dmap = mfluxdiv[0].DistributionMap();
+
+        MultiFab mf_cc(ba, dmap, AMREX_SPACEDIM, 0);
+        std::array< MultiFab, NUM_EDGE > mf_ed;
+#if (AMREX_SPACEDIM == 2)
+        mf_ed[0].define(convert(ba,nodal_flag), dmap, ncomp_ed, 0);
+#elif (AMREX_SPACEDIM == 3)
+        mf_ed[0].define(convert(ba,nodal_flag_xy), dmap, ncomp_ed, 0);
+        mf_ed[1].define(convert(ba,nodal_flag_xz), dmap, ncomp_ed, 0);
+        mf_ed[2].define(convert(ba,nodal_flag_yz), dmap, ncomp_ed, 0);
+#endif
+
+        for (int i=0; i<n_rngs; ++i){
+            FillStageNoise(mf_cc, mf_ed, i);
+
+            plotfilename = "a_mfluxcc_stage"+std::to_string(i);
+            VisMF::Write(mf_cc,plotfilename);
+
+            for (int d=0; d<NUM_EDGE; ++d) {
+                plotfilename = "a_mfluxnd_stage"+std::to_string(i)+"_";
+                plotfilename += dimStr[d];
+                VisMF::Write(mf_ed[d],plotfilename);
+            }
+        }
+
+        // Write out fluxdiv
+        for (int d=0; d<AMREX_SPACEDIM; ++d) {
+            plotfilename = "a_mfluxdiv_";
+            plotfilename += dimStr[d];
+            VisMF::Write(mfluxdiv[d],plotfilename);
+        }
+
+        return;
+    }
+
     // Write out original fluxes
     for (int i=0; i<n_rngs; ++i){
         plotfilename = "a_mfluxcc_stage"+std::to_string(i);
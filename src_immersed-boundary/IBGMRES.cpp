@@ -252,14 +252,9 @@ void IBGMRES(std::array<MultiFab, AMREX_SPACEDIM> & b_u, const MultiFab & b_p,
 
         // tmp = b - Ax
         // Fluid part: ........................... tmp_u = b_u - (Ax_u - Gx_p - Sx_lambda)
-        for (int d=0; d<AMREX_SPACEDIM; ++d) {
-            MultiFab::Subtract(tmp_u[d], b_u[d], 0, 0, 1, 0);
-            tmp_u[d].mult(-1., 0, 1, 0);
-        }
-
         // Pressure part: ............................................ tmp_p = b_p - (-Dv)
-        MultiFab::Subtract(tmp_p, b_p, 0, 0, 1, 0);
-        tmp_p.mult(-1., 0, 1, 0);
+        // together with the un-preconditioned fluid and pressure residuals
+        StagCCAxpbyNorm(1., b_u, b_p, -1., tmp_u, tmp_p, norm_u_noprecon, norm_p_noprecon);
 
         // IBM part: ....................................... tmp_lambda = b_lambda - (-Jv)
         MarkerInvSub(part_indices, tmp_lambda, b_lambda);
@@ -267,8 +262,6 @@ void IBGMRES(std::array<MultiFab, AMREX_SPACEDIM> & b_u, const MultiFab & b_p,
 
         //_______________________________________________________________________
         // un-preconditioned residuals
-        StagL2Norm(geom, tmp_u, 0, norm_u_noprecon);
-        CCL2Norm(tmp_p, 0, norm_p_noprecon);
         MarkerL2Norm(part_indices, dummy_iter, geom, marker_pos,
                      tmp_lambda, norm_lambda_noprecon);
 
@@ -394,13 +387,7 @@ void IBGMRES(std::array<MultiFab, AMREX_SPACEDIM> & b_u, const MultiFab & b_p,
 
         //_______________________________________________________________________
         // Create the first basis in Krylov space: V(1) = r / norm(r)
-        for (int d=0; d<AMREX_SPACEDIM; ++d) {
-            MultiFab::Copy(V_u[d], r_u[d], 0, 0, 1, 0);
-            V_u[d].mult(1./norm_resid, 0, 1, 0);
-        }
-
-        MultiFab::Copy(V_p, r_p, 0, 0, 1, 0);
-        V_p.mult(1./norm_resid, 0, 1, 0);
+        StagCCAxpby(1./norm_resid, r_u, r_p, 0, 0., V_u, V_p, 0);
 
         MarkerCopy(part_indices, 0, V_lambda, r_lambda);
         MarkerMult(part_indices, 0, 1./norm_resid, V_lambda);
@@ -476,16 +463,7 @@ void IBGMRES(std::array<MultiFab, AMREX_SPACEDIM> & b_u, const MultiFab & b_p,
 
 
                 // w = w - H(k,i) * V(k)
-                // use tmp_u and tmp_p as temporaries to hold kth component of V(k)
-                for (int d=0; d<AMREX_SPACEDIM; ++d) {
-                    MultiFab::Copy(tmp_u[d], V_u[d], k, 0, 1, 0);
-                    tmp_u[d].mult(H[k][i], 0, 1, 0);
-                    MultiFab::Subtract(w_u[d], tmp_u[d], 0, 0, 1, 0);
-                }
-
-                MultiFab::Copy(tmp_p, V_p, k, 0, 1, 0);
-                tmp_p.mult(H[k][i], 0, 1, 0);
-                MultiFab::Subtract(w_p, tmp_p, 0, 0, 1, 0);
+                StagCCAxpby(-H[k][i], V_u, V_p, k, 1., w_u, w_p, 0);
 
                 MarkerCopy(part_indices, k, tmp_lambda, V_lambda);
                 MarkerMult(part_indices, H[k][i], tmp_lambda);
@@ -504,13 +482,7 @@ void IBGMRES(std::array<MultiFab, AMREX_SPACEDIM> & b_u, const MultiFab & b_p,
             //___________________________________________________________________
             // V(i+1) = w / H(i+1,i)
             if (H[i+1][i] != 0.) {
-                for (int d=0; d<AMREX_SPACEDIM; ++d) {
-                    MultiFab::Copy(V_u[d], w_u[d], 0, i+1, 1, 0);
-                    V_u[d].mult(1./H[i+1][i], i+1, 1, 0);
-                }
-
-                MultiFab::Copy(V_p, w_p, 0, i+1, 1, 0);
-                V_p.mult(1./H[i+1][i], i+1, 1, 0);
+                StagCCAxpby(1./H[i+1][i], w_u, w_p, 0, 0., V_u, V_p, i+1);
 
                 MarkerCopy(part_indices, i+1, V_lambda, w_lambda);
                 MarkerMult(part_indices, i+1, 1./H[i+1][i], V_lambda);
@@ -1473,19 +1445,12 @@ void UpdateSolIBM(const Vector<std::pair<int, int>>                       & part
                   const Vector<Real>                                      & y,
                   int i ) {
 
-    // set V(i) = V(i)*y(i)
-    // set x = x + V(i)
+    // x = x + sum_{iter=0}^{i} y(iter)*V(iter)
+    StagCCMultiAxpy(x_u, x_p, 0, y, V_u, V_p, i+1);
 
+    // set V_lambda(i) = V_lambda(i)*y(i)
+    // set x_lambda = x_lambda + V_lambda(i)
     for (int iter=0; iter<=i; ++iter) {
-
-        for (int d=0; d<AMREX_SPACEDIM; ++d) {
-            V_u[d].mult(y[iter], iter, 1, 0);
-            MultiFab::Add(x_u[d], V_u[d], iter, 0, 1, 0);
-        }
-
-        V_p.mult(y[iter], iter, 1, 0);
-        MultiFab::Add(x_p, V_p, iter, 0, 1, 0);
-
         MarkerMult(part_indices, iter, y[iter], V_lambda);
         MarkerAdd(part_indices, iter, x_lambda, V_lambda);
     }
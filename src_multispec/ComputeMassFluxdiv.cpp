@@ -15,6 +15,7 @@ void ComputeMassFluxdiv(MultiFab& rho,
                         std::array<MultiFab,AMREX_SPACEDIM>& grad_Epot,
                         MultiFab& Epot,
                         MultiFab& permittivity,
+                        EpotSolver& epotSolver,
                         const int& zero_initial_Epot)
 {
 
@@ -84,7 +85,7 @@ void ComputeMassFluxdiv(MultiFab& rho,
   if (use_charged_fluid) {
       ElectroDiffusiveMassFluxdiv(rho,Temp,rhoWchi,diff_mass_flux,diff_mass_fluxdiv,
                                   stoch_mass_flux,charge,grad_Epot,Epot,permittivity,
-                                  dt,1,geom);
+                                  epotSolver,dt,zero_initial_Epot,geom);
   }
   
 }
@@ -1,7 +1,5 @@
 #include "multispec_functions.H"
 #include "common_functions.H"
-#include <AMReX_MLMG.H>
-#include <AMReX_MLABecLaplacian.H>
 
 void ElectroDiffusiveMassFluxdiv(const MultiFab& rho,
                                  const MultiFab& Temp,
@@ -13,6 +11,7 @@ void ElectroDiffusiveMassFluxdiv(const MultiFab& rho,
                                  std::array< MultiFab, AMREX_SPACEDIM >& grad_Epot,
                                  MultiFab& Epot,
                                  const MultiFab& permittivity,
+                                 EpotSolver& epotSolver,
                                  Real dt,
                                  int zero_initial_Epot,
                                  const Geometry& geom)
@@ -31,7 +30,7 @@ void ElectroDiffusiveMassFluxdiv(const MultiFab& rho,
     // cells contain interior+2 ghost cells)
     ElectroDiffusiveMassFlux(rho,Temp,rhoWchi,electro_mass_flux,diff_mass_flux,
                              stoch_mass_flux,charge,grad_Epot,Epot,permittivity,
-                             dt,zero_initial_Epot,geom);
+                             epotSolver,dt,zero_initial_Epot,geom);
 
     // add fluxes to diff_mass_flux
     for (int i=0; i<AMREX_SPACEDIM; ++i) {
@@ -53,6 +52,7 @@ void ElectroDiffusiveMassFlux(const MultiFab& rho,
                               std::array< MultiFab, AMREX_SPACEDIM >& grad_Epot,
                               MultiFab& Epot,
                               const MultiFab& permittivity,
+                              EpotSolver& epotSolver,
                               Real dt,
                               int zero_initial_Epot,
                               const Geometry& geom)
@@ -167,72 +167,12 @@ void ElectroDiffusiveMassFlux(const MultiFab& rho,
     // solve (alpha - del dot beta grad) Epot = z^T F (for electro-neutral)
     //   Only homogeneous Neumann BCs supported
 
-    LinOpBCType lo_linop_bc[3];
-    LinOpBCType hi_linop_bc[3];
-
-    for (int i=0; i<AMREX_SPACEDIM; ++i) {
-        if (bc_es_lo[i] == -1 && bc_es_hi[i] == -1) {
-            lo_linop_bc[i] = LinOpBCType::Periodic;
-            hi_linop_bc[i] = LinOpBCType::Periodic;
-        }
-        if(bc_es_lo[i] == 2)
-        {
-            lo_linop_bc[i] = LinOpBCType::inhomogNeumann;
-        }
-        if(bc_es_hi[i] == 2)
-        {
-            hi_linop_bc[i] = LinOpBCType::inhomogNeumann;
-        }
-        if(bc_es_lo[i] == 1)
-        {                 
-            lo_linop_bc[i] = LinOpBCType::Dirichlet;
-        }
-        if(bc_es_hi[i] == 1)
-        {
-            hi_linop_bc[i] = LinOpBCType::Dirichlet;
-        }
-    }
-
-    // create solver opject
-    // (alpha - del dot beta grad) Epot = charge (for electro-explicit)
-    MLABecLaplacian linop({geom}, {ba}, {dmap});
- 
-    //set BCs
-    linop.setDomainBC({AMREX_D_DECL(lo_linop_bc[0],
-                                    lo_linop_bc[1],
-                                    lo_linop_bc[2])},
-                      {AMREX_D_DECL(hi_linop_bc[0],
-                                    hi_linop_bc[1],
-                                    hi_linop_bc[2])});
-
     // fill in ghost cells with Dirichlet/Neumann values
     // the ghost cells will hold the value ON the boundary
     MultiFabPotentialBC_solver(Epot,geom);
 
-    // tell MLPoisson about these potentially inhomogeneous BC values
-    linop.setLevelBC(0, &Epot);
-
-    // this forces the solver to NOT enforce solvability
-    // thus if there are Neumann conditions on phi they must
-    // be correct or the Poisson solver won't converge
-    linop.setEnforceSingularSolvable(false);
-
-    // set alpha=0, beta=1 (will overwrite beta with epsilon next)
-    linop.setScalars(0.0, 1.0);
-
-    // set beta=epsilon
-    linop.setBCoeffs(0, amrex::GetArrOfConstPtrs(beta));
-
-    // Multi Level Multi Grid
-    MLMG mlmg(linop);
-
-    // Solver parameters
-    mlmg.setMaxIter(poisson_max_iter);
-    mlmg.setVerbose(poisson_verbose);
-    mlmg.setBottomVerbose(poisson_bottom_verbose);
-    
-    // Do solve
-    mlmg.solve({&Epot}, {&rhs}, poisson_rel_tol, 0.0);
+    // the operator and MLMG are kept in epotSolver between calls
+    epotSolver.Solve(Epot,rhs,beta,geom);
 
     // restore original solver tolerance
     if (electroneutral == 1) {
@@ -0,0 +1,99 @@
+#include "multispec_functions.H"
+#include "EpotSolver.H"
+
+EpotSolver::EpotSolver(const BoxArray& ba_in,
+                       const DistributionMapping& dmap_in,
+                       const Geometry& geom)
+{
+    if (use_charged_fluid) {
+        Define(ba_in, dmap_in, geom);
+    }
+}
+
+void EpotSolver::Define(const BoxArray& ba_in,
+                        const DistributionMapping& dmap_in,
+                        const Geometry& geom)
+{
+    BL_PROFILE_VAR("EpotSolver::Define()",EpotSolver_Define);
+
+    ba = ba_in;
+    dmap = dmap_in;
+
+    LinOpBCType lo_linop_bc[3];
+    LinOpBCType hi_linop_bc[3];
+
+    for (int i=0; i<AMREX_SPACEDIM; ++i) {
+        if (bc_es_lo[i] == -1 && bc_es_hi[i] == -1) {
+            lo_linop_bc[i] = LinOpBCType::Periodic;
+            hi_linop_bc[i] = LinOpBCType::Periodic;
+        }
+        if(bc_es_lo[i] == 2)
+        {
+            lo_linop_bc[i] = LinOpBCType::inhomogNeumann;
+        }
+        if(bc_es_hi[i] == 2)
+        {
+            hi_linop_bc[i] = LinOpBCType::inhomogNeumann;
+        }
+        if(bc_es_lo[i] == 1)
+        {
+            lo_linop_bc[i] = LinOpBCType::Dirichlet;
+        }
+        if(bc_es_hi[i] == 1)
+        {
+            hi_linop_bc[i] = LinOpBCType::Dirichlet;
+        }
+    }
+
+    // the solver refers to the operator, so it goes first
+    mlmg.reset();
+
+    // create solver opject
+    // (alpha - del dot beta grad) Epot = charge (for electro-explicit)
+    linop.reset(new MLABecLaplacian({geom}, {ba}, {dmap}));
+
+    //set BCs
+    linop->setDomainBC({AMREX_D_DECL(lo_linop_bc[0],
+                                     lo_linop_bc[1],
+                                     lo_linop_bc[2])},
+                       {AMREX_D_DECL(hi_linop_bc[0],
+                                     hi_linop_bc[1],
+                                     hi_linop_bc[2])});
+
+    // this forces the solver to NOT enforce solvability
+    // thus if there are Neumann conditions on phi they must
+    // be correct or the Poisson solver won't converge
+    linop->setEnforceSingularSolvable(false);
+
+    // set alpha=0, beta=1 (beta is overwritten with epsilon in Solve)
+    linop->setScalars(0.0, 1.0);
+
+    // Multi Level Multi Grid
+    mlmg.reset(new MLMG(*linop));
+
+    // Solver parameters
+    mlmg->setMaxIter(poisson_max_iter);
+    mlmg->setVerbose(poisson_verbose);
+    mlmg->setBottomVerbose(poisson_bottom_verbose);
+}
+
+void EpotSolver::Solve(MultiFab& Epot,
+                       const MultiFab& rhs,
+                       const std::array< MultiFab, AMREX_SPACEDIM >& beta,
+                       const Geometry& geom)
+{
+    BL_PROFILE_VAR("EpotSolver::Solve()",EpotSolver_Solve);
+
+    if (!linop || rhs.boxArray() != ba || rhs.DistributionMap() != dmap) {
+        Define(rhs.boxArray(), rhs.DistributionMap(), geom);
+    }
+
+    // tell MLABecLaplacian about these potentially inhomogeneous BC values
+    linop->setLevelBC(0, &Epot);
+
+    // set beta=epsilon
+    linop->setBCoeffs(0, amrex::GetArrOfConstPtrs(beta));
+
+    // Do solve; Epot holds the initial guess
+    mlmg->solve({&Epot}, {&rhs}, poisson_rel_tol, 0.0);
+}
@@ -32,7 +32,8 @@ void InitialProjection(std::array< MultiFab, AMREX_SPACEDIM >& umac,
                        MultiFab& charge_old,
                        std::array<MultiFab,AMREX_SPACEDIM>& grad_Epot_old,
                        MultiFab& Epot,
-                       MultiFab& permittivity)
+                       MultiFab& permittivity,
+                       EpotSolver& epotSolver)
 {
     BL_PROFILE_VAR("InitialProjection()",InitialProjection);
 
@@ -99,7 +100,7 @@ void InitialProjection(std::array< MultiFab, AMREX_SPACEDIM >& umac,
         
     ComputeMassFluxdiv(rho,rhotot,Temp,diff_mass_fluxdiv,stoch_mass_fluxdiv,
                        diff_mass_flux,stoch_mass_flux,sMassFlux,dt,time,geom,weights,
-                       charge_old,grad_Epot_old,Epot,permittivity);
+                       charge_old,grad_Epot_old,Epot,permittivity,epotSolver);
 
     // assumble total fluxes to be used in reservoirs
     //
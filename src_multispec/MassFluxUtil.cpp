@@ -1,5 +1,681 @@
 #include "multispec_functions.H"
 
+#include <limits>
+
+// Small-matrix kernels for ComputeRhoWChi and ComputeSqrtLonsagerFC.
+// The nspecies x nspecies matrices of up to BW cells (or faces) are stored
+// interleaved, a[r*MS+c][lane], and every loop over the lanes is innermost,
+// so the compiler vectorizes across cells rather than within one small
+// matrix.  nl <= BW is the number of active lanes.  Cells with trace species
+// reduce to a smaller subsystem of their own and go through the same kernels
+// one at a time (nl = 1).  NS is the compile-time species count of the
+// matrices (0 = the runtime n), as in the compressible transport kernels.
+
+namespace {
+
+constexpr int BW = 8;
+constexpr int MS = MAX_SPECIES;
+
+using BatchVec = Real[MS][BW];
+using BatchMat = Real[MS*MS][BW];
+
+constexpr int bidx (int r, int c) { return r*MS+c; }
+
+// in-place Cholesky factor, as choldc in matrix_utilities.F90: on return a
+// holds the lower factor with the upper triangle zeroed; a non-positive
+// pivot zeroes that column of the factor
+template <int NS>
+void BatchCholesky (int n_in, int nl, BatchMat& a)
+{
+    const int n = (NS > 0) ? NS : n_in;
+
+    BatchVec p;
+    Real ising[BW];
+
+    for (int i=0; i<n; ++i) {
+        for (int j=i; j<n; ++j) {
+            Real sum1[BW];
+            AMREX_PRAGMA_SIMD
+            for (int l=0; l<nl; ++l) {
+                sum1[l] = a[bidx(i,j)][l];
+            }
+            for (int k=0; k<i; ++k) {
+                AMREX_PRAGMA_SIMD
+                for (int l=0; l<nl; ++l) {
+                    sum1[l] -= a[bidx(i,k)][l]*a[bidx(j,k)][l];
+                }
+            }
+            if (i == j) {
+                AMREX_PRAGMA_SIMD
+                for (int l=0; l<nl; ++l) {
+                    ising[l] = (sum1[l] <= 0.) ? 1. : 0.;
+                    p[i][l] = (sum1[l] <= 0.) ? 0. : std::sqrt(sum1[l]);
+                }
+            } else {
+                AMREX_PRAGMA_SIMD
+                for (int l=0; l<nl; ++l) {
+                    a[bidx(j,i)][l] = (ising[l] != 0.) ? 0. : sum1[l]/p[i][l];
+                }
+            }
+        }
+    }
+
+    for (int i=0; i<n; ++i) {
+        for (int j=i+1; j<n; ++j) {
+            AMREX_PRAGMA_SIMD
+            for (int l=0; l<nl; ++l) {
+                a[bidx(i,j)][l] = 0.;
+            }
+        }
+        AMREX_PRAGMA_SIMD
+        for (int l=0; l<nl; ++l) {
+            a[bidx(i,i)][l] = p[i][l];
+        }
+    }
+}
+
+// c = a*b
+template <int NS>
+void BatchMatMul (int n_in, int nl, const BatchMat& a, const BatchMat& b, BatchMat& c)
+{
+    const int n = (NS > 0) ? NS : n_in;
+
+    for (int i=0; i<n; ++i) {
+        for (int j=0; j<n; ++j) {
+            AMREX_PRAGMA_SIMD
+            for (int l=0; l<nl; ++l) {
+                c[bidx(i,j)][l] = 0.;
+            }
+            for (int k=0; k<n; ++k) {
+                AMREX_PRAGMA_SIMD
+                for (int l=0; l<nl; ++l) {
+                    c[bidx(i,j)][l] += a[bidx(i,k)][l]*b[bidx(k,j)][l];
+                }
+            }
+        }
+    }
+}
+
+// chi from D_bar by the series of Dbar2chi_iterative (matrix_utilities.F90);
+// X are the mole fractions, which must not be zero
+template <int NS>
+void BatchChiIterative (int n_in, int nl, int num_iterations,
+                        const BatchMat& D, const BatchVec& X, const BatchVec& mm,
+                        BatchMat& chi)
+{
+    const int n = (NS > 0) ? NS : n_in;
+
+    BatchVec Y, Minv, Mmat;
+    BatchMat P, J, PJ, matrix2, matrix1;
+
+    // molecular weight of mixture and mass fractions - EGLIB
+    Real MWmix[BW];
+    AMREX_PRAGMA_SIMD
+    for (int l=0; l<nl; ++l) {
+        MWmix[l] = 0.;
+    }
+    for (int i=0; i<n; ++i) {
+        AMREX_PRAGMA_SIMD
+        for (int l=0; l<nl; ++l) {
+            MWmix[l] += X[i][l]*mm[i][l];
+        }
+    }
+    for (int i=0; i<n; ++i) {
+        AMREX_PRAGMA_SIMD
+        for (int l=0; l<nl; ++l) {
+            Y[i][l] = mm[i][l]/MWmix[l]*X[i][l];
+        }
+    }
+
+    // Di, Mmat and Minv
+    for (int i=0; i<n; ++i) {
+        Real term2[BW];
+        AMREX_PRAGMA_SIMD
+        for (int l=0; l<nl; ++l) {
+            term2[l] = 0.;
+        }
+        for (int j=0; j<n; ++j) {
+            if (j == i) continue;
+            AMREX_PRAGMA_SIMD
+            for (int l=0; l<nl; ++l) {
+                term2[l] += X[j][l]/D[bidx(i,j)][l];
+            }
+        }
+        AMREX_PRAGMA_SIMD
+        for (int l=0; l<nl; ++l) {
+            Real Di = (1.-Y[i][l])/term2[l];
+            Mmat[i][l] = X[i][l]/Di;
+            Minv[i][l] = Di/X[i][l];
+        }
+    }
+
+    // P = I - 1 Y^T
+    for (int i=0; i<n; ++i) {
+        for (int j=0; j<n; ++j) {
+            AMREX_PRAGMA_SIMD
+            for (int l=0; l<nl; ++l) {
+                P[bidx(i,j)][l] = ((i == j) ? 1. : 0.) - Y[j][l];
+            }
+        }
+    }
+
+    // J = M^-1 (M - Delta)
+    for (int i=0; i<n; ++i) {
+        for (int j=0; j<n; ++j) {
+            if (i == j) {
+                Real term1[BW];
+                AMREX_PRAGMA_SIMD
+                for (int l=0; l<nl; ++l) {
+                    term1[l] = 0.;
+                }
+                for (int k=0; k<n; ++k) {
+                    if (k == i) continue;
+                    AMREX_PRAGMA_SIMD
+                    for (int l=0; l<nl; ++l) {
+                        term1[l] += X[i][l]*X[k][l]/D[bidx(i,k)][l];
+                    }
+                }
+                AMREX_PRAGMA_SIMD
+                for (int l=0; l<nl; ++l) {
+                    J[bidx(i,i)][l] = Minv[i][l]*(Mmat[i][l] - term1[l]);
+                }
+            } else {
+                AMREX_PRAGMA_SIMD
+                for (int l=0; l<nl; ++l) {
+                    J[bidx(i,j)][l] = Minv[i][l]*X[i][l]*X[j][l]/D[bidx(i,j)][l];
+                }
+            }
+        }
+    }
+
+    BatchMatMul<NS>(n, nl, P, J, PJ);
+
+    // P M^-1 P^T
+    for (int i=0; i<n; ++i) {
+        for (int j=0; j<n; ++j) {
+            AMREX_PRAGMA_SIMD
+            for (int l=0; l<nl; ++l) {
+                matrix2[bidx(i,j)][l] = 0.;
+            }
+            for (int k=0; k<n; ++k) {
+                AMREX_PRAGMA_SIMD
+                for (int l=0; l<nl; ++l) {
+                    matrix2[bidx(i,j)][l] += P[bidx(i,k)][l]*Minv[k][l]*P[bidx(j,k)][l];
+                }
+            }
+            AMREX_PRAGMA_SIMD
+            for (int l=0; l<nl; ++l) {
+                chi[bidx(i,j)][l] = matrix2[bidx(i,j)][l];
+            }
+        }
+    }
+
+    for (int it=0; it<num_iterations; ++it) {
+        BatchMatMul<NS>(n, nl, PJ, chi, matrix1);
+        for (int i=0; i<n; ++i) {
+            for (int j=0; j<n; ++j) {
+                AMREX_PRAGMA_SIMD
+                for (int l=0; l<nl; ++l) {
+                    chi[bidx(i,j)][l] = matrix1[bidx(i,j)][l] + matrix2[bidx(i,j)][l];
+                }
+            }
+        }
+    }
+}
+
+// inverse of symmetric positive definite matrices from their Cholesky factor
+template <int NS>
+void BatchInverseSPD (int n_in, int nl, BatchMat& a, BatchMat& ainv)
+{
+    const int n = (NS > 0) ? NS : n_in;
+
+    BatchMat Linv;
+
+    BatchCholesky<NS>(n, nl, a);
+
+    // Linv = L^-1 (lower triangular)
+    for (int j=0; j<n; ++j) {
+        for (int i=0; i<n; ++i) {
+            AMREX_PRAGMA_SIMD
+            for (int l=0; l<nl; ++l) {
+                Linv[bidx(i,j)][l] = 0.;
+            }
+        }
+        AMREX_PRAGMA_SIMD
+        for (int l=0; l<nl; ++l) {
+            Linv[bidx(j,j)][l] = 1./a[bidx(j,j)][l];
+        }
+        for (int i=j+1; i<n; ++i) {
+            Real sum1[BW];
+            AMREX_PRAGMA_SIMD
+            for (int l=0; l<nl; ++l) {
+                sum1[l] = 0.;
+            }
+            for (int k=j; k<i; ++k) {
+                AMREX_PRAGMA_SIMD
+                for (int l=0; l<nl; ++l) {
+                    sum1[l] += a[bidx(i,k)][l]*Linv[bidx(k,j)][l];
+                }
+            }
+            AMREX_PRAGMA_SIMD
+            for (int l=0; l<nl; ++l) {
+                Linv[bidx(i,j)][l] = -sum1[l]/a[bidx(i,i)][l];
+            }
+        }
+    }
+
+    // a^-1 = L^-T L^-1
+    for (int i=0; i<n; ++i) {
+        for (int j=0; j<n; ++j) {
+            AMREX_PRAGMA_SIMD
+            for (int l=0; l<nl; ++l) {
+                ainv[bidx(i,j)][l] = 0.;
+            }
+            for (int k=amrex::max(i,j); k<n; ++k) {
+                AMREX_PRAGMA_SIMD
+                for (int l=0; l<nl; ++l) {
+                    ainv[bidx(i,j)][l] += Linv[bidx(k,i)][l]*Linv[bidx(k,j)][l];
+                }
+            }
+        }
+    }
+}
+
+// pseudo-inverse of symmetric matrices from a cyclic Jacobi eigendecomposition;
+// eigenvalues below fraction_tolerance times the largest one are dropped
+template <int NS>
+void BatchPseudoInverse (int n_in, int nl, BatchMat& a, BatchMat& ainv)
+{
+    const int n = (NS > 0) ? NS : n_in;
+
+    // quadratic convergence: a handful of sweeps is enough for n <= MAX_SPECIES
+    const int nsweeps = 10;
+
+    BatchMat V;
+    for (int i=0; i<n; ++i) {
+        for (int j=0; j<n; ++j) {
+            AMREX_PRAGMA_SIMD
+            for (int l=0; l<nl; ++l) {
+                V[bidx(i,j)][l] = (i == j) ? 1. : 0.;
+            }
+        }
+    }
+
+    for (int sweep=0; sweep<nsweeps; ++sweep) {
+        for (int p=0; p<n-1; ++p) {
+            for (int q=p+1; q<n; ++q) {
+
+                // rotation that zeroes a(p,q); the identity where it already is zero
+                Real c[BW], s[BW];
+                AMREX_PRAGMA_SIMD
+                for (int l=0; l<nl; ++l) {
+                    Real apq = a[bidx(p,q)][l];
+                    Real theta = (a[bidx(q,q)][l] - a[bidx(p,p)][l]) / ((apq != 0.) ? 2.*apq : 1.);
+                    Real t = ((theta >= 0.) ? 1. : -1.) / (std::abs(theta) + std::sqrt(theta*theta + 1.));
+                    t = (apq != 0.) ? t : 0.;
+                    c[l] = 1./std::sqrt(t*t + 1.);
+                    s[l] = t*c[l];
+                }
+
+                // a = R^T a R and V = V R
+                for (int k=0; k<n; ++k) {
+                    AMREX_PRAGMA_SIMD
+                    for (int l=0; l<nl; ++l) {
+                        Real akp = a[bidx(k,p)][l];
+                        Real akq = a[bidx(k,q)][l];
+                        a[bidx(k,p)][l] = c[l]*akp - s[l]*akq;
+                        a[bidx(k,q)][l] = s[l]*akp + c[l]*akq;
+                    }
+                }
+                for (int k=0; k<n; ++k) {
+                    AMREX_PRAGMA_SIMD
+                    for (int l=0; l<nl; ++l) {
+                        Real apk = a[bidx(p,k)][l];
+                        Real aqk = a[bidx(q,k)][l];
+                        a[bidx(p,k)][l] = c[l]*apk - s[l]*aqk;
+                        a[bidx(q,k)][l] = s[l]*apk + c[l]*aqk;
+                    }
+                }
+                for (int k=0; k<n; ++k) {
+                    AMREX_PRAGMA_SIMD
+                    for (int l=0; l<nl; ++l) {
+                        Real vkp = V[bidx(k,p)][l];
+                        Real vkq = V[bidx(k,q)][l];
+                        V[bidx(k,p)][l] = c[l]*vkp - s[l]*vkq;
+                        V[bidx(k,q)][l] = s[l]*vkp + c[l]*vkq;
+                    }
+                }
+            }
+        }
+    }
+
+    // inverse of the retained eigenvalues
+    BatchVec lambdainv;
+    Real lambdamax[BW];
+    AMREX_PRAGMA_SIMD
+    for (int l=0; l<nl; ++l) {
+        lambdamax[l] = 0.;
+    }
+    for (int k=0; k<n; ++k) {
+        AMREX_PRAGMA_SIMD
+        for (int l=0; l<nl; ++l) {
+            lambdamax[l] = amrex::max(lambdamax[l], std::abs(a[bidx(k,k)][l]));
+        }
+    }
+    for (int k=0; k<n; ++k) {
+        AMREX_PRAGMA_SIMD
+        for (int l=0; l<nl; ++l) {
+            Real lambda = a[bidx(k,k)][l];
+            lambdainv[k][l] = (std::abs(lambda) > fraction_tolerance*lambdamax[l]) ? 1./lambda : 0.;
+        }
+    }
+
+    for (int i=0; i<n; ++i) {
+        for (int j=0; j<n; ++j) {
+            AMREX_PRAGMA_SIMD
+            for (int l=0; l<nl; ++l) {
+                ainv[bidx(i,j)][l] = 0.;
+            }
+            for (int k=0; k<n; ++k) {
+                AMREX_PRAGMA_SIMD
+                for (int l=0; l<nl; ++l) {
+                    ainv[bidx(i,j)][l] += V[bidx(i,k)][l]*lambdainv[k][l]*V[bidx(j,k)][l];
+                }
+            }
+        }
+    }
+}
+
+// chi from D_bar:
+//   n = 2:          analytic
+//   use_lapack = 1: chi = (Lambda + alpha W W^T)^-1 - 1/alpha, alpha = trace(Lambda),
+//                   by inverse (inverse_type = 1) or pseudo-inverse
+//   otherwise:      Dbar2chi_iterative with chi_iterations terms
+// W are the mass fractions, X the mole fractions and mm the molar masses
+template <int NS>
+void BatchChi (int n_in, int nl,
+               const BatchMat& D, const BatchVec& W, const BatchVec& X, const BatchVec& mm,
+               BatchMat& chi)
+{
+    const int n = (NS > 0) ? NS : n_in;
+
+    if (n == 2) {
+        const Real eepsilon = 1.e-16;
+        AMREX_PRAGMA_SIMD
+        for (int l=0; l<nl; ++l) {
+            Real W1 = W[0][l];
+            Real W2 = W[1][l];
+            if (use_multiphase == 1) {
+                W1 = amrex::max(amrex::min(W1,1.),eepsilon);
+                W2 = amrex::max(amrex::min(W2,1.),eepsilon);
+            }
+            Real tmp = mm[0][l]*W2 + mm[1][l]*W1;
+            tmp = D[bidx(0,1)][l]*tmp*tmp/mm[0][l]/mm[1][l];
+
+            chi[bidx(0,0)][l] = tmp*W2/W1;
+            chi[bidx(0,1)][l] = -tmp;
+            chi[bidx(1,0)][l] = -tmp;
+            chi[bidx(1,1)][l] = tmp*W1/W2;
+        }
+        return;
+    }
+
+    if (use_lapack == 0) {
+        BatchChiIterative<NS>(n, nl, chi_iterations, D, X, mm, chi);
+        return;
+    }
+
+    // Lambda + alpha W W^T
+    BatchMat B;
+    Real alpha[BW];
+    AMREX_PRAGMA_SIMD
+    for (int l=0; l<nl; ++l) {
+        alpha[l] = 0.;
+    }
+    for (int i=0; i<n; ++i) {
+        Real diag[BW];
+        AMREX_PRAGMA_SIMD
+        for (int l=0; l<nl; ++l) {
+            diag[l] = 0.;
+        }
+        for (int j=0; j<n; ++j) {
+            if (j == i) continue;
+            AMREX_PRAGMA_SIMD
+            for (int l=0; l<nl; ++l) {
+                Real lambda = X[i][l]*X[j][l]/D[bidx(i,j)][l];
+                B[bidx(i,j)][l] = -lambda;
+                diag[l] += lambda;
+            }
+        }
+        AMREX_PRAGMA_SIMD
+        for (int l=0; l<nl; ++l) {
+            B[bidx(i,i)][l] = diag[l];
+            alpha[l] += diag[l];
+        }
+    }
+    for (int i=0; i<n; ++i) {
+        for (int j=0; j<n; ++j) {
+            AMREX_PRAGMA_SIMD
+            for (int l=0; l<nl; ++l) {
+                B[bidx(i,j)][l] += alpha[l]*W[i][l]*W[j][l];
+            }
+        }
+    }
+
+    if (inverse_type == 1) {
+        BatchInverseSPD<NS>(n, nl, B, chi);
+    } else {
+        BatchPseudoInverse<NS>(n, nl, B, chi);
+    }
+
+    for (int i=0; i<n; ++i) {
+        for (int j=0; j<n; ++j) {
+            AMREX_PRAGMA_SIMD
+            for (int l=0; l<nl; ++l) {
+                chi[bidx(i,j)][l] -= 1./alpha[l];
+            }
+        }
+    }
+}
+
+// molar concentrations and total molar mass (compute_molconc_molmtot_local)
+void MolconcMolmtot (int n, const Real* mm, const Real* rho, Real rhotot,
+                     Real* molarconc, Real& molmtot)
+{
+    Real Sum_woverm = 0.;
+    for (int i=0; i<n; ++i) {
+        Sum_woverm += rho[i]/rhotot/mm[i];
+    }
+    molmtot = 1./Sum_woverm;
+    for (int i=0; i<n; ++i) {
+        molarconc[i] = molmtot*rho[i]/rhotot/mm[i];
+    }
+}
+
+// Maxwell-Stefan coefficients (compute_D_bar_local in compute_mixture_properties.F90)
+void DbarLocal (const Real* rho, Real rhotot, Real* D_bar)
+{
+    Real D_bar_local[MS*(MS-1)/2];
+
+    switch (std::abs(mixture_type)) {
+    case 1: // water-glycerol
+        if (nspecies != 2) {
+            Abort("mixture_properties_mass_local assumes nspecies=2 if mixture_type=3 (water-glycerol)");
+        }
+        D_bar_local[0] = Dbar[0]*(1.024-1.001692692*rho[0]/rhotot)/(1.+0.6632641981*rho[0]/rhotot);
+        break;
+    case 2: // electrolyte mixture
+        if (nspecies != 3) {
+            Abort("mixture_properties_mass_local assumes nspecies=3 if mixture_type=2 (water-glycerol)");
+        }
+        D_bar_local[0] = Dbar[0]*std::sqrt(rho[0]/rhotot);
+        D_bar_local[1] = Dbar[1];
+        D_bar_local[2] = Dbar[2];
+        break;
+    default:
+        for (int n=0; n<nspecies*(nspecies-1)/2; ++n) {
+            D_bar_local[n] = Dbar[n];
+        }
+    }
+
+    int n = 0;
+    for (int row=0; row<nspecies; ++row) {
+        for (int column=0; column<row; ++column) {
+            D_bar[row*nspecies+column] = D_bar_local[n];
+            D_bar[column*nspecies+row] = D_bar_local[n];
+            ++n;
+        }
+        D_bar[row*nspecies+row] = 0.;
+    }
+}
+
+// face average of the densities of two neighboring cells, clipped to be
+// non-negative
+void NonnegativeRhoAv (const Array4<const Real>& rho,
+                       int i1, int j1, int k1, int i2, int j2, int k2,
+                       Real dv, Real* rhoav)
+{
+    // special version for rtil
+    if (use_multiphase == 1 && nspecies == 2) {
+        Real value1 = rho(i1,j1,k1,0);
+        Real value2 = rho(i2,j2,k2,0);
+        rhoav[0] = (value1 <= 0. || value2 <= 0.) ? 0. : amrex::min(0.5*(value1+value2), rho0);
+        rhoav[1] = rho0 - rhoav[0];
+        return;
+    }
+
+    for (int comp=0; comp<nspecies; ++comp) {
+        Real value1 = rho(i1,j1,k1,comp)/molmass[comp]; // convert to number density
+        Real value2 = rho(i2,j2,k2,comp)/molmass[comp];
+        Real tmp1, tmp2;
+
+        switch (avg_type) {
+        case 1: // arithmetic with a C0-smoothed Heaviside
+            if (value1 <= 0. || value2 <= 0.) {
+                rhoav[comp] = 0.;
+            } else {
+                tmp1 = amrex::min(dv*value1,1.);
+                tmp2 = amrex::min(dv*value2,1.);
+                rhoav[comp] = molmass[comp]*(value1+value2)/2.*tmp1*tmp2;
+            }
+            break;
+        case 2: // geometric
+            rhoav[comp] = molmass[comp]*std::sqrt(amrex::max(value1,0.)*amrex::max(value2,0.));
+            break;
+        case 3: // harmonic
+            if (value1 <= 10.*std::numeric_limits<Real>::min() ||
+                value2 <= 10.*std::numeric_limits<Real>::min()) {
+                rhoav[comp] = 0.;
+            } else {
+                rhoav[comp] = molmass[comp]*2./(1./value1+1./value2);
+            }
+            break;
+        case 10: // arithmetic with (discontinuous) Heaviside
+            if (value1 <= 0. || value2 <= 0.) {
+                rhoav[comp] = 0.;
+            } else {
+                rhoav[comp] = molmass[comp]*(value1+value2)/2.;
+            }
+            break;
+        case 11: // arithmetic with C1-smoothed Heaviside
+            if (value1 <= 0. || value2 <= 0.) {
+                rhoav[comp] = 0.;
+            } else {
+                tmp1 = dv*value1;
+                tmp1 = (tmp1 < 1.) ? (3.-2.*tmp1)*tmp1*tmp1 : 1.;
+                tmp2 = dv*value2;
+                tmp2 = (tmp2 < 1.) ? (3.-2.*tmp2)*tmp2*tmp2 : 1.;
+                rhoav[comp] = molmass[comp]*(value1+value2)/2.*tmp1*tmp2;
+            }
+            break;
+        case 12: // arithmetic with C2-smoothed Heaviside
+            if (value1 <= 0. || value2 <= 0.) {
+                rhoav[comp] = 0.;
+            } else {
+                tmp1 = dv*value1;
+                tmp1 = (tmp1 < 1.) ? (10.-15.*tmp1+6.*tmp1*tmp1)*tmp1*tmp1*tmp1 : 1.;
+                tmp2 = dv*value2;
+                tmp2 = (tmp2 < 1.) ? (10.-15.*tmp2+6.*tmp2*tmp2)*tmp2*tmp2*tmp2 : 1.;
+                rhoav[comp] = molmass[comp]*(value1+value2)/2.*tmp1*tmp2;
+            }
+            break;
+        default:
+            Abort("NonnegativeRhoAv: invalid avg_type");
+        }
+    }
+}
+
+// Subsystem of the non-trace species of one cell.  dest[row] is the index of
+// species row in the subsystem, or -1 for a trace species.
+struct TraceSubsystem {
+    int n;
+    int dest[MS];
+    Real rhotot;
+    Real molmtot;
+    Real rho[MS];
+    Real W[MS];
+    Real molarconc[MS];
+    Real mm[MS];
+    BatchMat chi;   // lane 0 only
+};
+
+// chi of the subsystem of non-trace species; D_bar is the full matrix
+void TraceSubsystemChi (TraceSubsystem& sub, const Real* rho, const Real* D_bar)
+{
+    BatchVec W, X, mm;
+    BatchMat D;
+
+    for (int row=0; row<nspecies; ++row) {
+        if (sub.dest[row] < 0) continue;
+        sub.mm [sub.dest[row]] = molmass[row];
+        sub.rho[sub.dest[row]] = rho[row];
+    }
+
+    // renormalize total density and mass fractions
+    sub.rhotot = 0.;
+    for (int row=0; row<sub.n; ++row) {
+        sub.rhotot += sub.rho[row];
+    }
+    for (int row=0; row<sub.n; ++row) {
+        sub.W[row] = sub.rho[row]/sub.rhotot;
+    }
+
+    MolconcMolmtot(sub.n, sub.mm, sub.rho, sub.rhotot, sub.molarconc, sub.molmtot);
+
+    for (int row=0; row<nspecies; ++row) {
+        if (sub.dest[row] < 0) continue;
+        for (int column=0; column<nspecies; ++column) {
+            if (sub.dest[column] < 0) continue;
+            D[bidx(sub.dest[row],sub.dest[column])][0] = D_bar[column*nspecies+row];
+        }
+    }
+    for (int row=0; row<sub.n; ++row) {
+        W [row][0] = sub.W[row];
+        X [row][0] = sub.molarconc[row];
+        mm[row][0] = sub.mm[row];
+    }
+
+    BatchChi<0>(sub.n, 1, D, W, X, mm, sub.chi);
+}
+
+// number of trace species (mass fraction below fraction_tolerance) and the
+// mapping onto the subsystem of the others
+int CountTrace (const Real* rho, Real rhotot, int* dest)
+{
+    int ntrace = 0;
+    for (int row=0; row<nspecies; ++row) {
+        if (rho[row]/rhotot < fraction_tolerance) {
+            ++ntrace;
+            dest[row] = -1;
+        } else {
+            dest[row] = row - ntrace;
+        }
+    }
+    return ntrace;
+}
+
+} // namespace
+
 void ComputeMolconcMolmtot(const MultiFab& rho,
 			   const MultiFab& rhotot,
 			   MultiFab& molarconc,
@@ -48,32 +724,178 @@ void ComputeGamma(const MultiFab& molarconc,
 
 }
 
-void ComputeRhoWChi(const MultiFab& rho,
-		    const MultiFab& rhotot,
-		    const MultiFab& molarconc,
-		    MultiFab& rhoWchi,
-		    const MultiFab& D_bar)
+template <int NS>
+static void ComputeRhoWChiNS(const MultiFab& rho,
+                             const MultiFab& rhotot,
+                             const MultiFab& molarconc,
+                             MultiFab& rhoWchi,
+                             const MultiFab& D_bar)
 {
-    BL_PROFILE_VAR("ComputeRhoWChi()",ComputeRhoWChi);
-
     int ng = rhoWchi.nGrow();
+    const int ns = (NS > 0) ? NS : nspecies;
     
     // Loop over boxes
     for (MFIter mfi(rhoWchi,TilingIfNotGPU()); mfi.isValid(); ++mfi) {
 
         // Create cell-centered box
         const Box& bx = mfi.growntilebox(ng);
+        const Dim3 lo = amrex::lbound(bx);
+        const Dim3 hi = amrex::ubound(bx);
+
+        const Array4<const Real>& rho_a       = rho.array(mfi);
+        const Array4<const Real>& rhotot_a    = rhotot.array(mfi);
+        const Array4<const Real>& molarconc_a = molarconc.array(mfi);
+        const Array4<const Real>& D_bar_a     = D_bar.array(mfi);
+        const Array4<      Real>& rhoWchi_a   = rhoWchi.array(mfi);
+
+        // batch of cells with no trace species
+        BatchMat D, chi;
+        BatchVec W, X, mm, rho_b;
+        int lane_i[BW];
+
+        for (int k=lo.z; k<=hi.z; ++k) {
+        for (int j=lo.y; j<=hi.y; ++j) {
+        for (int i0=lo.x; i0<=hi.x; i0+=BW) {
+
+            const int ib = amrex::min(BW, hi.x-i0+1);
+            int nl = 0;
+
+            for (int i=i0; i<i0+ib; ++i) {
+
+                Real rho_c[MS];
+                Real D_c[MS*MS];
+                for (int n=0; n<ns; ++n) {
+                    rho_c[n] = rho_a(i,j,k,n);
+                }
+                for (int n=0; n<ns*ns; ++n) {
+                    D_c[n] = D_bar_a(i,j,k,n);
+                }
+
+                if (use_multiphase == 1 && ns == 2) {
+                    Real w1 = molarconc_a(i,j,k,0);
+                    Real w2 = molarconc_a(i,j,k,1);
+                    if (w1 < 0.) {
+                        w1 = 0.;
+                        w2 = 1.;
+                    }
+                    if (w2 < 0.) {
+                        w2 = 0.;
+                        w1 = 1.;
+                    }
+                    rhoWchi_a(i,j,k,0) =  w2*rho0*D_c[ns];
+                    rhoWchi_a(i,j,k,2) = -w1*rho0*D_c[ns];
+                    rhoWchi_a(i,j,k,1) = -w2*rho0*D_c[ns];
+                    rhoWchi_a(i,j,k,3) =  w1*rho0*D_c[ns];
+                    continue;
+                }
+
+                TraceSubsystem sub;
+                const int ntrace = CountTrace(rho_c, rhotot_a(i,j,k), sub.dest);
+
+                if (ntrace == ns-1) {
+
+                    // essentially pure solvent
+                    for (int n=0; n<ns*ns; ++n) {
+                        rhoWchi_a(i,j,k,n) = 0.;
+                    }
+
+                } else if (ntrace == 0) {
+
+                    for (int row=0; row<ns; ++row) {
+                        W    [row][nl] = rho_c[row]/rhotot_a(i,j,k);
+                        X    [row][nl] = molarconc_a(i,j,k,row);
+                        mm   [row][nl] = molmass[row];
+                        rho_b[row][nl] = rho_c[row];
+                        for (int column=0; column<ns; ++column) {
+                            D[bidx(row,column)][nl] = D_c[column*ns+row];
+                        }
+                    }
+                    lane_i[nl++] = i;
+
+                } else {
+
+                    sub.n = ns - ntrace;
+                    TraceSubsystemChi(sub, rho_c, D_c);
 
-        compute_rhoWchi(ARLIM_3D(bx.loVect()), ARLIM_3D(bx.hiVect()),
-			BL_TO_FORTRAN_ANYD(rho[mfi]),
-			BL_TO_FORTRAN_ANYD(rhotot[mfi]),
-			BL_TO_FORTRAN_ANYD(molarconc[mfi]),
-			BL_TO_FORTRAN_ANYD(rhoWchi[mfi]),
-			BL_TO_FORTRAN_ANYD(D_bar[mfi]));
+                    for (int column=0; column<ns; ++column) {
+                        if (sub.dest[column] < 0) {
+                            // column of a trace species
+                            Real Deff = 0.;
+                            for (int kk=0; kk<ns; ++kk) {
+                                if (sub.dest[kk] >= 0) {
+                                    Deff += sub.molarconc[sub.dest[kk]]/D_c[column*ns+kk];
+                                }
+                            }
+                            Deff = 1./Deff;
+
+                            for (int row=0; row<ns; ++row) {
+                                Real val;
+                                if (row == column) {
+                                    val = sub.rhotot*Deff*molmass[row]/sub.molmtot;
+                                } else if (sub.dest[row] < 0) {
+                                    val = 0.;
+                                } else {
+                                    Real tmp = 0.;
+                                    for (int kk=0; kk<ns; ++kk) {
+                                        if (sub.dest[kk] >= 0) {
+                                            tmp += sub.chi[bidx(sub.dest[row],sub.dest[kk])][0]
+                                                * sub.molarconc[sub.dest[kk]]/D_c[column*ns+kk];
+                                        }
+                                    }
+                                    val = Deff*sub.rho[sub.dest[row]]*(tmp-molmass[column]/sub.molmtot);
+                                }
+                                rhoWchi_a(i,j,k,column*ns+row) = val;
+                            }
+                        } else {
+                            // column of a non-trace species
+                            for (int row=0; row<ns; ++row) {
+                                rhoWchi_a(i,j,k,column*ns+row) = (sub.dest[row] < 0) ? 0. :
+                                    sub.rho[sub.dest[row]]*sub.chi[bidx(sub.dest[row],sub.dest[column])][0];
+                            }
+                        }
+                    }
+                }
+            }
+
+            if (nl > 0) {
+                BatchChi<NS>(ns, nl, D, W, X, mm, chi);
+
+                for (int column=0; column<ns; ++column) {
+                    for (int row=0; row<ns; ++row) {
+                        for (int l=0; l<nl; ++l) {
+                            rhoWchi_a(lane_i[l],j,k,column*ns+row) = rho_b[row][l]*chi[bidx(row,column)][l];
+                        }
+                    }
+                }
+            }
+        }
+        }
+        }
     }
 
 }
 
+// species counts 2-8 run kernels specialized at compile time
+void ComputeRhoWChi(const MultiFab& rho,
+		    const MultiFab& rhotot,
+		    const MultiFab& molarconc,
+		    MultiFab& rhoWchi,
+		    const MultiFab& D_bar)
+{
+    BL_PROFILE_VAR("ComputeRhoWChi()",ComputeRhoWChi);
+
+    switch (nspecies) {
+    case 2: ComputeRhoWChiNS<2>(rho, rhotot, molarconc, rhoWchi, D_bar); break;
+    case 3: ComputeRhoWChiNS<3>(rho, rhotot, molarconc, rhoWchi, D_bar); break;
+    case 4: ComputeRhoWChiNS<4>(rho, rhotot, molarconc, rhoWchi, D_bar); break;
+    case 5: ComputeRhoWChiNS<5>(rho, rhotot, molarconc, rhoWchi, D_bar); break;
+    case 6: ComputeRhoWChiNS<6>(rho, rhotot, molarconc, rhoWchi, D_bar); break;
+    case 7: ComputeRhoWChiNS<7>(rho, rhotot, molarconc, rhoWchi, D_bar); break;
+    case 8: ComputeRhoWChiNS<8>(rho, rhotot, molarconc, rhoWchi, D_bar); break;
+    default: ComputeRhoWChiNS<0>(rho, rhotot, molarconc, rhoWchi, D_bar);
+    }
+}
+
 void ComputeZetaByTemp(const MultiFab& molarconc,
  		       const MultiFab& D_bar,
  		       const MultiFab& Temp,
@@ -99,35 +921,274 @@ void ComputeZetaByTemp(const MultiFab& molarconc,
     }
 }
 
+template <int NS>
+static void ComputeSqrtLonsagerFCNS(const MultiFab& rho,
+                                    std::array< MultiFab, AMREX_SPACEDIM >& sqrtLonsager_fc,
+                                    const Geometry& geom)
+{
+    const Real* dx = geom.CellSize();
+    const int ns = (NS > 0) ? NS : nspecies;
+
+    // cell volume
+#if (AMREX_SPACEDIM == 2)
+    const Real dv = dx[0]*dx[1]*cell_depth;
+#elif (AMREX_SPACEDIM == 3)
+    const Real dv = dx[0]*dx[1]*dx[2];
+#endif
+
+    // Loop over boxes
+    for (MFIter mfi(rho); mfi.isValid(); ++mfi) {
+
+        const Array4<const Real>& rho_a = rho.array(mfi);
+
+        // batch of faces with no trace species
+        BatchMat D, L;
+        BatchVec W, X, mm;
+        Real fac[BW];
+        int lane_i[BW];
+
+        for (int d=0; d<AMREX_SPACEDIM; ++d) {
+
+            const int di = (d == 0);
+            const int dj = (d == 1);
+            const int dk = (d == 2);
+
+            // faces of the valid box normal to d
+            const Box& bx = amrex::surroundingNodes(mfi.validbox(), d);
+            const Dim3 lo = amrex::lbound(bx);
+            const Dim3 hi = amrex::ubound(bx);
+
+            const Array4<Real>& sqrtL = sqrtLonsager_fc[d].array(mfi);
+
+            for (int k=lo.z; k<=hi.z; ++k) {
+            for (int j=lo.y; j<=hi.y; ++j) {
+            for (int i0=lo.x; i0<=hi.x; i0+=BW) {
+
+                const int ib = amrex::min(BW, hi.x-i0+1);
+                int nl = 0;
+
+                for (int i=i0; i<i0+ib; ++i) {
+
+                    // must be called with non-negative densities
+                    Real rhoav[MS];
+                    NonnegativeRhoAv(rho_a, i-di, j-dj, k-dk, i, j, k, dv, rhoav);
+
+                    Real rhotot_f = 0.;
+                    for (int n=0; n<ns; ++n) {
+                        rhotot_f += rhoav[n];
+                    }
+
+                    TraceSubsystem sub;
+                    const int ntrace = CountTrace(rhoav, rhotot_f, sub.dest);
+
+                    if (ntrace == ns-1) {
+
+                        // essentially pure solvent
+                        for (int n=0; n<ns*ns; ++n) {
+                            sqrtL(i,j,k,n) = 0.;
+                        }
+                        continue;
+                    }
+
+                    Real D_c[MS*MS];
+                    DbarLocal(rhoav, rhotot_f, D_c);
+
+                    if (ntrace == 0) {
+
+                        Real molarconc[MS];
+                        Real molmtot;
+                        MolconcMolmtot(ns, molmass.data(), rhoav, rhotot_f, molarconc, molmtot);
+
+                        for (int row=0; row<ns; ++row) {
+                            W [row][nl] = rhoav[row]/rhotot_f;
+                            X [row][nl] = molarconc[row];
+                            mm[row][nl] = molmass[row];
+                            for (int column=0; column<ns; ++column) {
+                                D[bidx(row,column)][nl] = D_c[column*ns+row];
+                            }
+                        }
+                        fac[nl] = molmtot*rhotot_f/k_B;
+                        lane_i[nl++] = i;
+
+                    } else {
+
+                        sub.n = ns - ntrace;
+                        TraceSubsystemChi(sub, rhoav, D_c);
+
+                        // Onsager matrix of the subsystem and its Cholesky factor
+                        BatchMat& Lsub = sub.chi;
+                        const Real fsub = sub.molmtot*sub.rhotot/k_B;
+                        for (int row=0; row<sub.n; ++row) {
+                            for (int column=0; column<sub.n; ++column) {
+                                Lsub[bidx(row,column)][0] *= fsub*sub.W[row]*sub.W[column];
+                            }
+                        }
+                        BatchCholesky<0>(sub.n, 1, Lsub);
+
+                        for (int column=0; column<ns; ++column) {
+                            for (int row=0; row<ns; ++row) {
+                                sqrtL(i,j,k,column*ns+row) = (sub.dest[row] < 0 || sub.dest[column] < 0) ? 0. :
+                                    Lsub[bidx(sub.dest[row],sub.dest[column])][0];
+                            }
+                        }
+                    }
+                }
+
+                if (nl > 0) {
+                    BatchChi<NS>(ns, nl, D, W, X, mm, L);
+
+                    // Onsager matrix L and its Cholesky factor
+                    for (int row=0; row<ns; ++row) {
+                        for (int column=0; column<ns; ++column) {
+                            AMREX_PRAGMA_SIMD
+                            for (int l=0; l<nl; ++l) {
+                                L[bidx(row,column)][l] *= fac[l]*W[row][l]*W[column][l];
+                            }
+                        }
+                    }
+                    BatchCholesky<NS>(ns, nl, L);
+
+                    for (int column=0; column<ns; ++column) {
+                        for (int row=0; row<ns; ++row) {
+                            for (int l=0; l<nl; ++l) {
+                                sqrtL(lane_i[l],j,k,column*ns+row) = L[bidx(row,column)][l];
+                            }
+                        }
+                    }
+                }
+            }
+            }
+            }
+        }
+    }
+
+}
+
+// species counts 2-8 run kernels specialized at compile time
 void ComputeSqrtLonsagerFC(const MultiFab& rho, const MultiFab& rhotot,
                            std::array< MultiFab, AMREX_SPACEDIM >& sqrtLonsager_fc,
                            const Geometry& geom)
 {
     BL_PROFILE_VAR("ComputeSqrtLonsagerFC()",ComputeSqrtLonsagerFC);
 
-    const Real* dx = geom.CellSize();
+    switch (nspecies) {
+    case 2: ComputeSqrtLonsagerFCNS<2>(rho, sqrtLonsager_fc, geom); break;
+    case 3: ComputeSqrtLonsagerFCNS<3>(rho, sqrtLonsager_fc, geom); break;
+    case 4: ComputeSqrtLonsagerFCNS<4>(rho, sqrtLonsager_fc, geom); break;
+    case 5: ComputeSqrtLonsagerFCNS<5>(rho, sqrtLonsager_fc, geom); break;
+    case 6: ComputeSqrtLonsagerFCNS<6>(rho, sqrtLonsager_fc, geom); break;
+    case 7: ComputeSqrtLonsagerFCNS<7>(rho, sqrtLonsager_fc, geom); break;
+    case 8: ComputeSqrtLonsagerFCNS<8>(rho, sqrtLonsager_fc, geom); break;
+    default: ComputeSqrtLonsagerFCNS<0>(rho, sqrtLonsager_fc, geom);
+    }
+}
 
-    // for GPU later
-    // const GpuArray<Real, AMREX_SPACEDIM> dx = geom.CellSizeArray();
-    
-    // Loop over boxes
-    for (MFIter mfi(rho); mfi.isValid(); ++mfi) {
+void MassFluxUtilBenchmark(const MultiFab& rho, const MultiFab& rhotot,
+                           const Geometry& geom, int nrep)
+{
+    const BoxArray& ba = rho.boxArray();
+    const DistributionMapping& dm = rho.DistributionMap();
+    const int ng = rho.nGrow();
+    const int nspecies2 = nspecies*nspecies;
 
-        // note: tiling or GPU-ing requires nodal tileboxes and changes to
-        // loop indices in fortran
-        
-        // Create cell-centered box
-        const Box& validBox = mfi.validbox();
-
-        compute_sqrtLonsager_fc(ARLIM_3D(validBox.loVect()), ARLIM_3D(validBox.hiVect()),
-                                BL_TO_FORTRAN_ANYD(rho[mfi]),
-                                BL_TO_FORTRAN_ANYD(rhotot[mfi]),
-                                BL_TO_FORTRAN_ANYD(sqrtLonsager_fc[0][mfi]),
-                                BL_TO_FORTRAN_ANYD(sqrtLonsager_fc[1][mfi]),
-#if (AMREX_SPACEDIM == 3)
-                                BL_TO_FORTRAN_ANYD(sqrtLonsager_fc[2][mfi]),
-#endif
-                                dx);
+    MultiFab molarconc(ba, dm, nspecies, ng);
+    MultiFab molmtot  (ba, dm, 1, ng);
+    MultiFab D_bar    (ba, dm, nspecies2, ng);
+    MultiFab D_therm  (ba, dm, nspecies, ng);
+    MultiFab Hessian  (ba, dm, nspecies2, ng);
+
+    ComputeMolconcMolmtot(rho, rhotot, molarconc, molmtot);
+    ComputeMixtureProperties(rho, rhotot, D_bar, D_therm, Hessian);
+
+    MultiFab rhoWchi  (ba, dm, nspecies2, ng);
+    MultiFab rhoWchi_s(ba, dm, nspecies2, ng);
+
+    std::array< MultiFab, AMREX_SPACEDIM > sqrtL;
+    std::array< MultiFab, AMREX_SPACEDIM > sqrtL_s;
+    for (int d=0; d<AMREX_SPACEDIM; ++d) {
+        sqrtL  [d].define(convert(ba,nodal_flag_dir[d]), dm, nspecies2, 0);
+        sqrtL_s[d].define(convert(ba,nodal_flag_dir[d]), dm, nspecies2, 0);
+    }
+
+    Real ncells = 0.;
+    Real nfaces = 0.;
+    for (int i=0; i<ba.size(); ++i) {
+        ncells += amrex::grow(ba[i], ng).numPts();
+        for (int d=0; d<AMREX_SPACEDIM; ++d) {
+            nfaces += amrex::surroundingNodes(ba[i], d).numPts();
+        }
+    }
+    ncells *= nrep;
+    nfaces *= nrep;
+
+    auto report = [&] (const std::string& name, Real t_generic, Real t_special,
+                       Real npts, Real diff) {
+        ParallelDescriptor::ReduceRealMax(t_generic);
+        ParallelDescriptor::ReduceRealMax(t_special);
+        Print() << name << "\n";
+        Print() << "  runtime nspecies: " << t_generic << " s, "
+                << npts/t_generic << " points/s\n";
+        Print() << "  dispatched:       " << t_special << " s, "
+                << npts/t_special << " points/s, speedup " << t_generic/t_special << "\n";
+        Print() << "  max difference: " << diff << "\n";
+    };
+
+    Print() << "Mass flux kernels, nspecies = " << nspecies
+            << ((nspecies >= 2 && nspecies <= 8) ? " (specialized)" : " (no specialization)") << "\n";
+
+    // rho W chi by the iterative series and by the use_lapack inverse
+    const int use_lapack_in = use_lapack;
+    for (int lapack=0; lapack<=1; ++lapack) {
+
+        use_lapack = lapack;
+
+        // warm up both paths
+        ComputeRhoWChiNS<0>(rho, rhotot, molarconc, rhoWchi, D_bar);
+        ComputeRhoWChi(rho, rhotot, molarconc, rhoWchi_s, D_bar);
+
+        Real t0 = ParallelDescriptor::second();
+        for (int r=0; r<nrep; ++r) {
+            ComputeRhoWChiNS<0>(rho, rhotot, molarconc, rhoWchi, D_bar);
+        }
+        Real t_generic = ParallelDescriptor::second() - t0;
+
+        t0 = ParallelDescriptor::second();
+        for (int r=0; r<nrep; ++r) {
+            ComputeRhoWChi(rho, rhotot, molarconc, rhoWchi_s, D_bar);
+        }
+        Real t_special = ParallelDescriptor::second() - t0;
+
+        // the two paths should agree to roundoff
+        MultiFab::Subtract(rhoWchi_s, rhoWchi, 0, 0, nspecies2, ng);
+
+        report((lapack == 0) ? "  rhoWchi, iterative chi (use_lapack = 0)"
+                             : "  rhoWchi, inverse chi (use_lapack = 1)",
+               t_generic, t_special, ncells,
+               rhoWchi_s.norm0(0, nspecies2, IntVect(ng)));
+    }
+    use_lapack = use_lapack_in;
+
+    // Cholesky factor of the face Onsager matrix
+    ComputeSqrtLonsagerFCNS<0>(rho, sqrtL, geom);
+    ComputeSqrtLonsagerFC(rho, rhotot, sqrtL_s, geom);
+
+    Real t0 = ParallelDescriptor::second();
+    for (int r=0; r<nrep; ++r) {
+        ComputeSqrtLonsagerFCNS<0>(rho, sqrtL, geom);
+    }
+    Real t_generic = ParallelDescriptor::second() - t0;
+
+    t0 = ParallelDescriptor::second();
+    for (int r=0; r<nrep; ++r) {
+        ComputeSqrtLonsagerFC(rho, rhotot, sqrtL_s, geom);
+    }
+    Real t_special = ParallelDescriptor::second() - t0;
+
+    Real diff = 0.;
+    for (int d=0; d<AMREX_SPACEDIM; ++d) {
+        MultiFab::Subtract(sqrtL_s[d], sqrtL[d], 0, 0, nspecies2, 0);
+        diff = amrex::max(diff, sqrtL_s[d].norm0(0, nspecies2, IntVect(0)));
     }
 
+    report("  sqrtLonsager_fc (Cholesky)", t_generic, t_special, nfaces, diff);
 }
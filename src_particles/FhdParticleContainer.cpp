@@ -37,6 +37,14 @@ FhdParticleContainer::FhdParticleContainer(const Geometry & geom,
         Abort("searchDist is greater than half the domain length");
     }
 
+    // g(r) pairs are taken from the neighbor lists
+    if (radialdist_int > 0 || cartdist_int > 0) {
+        const Real* dxc = Geom(0).CellSize();
+        if (searchDist > (1.+1.e-10)*n_nbhd*amrex::min(dxc[0], dxc[1], dxc[2])) {
+            Abort("searchDist is greater than the neighbor list range");
+        }
+    }
+
     if (radialdist_int > 0 || cartdist_int > 0) {
 
         // create enough bins to look within a sphere with radius equal to "half" of the domain
@@ -120,6 +128,14 @@ FhdParticleContainer::FhdParticleContainer(const Geometry & geom,
 
     doRedist = 1;
 
+    neighbor_skin = 0;
+    ParmParse pp("particles");
+    pp.query("neighbor_skin", neighbor_skin);
+    nl_disp = 0;
+    nl_valid = 0;
+    nl_builds = 0;
+    nl_updates = 0;
+
 }
 
 
@@ -140,6 +156,11 @@ void FhdParticleContainer::forceFunction(Real dt)
         AoS& particles = pti.GetArrayOfStructs();
         int np = pti.numParticles();
 
+        auto& soa = pti.GetStructOfArrays();
+        const Real* ax = soa.GetRealData(FHD_realDataSoA::ax).dataPtr();
+        const Real* ay = soa.GetRealData(FHD_realDataSoA::ay).dataPtr();
+        const Real* az = soa.GetRealData(FHD_realDataSoA::az).dataPtr();
+
         const Box& tile_box  = pti.tilebox();
 
         Real maxUtile = 0;
@@ -156,9 +177,9 @@ void FhdParticleContainer::forceFunction(Real dt)
 //                radVec[1] = part.pos(1)-part.rdata(FHD_realData::oy);
 //                radVec[2] = part.pos(2)-part.rdata(FHD_realData::oz);
 
-                radVec[0] = part.rdata(FHD_realData::ax);
-                radVec[1] = part.rdata(FHD_realData::ay);
-                radVec[2] = part.rdata(FHD_realData::az);
+                radVec[0] = ax[i];
+                radVec[1] = ay[i];
+                radVec[2] = az[i];
 
                 Real kFac = 6*M_PI*part.rdata(FHD_realData::radius)*visc_coef/dt;
 
@@ -299,6 +320,23 @@ void FhdParticleContainer::velNorm()
 
 }
 
+void FhdParticleContainer::UpdateNeighborList() {
+
+    BL_PROFILE_VAR("UpdateNeighborList()",UpdateNeighborList);
+
+    if (neighbor_skin <= 0. || nl_valid == 0 || 2.*nl_disp > neighbor_skin) {
+        fillNeighbors();
+        buildNeighborList(CHECK_PAIR{});
+        nl_disp = 0;
+        nl_valid = 1;
+        nl_builds++;
+    } else {
+        // same particles on the same tiles; only the neighbor copies move
+        updateNeighbors();
+        nl_updates++;
+    }
+}
+
 void FhdParticleContainer::computeForcesNLGPU(const MultiFab& charge, const MultiFab& coords, const Real* dx) {
 
     BL_PROFILE_VAR("computeForcesNL()",computeForcesNL);
@@ -308,17 +346,8 @@ void FhdParticleContainer::computeForcesNLGPU(const MultiFab& charge, const Mult
     Real recount = 0;
     Real recountI = 0;
     const int lev = 0;
-       
-#ifdef _OPENMP
-#pragma omp parallel
-#endif
-
-    //if(doRedist != 0)
-    //{
-        fillNeighbors();
 
-        buildNeighborList(CHECK_PAIR{});
-    //}
+    UpdateNeighborList();
 
    for (FhdParIter pti(*this, lev, MFItInfo().SetDynamic(false)); pti.isValid(); ++pti)
    {     
@@ -365,102 +394,6 @@ void FhdParticleContainer::computeForcesNLGPU(const MultiFab& charge, const Mult
     }
 }
 
-void FhdParticleContainer::computeForcesCoulombGPU(long totalParticles) {
-
-    BL_PROFILE_VAR("computeForcesCoulomb()",computeForcesCoulomb);
-
-    using namespace amrex;
-    using common::permittivity;
-    using common::images;
-
-    Real ee = (1.0/(permittivity*4*3.14159265));
-
-    GpuArray<Real, 3> plo = {prob_lo[0], prob_lo[1], prob_lo[2]};
-    GpuArray<Real, 3> phi = {prob_hi[0], prob_hi[1], prob_hi[2]};
-
-    const int lev = 0;
-    double domx, domy, domz;
-
-    domx = (phi[0] - plo[0]);
-    domy = (phi[1] - plo[1]);
-    domz = (phi[2] - plo[2]);
-
-    Real posx[totalParticles];
-    Real posy[totalParticles];
-    Real posz[totalParticles];
-    int  species[totalParticles];
-
-    Real charge[totalParticles];
-
-    Print() << "Calculating Coulomb force for each particle pair\n";
-
-    // collect particle positions onto one processor
-    PullDown(0, posx, -1, totalParticles);
-    PullDown(0, posy, -2, totalParticles);
-    PullDown(0, posz, -3, totalParticles);
-    PullDown(0, charge, FHD_realData::q , totalParticles);
-    
-    int imag = (images == 0) ? 1 : images;
-
-    Real maxdist = 0.99*amrex::min(imag * domx,
-                                   //imag * domy,
-                                   imag * domz);
-
-#ifdef _OPENMP
-#pragma omp parallel
-#endif
-    for (FhdParIter pti(*this, lev); pti.isValid(); ++pti) {
-
-        const int grid_id = pti.index();
-        const int tile_id = pti.LocalTileIndex();
-
-        auto& particle_tile = GetParticles(lev)[std::make_pair(grid_id,tile_id)];
-        auto& particles = particle_tile.GetArrayOfStructs();
-        const int np = particles.numParticles();
-
-        // loop over particles
-        for(int i = 0; i < np; i++){
-
-            ParticleType & part = particles[i];
-
-            double dr2, rtdr2, dx, dy, dz;
-
-	    Real q1 = part.rdata(FHD_realData::q);
-
-            // loop over other particles
-            for(int j = 0; j < totalParticles; j++) {
-
-		Real q2 = charge[j];
-
-                // assume triply periodic, check the domain and the 8 periodic images
-		// (currently hard-coded for y-wall)
-                for(int ii = -images; ii <= images; ii++) {
-                    //for(int jj = -images; jj <= images; jj++) {
-                       for(int kk = -images; kk <= images; kk++) {
-
-                          // get distance between particles
-                          dx = part.pos(0)-posx[j] - ii*domx;
-                          dy = part.pos(1)-posy[j];// - jj*domy;
-                          dz = part.pos(2)-posz[j] - kk*domz;
-
-			  dr2 = dx*dx + dy*dy + dz*dz;
-                          rtdr2 = sqrt(dr2);
-
-              	          if (rtdr2 < maxdist && rtdr2 > 0.)
-                          {
-                              part.rdata(FHD_realData::forcex) += ee*(dx/rtdr2)*q1*q2/dr2;
-                              part.rdata(FHD_realData::forcey) += ee*(dy/rtdr2)*q1*q2/dr2;
-                              part.rdata(FHD_realData::forcez) += ee*(dz/rtdr2)*q1*q2/dr2;
-                          }
-		       }
-		    //}
-		}
-	    }
-	}
-    }
-}
-
-
 void FhdParticleContainer::MoveIonsCPP(const Real dt, const Real* dxFluid, const Real* dxE, const Geometry geomF,
                                     const std::array<MultiFab, AMREX_SPACEDIM>& umac, const std::array<MultiFab, AMREX_SPACEDIM>& efield,
                                     const std::array<MultiFab, AMREX_SPACEDIM>& RealFaceCoords,
@@ -486,20 +419,25 @@ void FhdParticleContainer::MoveIonsCPP(const Real dt, const Real* dxFluid, const
 
     doRedist = 0;
 
-    int        np_tile = 0 ,       np_proc = 0 ; // particle count
-    Real rejected_tile = 0., rejected_proc = 0.; // rejected moves in midpoint scheme
-    Real    moves_tile = 0.,    moves_proc = 0.; // total moves in midpoint scheme
-    Real maxspeed_tile = 0., maxspeed_proc = 0.; // max speed
-    Real  maxdist_tile = 0.,  maxdist_proc = 0.; // max displacement (fraction of radius)
-    Real diffinst_tile = 0., diffinst_proc = 0.; // average diffusion coefficient
-
-    Real adj = 0.99999;
-    Real adjalt = 2.0*(1.0-0.99999);
-    Real runtime, inttime;
-    int intsurf, intside, push;
-    int midpoint = 0;
-    Real posAlt[3];
-    Real check;
+    // statistics are accumulated per thread and combined by the OpenMP
+    // reductions, then across ranks below
+    int  np_proc = 0;        // particle count
+    Real moves_proc = 0.;    // total moves in midpoint scheme
+    Real maxspeed_proc = 0.; // max speed
+    Real maxdist_proc = 0.;  // max displacement (fraction of radius)
+    Real maxmove_proc = 0.;  // max displacement (absolute)
+    Real diffinst_proc = 0.; // average diffusion coefficient
+    int  reDist = 0;         // particles that left their tile
+
+    const Real adj = 0.99999;
+    const Real adjalt = 2.0*(1.0-0.99999);
+    Real check = 0.;
+
+    // The particle loops below run over tiles (particles.do_tiling=1) with
+    // one thread per tile.  All wall-interaction state (runtime, intersection
+    // data, push flag) is private to the particle being moved, the plane list
+    // is only read, and amrex::Random() draws from a per-thread generator, so
+    // find_inter_gpu/app_bc_gpu need no synchronization.
 
     if(all_dry != 1)
     {
@@ -507,6 +445,9 @@ void FhdParticleContainer::MoveIonsCPP(const Real dt, const Real* dxFluid, const
 
     if(move_tog == 2)
     {
+#ifdef _OPENMP
+#pragma omp parallel reduction(+:moves_proc)
+#endif
         for (MyIBMarIter pti(* this, lev); pti.isValid(); ++pti) {
 
             TileIndex index(pti.index(), pti.LocalTileIndex());
@@ -514,37 +455,25 @@ void FhdParticleContainer::MoveIonsCPP(const Real dt, const Real* dxFluid, const
             AoS & particles = this->GetParticles(lev).at(index).GetArrayOfStructs();
             long np = this->GetParticles(lev).at(index).numParticles();
 
-            Real posOld[3];
-            Real velOld[3];
-
-            moves_tile = 0;
-
             for (int i = 0; i < np; ++ i) {
                 ParticleType & part = particles[i];
 
                 if(part.idata(FHD_intData::pinned) == 0)
                 {
-                        moves_tile++;
+                        moves_proc++;
                         for (int d=0; d<AMREX_SPACEDIM; ++d)
                         {
-                            velOld[d] = part.rdata(FHD_realData::velx + d);
                             part.rdata(FHD_realData::pred_posx + d) = part.pos(d);
                         }
 
-                        runtime = 0.5*dt;
-                        inttime = 0;
-                        midpoint = 0;
-
+                        Real runtime = 0.5*dt;
+                        Real inttime = 0;
+                        int intsurf, intside, push;
 
                         while(runtime > 0)
                         {
-                            //find_inter(&part, &runtime, paramPlaneList, &paramPlaneCount, &intsurf, &inttime, &intside, ZFILL(plo), ZFILL(phi));
                             find_inter_gpu(part, runtime, paramPlaneList, paramPlaneCount, &intsurf, &inttime, &intside, ZFILL(plo), ZFILL(phi));
-                            
-                            for (int d=0; d<AMREX_SPACEDIM; ++d)
-                            {
-                                posAlt[d] = inttime * part.rdata(FHD_realData::velx + d)*adjalt;
-                            }
+
                             for (int d=0; d<AMREX_SPACEDIM; ++d)
                             {
                                 part.pos(d) += inttime * part.rdata(FHD_realData::velx + d)*adj;
@@ -558,10 +487,7 @@ void FhdParticleContainer::MoveIonsCPP(const Real dt, const Real* dxFluid, const
                                 if(surf.periodicity == 0)
                                 {
                                    Real dummy = 1;
-                                   //std::cout << "Pre: " << part.rdata(FHD_realData::velx) << ", " << part.rdata(FHD_realData::vely) << ", " << part.rdata(FHD_realData::velz) << ", " << intside << "\n";
-                                   //app_bc(&surf, &part, &intside, domsize, &push, &dummy, &dummy);
                                    app_bc_gpu(&surf, part, intside, domsize, &push, &runtime, dummy);
-                                   //std::cout << "Post: " << part.rdata(FHD_realData::velx) << ", " << part.rdata(FHD_realData::vely) << ", " << part.rdata(FHD_realData::velz) << ", " << intside << "\n";
 
                                    runtime = runtime - inttime;
 
@@ -571,7 +497,6 @@ void FhdParticleContainer::MoveIonsCPP(const Real dt, const Real* dxFluid, const
 
                                   for (int d=0; d<AMREX_SPACEDIM; ++d)
                                   {
-                 
                                     part.pos(d) += runtime * part.rdata(FHD_realData::velx + d);
                                   }
                                   runtime = 0;
@@ -583,23 +508,17 @@ void FhdParticleContainer::MoveIonsCPP(const Real dt, const Real* dxFluid, const
                                runtime = 0;
 
                             }
-
-
                         }
-                }            
-             
+                }
             }
-
-            moves_proc    += moves_tile;
-
-            //std::cout << "Moves " << moves_tile << std::endl;
-
-                
         }
 
         //Need to add midpoint rejecting feature here.
         InterpolateMarkersGpu(0, dxFluid, umac, RealFaceCoords, check);
- 
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
         for (MyIBMarIter pti(* this, lev); pti.isValid(); ++pti) {
 
             TileIndex index(pti.index(), pti.LocalTileIndex());
@@ -612,23 +531,20 @@ void FhdParticleContainer::MoveIonsCPP(const Real dt, const Real* dxFluid, const
                 if(part.idata(FHD_intData::pinned) == 0)
                 {
                         for (int d=0; d<AMREX_SPACEDIM; ++d)
-                        {                   
+                        {
                             part.pos(d) = part.rdata(FHD_realData::pred_posx + d);
                         }
                 }
-
-
             }
         }
     }
     }
 
-
-//cin.get();
-
-
     if((dry_move_tog == 1) || (dry_move_tog == 2))
     {
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
         for (MyIBMarIter pti(* this, lev); pti.isValid(); ++pti) {
 
             TileIndex index(pti.index(), pti.LocalTileIndex());
@@ -645,26 +561,21 @@ void FhdParticleContainer::MoveIonsCPP(const Real dt, const Real* dxFluid, const
                         Real dry_terms[3];
 
                         get_explicit_mobility_gpu(mb, mbDer, part, plo, phi);
-                        
+
                         dry_gpu(dt, part,dry_terms, mb, mbDer);
 
                         for (int d=0; d<AMREX_SPACEDIM; ++d)
-                        {                   
+                        {
                             part.rdata(FHD_realData::velx + d) += dry_terms[d];
                         }
                 }
-
             }
         }
     }
 
-    Real maxspeed = 0;
-    Real maxdist = 0;
-    Real totaldist, diffest;
-    Real diffinst = 0;
-    int moves = 0;
-    int reDist = 0;
-
+#ifdef _OPENMP
+#pragma omp parallel reduction(+:np_proc,diffinst_proc,reDist) reduction(max:maxspeed_proc,maxdist_proc,maxmove_proc)
+#endif
     for (MyIBMarIter pti(* this, lev); pti.isValid(); ++pti) {
 
         TileIndex index(pti.index(), pti.LocalTileIndex());
@@ -676,6 +587,14 @@ void FhdParticleContainer::MoveIonsCPP(const Real dt, const Real* dxFluid, const
         AoS & particles = this->GetParticles(lev).at(index).GetArrayOfStructs();
         long np = this->GetParticles(lev).at(index).numParticles();
 
+        auto& soa = this->GetParticles(lev).at(index).GetStructOfArrays();
+        Real* travelTime = soa.GetRealData(FHD_realDataSoA::travelTime).dataPtr();
+        // all three components exist in 2D too; totaldist reads disp[2]
+        Real* disp[3];
+        for (int d=0; d<3; ++d) {
+            disp[d] = soa.GetRealData(FHD_realDataSoA::ax + d).dataPtr();
+        }
+
         np_proc += np;
 
         for (int i = 0; i < np; ++ i) {
@@ -685,27 +604,20 @@ void FhdParticleContainer::MoveIonsCPP(const Real dt, const Real* dxFluid, const
                 Real speed = 0;
 
                 for (int d=0; d<AMREX_SPACEDIM; ++d)
-                {                   
-                    speed += part.rdata(FHD_realData::velx + d)*part.rdata(FHD_realData::velx + d);
-                }
-
-                if(speed > maxspeed)
                 {
-                    maxspeed = speed;
+                    speed += part.rdata(FHD_realData::velx + d)*part.rdata(FHD_realData::velx + d);
                 }
 
-                moves++;
-
-                runtime = dt;
+                maxspeed_proc = amrex::max(maxspeed_proc, speed);
 
-                //Real thisMove[3] = {0,0,0};
+                Real runtime = dt;
+                Real inttime;
+                int intsurf, intside, push;
+                Real posAlt[3];
 
                 while(runtime > 0)
                 {
-                    //find_inter(&part, &runtime, paramPlaneList, &paramPlaneCount, &intsurf, &inttime, &intside, ZFILL(plo), ZFILL(phi));
                     find_inter_gpu(part, runtime, paramPlaneList, paramPlaneCount, &intsurf, &inttime, &intside, ZFILL(plo), ZFILL(phi));
-                    //Print() << "PART " << part.id() << ", " << intsurf << "\n";
-                    //cin.get();
 
                     for (int d=0; d<AMREX_SPACEDIM; ++d)
                     {
@@ -714,8 +626,6 @@ void FhdParticleContainer::MoveIonsCPP(const Real dt, const Real* dxFluid, const
                     for (int d=0; d<AMREX_SPACEDIM; ++d)
                     {
                         part.pos(d) += inttime * part.rdata(FHD_realData::velx + d)*adj;
-                        //part.rdata(FHD_realData::ax +d ) += inttime * part.rdata(FHD_realData::velx + d)*adj;
-                        //thisMove[d] += inttime * part.rdata(FHD_realData::velx + d)*adj;
                     }
                     runtime = runtime - inttime;
                     if(intsurf > 0)
@@ -723,17 +633,13 @@ void FhdParticleContainer::MoveIonsCPP(const Real dt, const Real* dxFluid, const
                         const paramPlane& surf = paramPlaneList[intsurf-1];//find_inter indexes from 1 to maintain compatablity with fortran version
 
                         Real dummy = 1;
-                        //app_bc(&surf, &part, &intside, domsize, &push, &dummy, &dummy);
                         app_bc_gpu(&surf, part, intside, domsize, &push, &runtime, dummy);
-                        //std::cout << "Post: " << part.id() << ", " << part.rdata(FHD_realData::velx) << ", " << part.rdata(FHD_realData::vely) << ", " << part.rdata(FHD_realData::velz) << ", " << intsurf << "\n";
 
                         if(push == 1)
                         {
                             for (int d=0; d<AMREX_SPACEDIM; ++d)
                             {
                                 part.pos(d) += part.pos(d) + posAlt[d];
-                                //part.rdata(FHD_realData::ax + d) += part.pos(d) + posAlt[d];
-                                //thisMove[d] += part.pos(d) + posAlt[d];
                             }
                         }
                     }
@@ -742,27 +648,19 @@ void FhdParticleContainer::MoveIonsCPP(const Real dt, const Real* dxFluid, const
 
                 for (int d=0; d<AMREX_SPACEDIM; ++d)
                 {
-                    part.rdata(FHD_realData::ax + d) += part.rdata(FHD_realData::velx + d)*dt;
+                    disp[d][i] += part.rdata(FHD_realData::velx + d)*dt;
                 }
 
-    //            Print() << part.id() << " vel: " << setprecision(15) << part.rdata(FHD_realData::velx) << " pos: " << part.pos(0) << "\n";
-
                 Real dist = dt*sqrt(part.rdata(FHD_realData::velx)*part.rdata(FHD_realData::velx) + part.rdata(FHD_realData::vely)*part.rdata(FHD_realData::vely) + part.rdata(FHD_realData::velz)*part.rdata(FHD_realData::velz))/part.rdata(FHD_realData::radius);
-                
-                totaldist = sqrt(part.rdata(FHD_realData::ax)*part.rdata(FHD_realData::ax) + part.rdata(FHD_realData::ay)*part.rdata(FHD_realData::ay) + part.rdata(FHD_realData::az)*part.rdata(FHD_realData::az));
 
-                if(dist > maxdist)
-                {
-                    maxdist = dist;
-                }
-
-                //std::cout << "MAXDIST: " << maxdist << "\n";
+                Real totaldist = sqrt(disp[0][i]*disp[0][i] + disp[1][i]*disp[1][i] + disp[2][i]*disp[2][i]);
 
-                part.rdata(FHD_realData::travelTime) += dt;
+                maxdist_proc = amrex::max(maxdist_proc, dist);
+                maxmove_proc = amrex::max(maxmove_proc, dist*part.rdata(FHD_realData::radius));
 
-                diffest = totaldist/(6.0*part.rdata(FHD_realData::travelTime));
+                travelTime[i] += dt;
 
-                diffinst += diffest;
+                diffinst_proc += totaldist/(6.0*travelTime[i]);
             }
 
             int cell[3];
@@ -773,14 +671,8 @@ void FhdParticleContainer::MoveIonsCPP(const Real dt, const Real* dxFluid, const
             if((cell[0] < myLo[0]) || (cell[1] < myLo[1]) || (cell[2] < myLo[2]) || (cell[0] > myHi[0]) || (cell[1] > myHi[1]) || (cell[2] > myHi[2]))
             {
                 reDist++;
-            }    
+            }
         }
-
-        maxspeed_proc = amrex::max(maxspeed_proc, maxspeed);
-        maxdist_proc  = amrex::max(maxdist_proc, maxdist);
-        //std::cout << "MAXDISTPROC: " << maxdist_proc << "\n";
-
-        diffinst_proc += diffinst;
     }
 
     // gather statistics
@@ -789,6 +681,7 @@ void FhdParticleContainer::MoveIonsCPP(const Real dt, const Real* dxFluid, const
     ParallelDescriptor::ReduceRealSum(moves_proc);
     ParallelDescriptor::ReduceRealMax(maxspeed_proc);
     ParallelDescriptor::ReduceRealMax(maxdist_proc);
+    ParallelDescriptor::ReduceRealMax(maxmove_proc);
     ParallelDescriptor::ReduceRealSum(diffinst_proc);
     ParallelDescriptor::ReduceIntSum(reDist);
 
@@ -801,13 +694,21 @@ void FhdParticleContainer::MoveIonsCPP(const Real dt, const Real* dxFluid, const
         Print() << reDist << " particles to be redistributed.\n";
         Print() <<"Maximum observed speed: " << sqrt(maxspeed_proc) << "\n";
         Print() <<"Maximum observed displacement (fraction of radius): " << maxdist_proc << "\n";
+        if (neighbor_skin > 0.) {
+            Print() << "Neighbor list rebuilt " << nl_builds << " times in "
+                    << nl_builds+nl_updates << " uses\n";
+        }
         //Print() <<"Average diffusion coefficient: " << diffinst_proc/np_proc << "\n";
     }
     if(reDist != 0)
     {
         Redistribute();
         doRedist = 1;
+        nl_valid = 0;
     }
+
+    // dt*|v| bounds the distance travelled, reflections included
+    nl_disp += maxmove_proc;
 }
 
 
@@ -955,201 +856,134 @@ void FhdParticleContainer::SpreadIonsGPU(const Real* dxFluid, const Geometry geo
 
 void FhdParticleContainer::RadialDistribution(long totalParticles, const int step, const species* particleInfo)
 {        
-    const int lev = 0;
-    int bin;
-    double domx, domy, domz, totalDist, temp;
+    BL_PROFILE_VAR("RadialDistribution()",RadialDistribution);
 
-    domx = (prob_hi[0] - prob_lo[0]);
-    domy = (prob_hi[1] - prob_lo[1]);
-    domz = (prob_hi[2] - prob_lo[2]);
-
-    Real posx[totalParticles];
-    Real posy[totalParticles];
-    Real posz[totalParticles];
-    int  species[totalParticles];
-    
-    Real charge[totalParticles];
+    const int lev = 0;
+    double totalDist;
 
     Print() << "Calculating radial distribution\n";
 
-    // collect particle positions onto one processor
-    PullDown(0, posx, -1, totalParticles);
-    PullDown(0, posy, -2, totalParticles);
-    PullDown(0, posz, -3, totalParticles);
-    PullDown(0, charge, 27, totalParticles);
-    PullDownInt(0, species, 4, totalParticles);
-    
+    // pairs are found with the neighbor lists, which cover searchDist (see constructor)
+    UpdateNeighborList();
+
     // outer radial extent
     totalDist = totalBins*binSize;
 
-    // this is the bin "hit count"
-    RealVector radDist   (totalBins, 0.);
-    RealVector radDist_pp(totalBins, 0.);
-    RealVector radDist_pm(totalBins, 0.);
-    RealVector radDist_mm(totalBins, 0.);
-
-    double nearest[totalParticles*(nspecies+1)];
-    double nn[nspecies*nspecies+1];
+    // all bins and nearest neighbour data live in one buffer so they can be
+    // reduced together: [all | pp | pm | mm] hit counts, then the nearest
+    // neighbour distance sums and counts for each species pair and for any species
+    const int nnChan = nspecies*nspecies + 1;
+    const int nnSum  = 4*totalBins;
+    const int nnCnt  = nnSum + nnChan;
+    const int bufSize = nnCnt + nnChan;
 
-    for(int k = 0; k < (nspecies+1)*totalParticles; k++)
-    {
-        nearest[k] = 0;
-    }
+    RealVector hist(bufSize, 0.);
 
-    for(int k = 0; k < nspecies*nspecies+1; k++)
-    {
-        nn[k] = 0;
-    }
-    
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
-    for (FhdParIter pti(*this, lev); pti.isValid(); ++pti) {
-            
-        const int grid_id = pti.index();
-        const int tile_id = pti.LocalTileIndex();
+    {
+        // thread-private histogram, merged once below
+        RealVector histLocal(bufSize, 0.);
+        RealVector nearest(nspecies+1);
 
-        auto& particle_tile = GetParticles(lev)[std::make_pair(grid_id,tile_id)];
-        auto& particles = particle_tile.GetArrayOfStructs();
-        const int np = particles.numParticles();   
+        for (FhdParIter pti(*this, lev); pti.isValid(); ++pti) {
 
-        // loop over particles
-        for (int i = 0; i < np; ++i) {
+            PairIndex index(pti.index(), pti.LocalTileIndex());
+            AoS& particles = pti.GetArrayOfStructs();
+            const int np = pti.numParticles();
 
-            ParticleType & part = particles[i];
+            auto nbor_data = m_neighbor_list[lev][index].data();
 
-            int iilo = (part.pos(0)-searchDist <= prob_lo[0]) ? -1 : 0;
-            int iihi = (part.pos(0)+searchDist >= prob_hi[0]) ?  1 : 0;
+            // loop over particles
+            for (int i = 0; i < np; ++i) {
 
-            int jjlo = (part.pos(1)-searchDist <= prob_lo[1]) ? -1 : 0;
-            int jjhi = (part.pos(1)+searchDist >= prob_hi[1]) ?  1 : 0;
+                const ParticleType & part = particles[i];
 
-            int kklo = (part.pos(2)-searchDist <= prob_lo[2]) ? -1 : 0;
-            int kkhi = (part.pos(2)+searchDist >= prob_hi[2]) ?  1 : 0;
-                
-            double rad, dx, dy, dz;
+                const Real q1 = part.rdata(FHD_realData::q);
+                const int iSpec = part.idata(FHD_intData::species)-1;
 
-            int id = part.id() - 1;
-        
-            // loop over other particles
-            for(int j = 0; j < totalParticles; j++) {
-                
-                // assume triply periodic, check the domain and the 8 periodic images
-                for(int ii = iilo; ii <= iihi; ii++) {
-                for(int jj = jjlo; jj <= jjhi; jj++) {
-                for(int kk = kklo; kk <= kkhi; kk++) {
-
-                    // get distance between particles
-                    dx = part.pos(0)-posx[j] - ii*domx;
-                    dy = part.pos(1)-posy[j] - jj*domy;
-                    dz = part.pos(2)-posz[j] - kk*domz;
-
-                    int jSpec = species[j]-1;
-                    rad = sqrt(dx*dx + dy*dy + dz*dz);
-
-                    if((nearest[id*(nspecies+1) + jSpec] == 0 || nearest[id*(nspecies+1) + jSpec] > rad) && rad != 0)
-                    { 
-                        nearest[id*(nspecies +1)+ jSpec] = rad;
-//                        
-                    }
+                std::fill(nearest.begin(), nearest.end(), 0.);
 
-                    if((nearest[id*(nspecies+1) + nspecies] == 0 || nearest[id*(nspecies+1) + nspecies] > rad) && rad != 0)
-                    { 
-                        nearest[id*(nspecies +1) + nspecies] = rad;
-//                        Print() << "Particle " << i << " species " << jSpec << ", " << nearest[i*nspecies + jSpec] << "\n";
-                    }
+                // loop over neighbours (periodic images are already shifted)
+                for (const auto& p2 : nbor_data.getNeighbors(i)) {
 
-                    // if particles are close enough, increment the bin
-                    if(rad < totalDist && rad > 0.) {
-
-                        bin = (int)amrex::Math::floor(rad/binSize);
-                        radDist[bin]++;
-                            
-                        if (part.rdata(FHD_realData::q) > 0) {
-                            if (charge[j] > 0) {
-                                radDist_pp[bin]++;
-                            }
-                            else if (charge[j] < 0) {
-                                radDist_pm[bin]++;
-                            }
-                        }
-                        else if (part.rdata(FHD_realData::q) < 0) {
-                            if (charge[j] > 0) {
-                                radDist_pm[bin]++;
-                            }
-                            else if (charge[j] < 0) {
-                                radDist_mm[bin]++;
-                            }
-                        }
-                    }
-                }
-                }
-                }                
-            }  // loop over j (total particles)
-        } // loop over i (np; local particles)
-    }
+                    const Real dx = part.pos(0)-p2.pos(0);
+                    const Real dy = part.pos(1)-p2.pos(1);
+                    const Real dz = part.pos(2)-p2.pos(2);
 
-    // compute total number density
-    double n0_total = 0.;
-    for (int i=0; i<nspecies; ++i) {
-        n0_total += particleInfo[i].n0;
-    }
-        
-    // collect the hit count
-    ParallelDescriptor::ReduceRealSum(radDist   .dataPtr(),totalBins);
-    ParallelDescriptor::ReduceRealSum(radDist_pp.dataPtr(),totalBins);
-    ParallelDescriptor::ReduceRealSum(radDist_pm.dataPtr(),totalBins);
-    ParallelDescriptor::ReduceRealSum(radDist_mm.dataPtr(),totalBins);
-    ParallelDescriptor::ReduceRealSum(nearest,(nspecies+1)*totalParticles);
+                    const Real rad = sqrt(dx*dx + dy*dy + dz*dz);
 
-    int specCount[nspecies];
+                    if (rad == 0.) continue;
 
-    for(int i=0;i<nspecies;i++)
-    {
-        specCount[i] = 0;
-    }
+                    const int jSpec = p2.idata(FHD_intData::species)-1;
+                    const Real q2 = p2.rdata(FHD_realData::q);
 
-    for(int i=0;i<totalParticles;i++)
-    {
-        int iSpec = species[i]-1;
+                    if (nearest[jSpec] == 0 || nearest[jSpec] > rad) {
+                        nearest[jSpec] = rad;
+                    }
+                    if (nearest[nspecies] == 0 || nearest[nspecies] > rad) {
+                        nearest[nspecies] = rad;
+                    }
 
-        specCount[iSpec]++;
+                    // if particles are close enough, increment the bin
+                    if (rad < totalDist) {
 
-        for(int j=0;j<nspecies;j++)
-        {
-            nn[(iSpec)*nspecies + j] = nn[(iSpec)*nspecies + j] + nearest[i*(nspecies+1)+j];
+                        const int bin = (int)amrex::Math::floor(rad/binSize);
+                        histLocal[bin]++;
 
-            //std::cout << (iSpec)*nspecies + j  << ", " << nearest[i*(nspecies+1)+j] << "\n";
+                        if (q1 > 0 && q2 > 0) {
+                            histLocal[totalBins + bin]++;
+                        }
+                        else if (q1*q2 < 0) {
+                            histLocal[2*totalBins + bin]++;
+                        }
+                        else if (q1 < 0 && q2 < 0) {
+                            histLocal[3*totalBins + bin]++;
+                        }
+                    }
+                } // loop over neighbours
 
+                // only neighbours found within searchDist contribute
+                for (int j = 0; j < nspecies; ++j) {
+                    if (nearest[j] > 0) {
+                        histLocal[nnSum + iSpec*nspecies + j] += nearest[j];
+                        histLocal[nnCnt + iSpec*nspecies + j]++;
+                    }
+                }
+                if (nearest[nspecies] > 0) {
+                    histLocal[nnSum + nspecies*nspecies] += nearest[nspecies];
+                    histLocal[nnCnt + nspecies*nspecies]++;
+                }
+            } // loop over i (np; local particles)
         }
 
-        nn[nspecies*nspecies] = nn[nspecies*nspecies] + nearest[i*(nspecies+1)+nspecies];
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+        for (int k = 0; k < bufSize; ++k) {
+            hist[k] += histLocal[k];
+        }
     }
 
-    for(int i=0;i<nspecies;i++)
-    {
-        for(int j=0;j<nspecies;j++)
-        {           
+    // collect the hit count and nearest neighbour data in a single reduction
+    ParallelDescriptor::ReduceRealSum(hist.dataPtr(),bufSize);
 
-            if(i==j)
-            {
-                nn[i*nspecies+j] = nn[i*nspecies+j]/(specCount[i]-1);
+    RealVector radDist   (hist.begin()              , hist.begin() +   totalBins);
+    RealVector radDist_pp(hist.begin() +   totalBins, hist.begin() + 2*totalBins);
+    RealVector radDist_pm(hist.begin() + 2*totalBins, hist.begin() + 3*totalBins);
+    RealVector radDist_mm(hist.begin() + 3*totalBins, hist.begin() + 4*totalBins);
 
-            }else
-            {
-                nn[i*nspecies+j] = nn[i*nspecies+j]/specCount[i];
-
-            }
-
-            //Print() << nn[i*nspecies+j] << "\n";
-
-        }
+    RealVector nn(nnChan);
+    for (int k = 0; k < nnChan; k++) {
+        nn[k] = (hist[nnCnt+k] > 0) ? hist[nnSum+k]/hist[nnCnt+k] : 0.;
     }
 
-    nn[nspecies*nspecies] = nn[nspecies*nspecies]/(totalParticles - 1);
-
-    //Print() << nn[nspecies*nspecies+1] << "\n";
-        
+    // compute total number density
+    double n0_total = 0.;
+    for (int i=0; i<nspecies; ++i) {
+        n0_total += particleInfo[i].n0;
+    }
             
     // normalize by 1 / (number density * bin volume * total particle count)
     for(int i=0;i<totalBins;i++) {
@@ -1332,185 +1166,112 @@ void FhdParticleContainer::CartesianDistribution(long totalParticles, const int
     BL_PROFILE_VAR("CartesianDistribution()",CartesianDistribution);
     
     const int lev = 0;
-    int bin;
-    double domx, domy, domz, totalDist, temp;
-
-    domx = (prob_hi[0] - prob_lo[0]);
-    domy = (prob_hi[1] - prob_lo[1]);
-    domz = (prob_hi[2] - prob_lo[2]);
-
-    Real posx[totalParticles];
-    Real posy[totalParticles];
-    Real posz[totalParticles];
-    
-    Real charge[totalParticles];
+    double totalDist;
 
     Print() << "Calculating Cartesian distribution\n";
 
-    // collect particle positions onto one processor
-    PullDown(0, posx, -1, totalParticles);
-    PullDown(0, posy, -2, totalParticles);
-    PullDown(0, posz, -3, totalParticles);
-    PullDown(0, charge, 27, totalParticles);
+    // pairs are found with the neighbor lists, which cover searchDist (see constructor)
+    UpdateNeighborList();
 
     // outer extent
     totalDist = totalBins*binSize;
 
-    // this is the bin "hit count"
-    RealVector XDist   (totalBins, 0.);
-    RealVector XDist_pp(totalBins, 0.);
-    RealVector XDist_pm(totalBins, 0.);
-    RealVector XDist_mm(totalBins, 0.);
-    RealVector YDist   (totalBins, 0.);
-    RealVector YDist_pp(totalBins, 0.);
-    RealVector YDist_pm(totalBins, 0.);
-    RealVector YDist_mm(totalBins, 0.);
-    RealVector ZDist   (totalBins, 0.);
-    RealVector ZDist_pp(totalBins, 0.);
-    RealVector ZDist_pm(totalBins, 0.);
-    RealVector ZDist_mm(totalBins, 0.);
+    // one buffer for all channels so they can be reduced together:
+    // for each direction (x,y,z) the [all | pp | pm | mm] hit counts
+    const int bufSize = 12*totalBins;
+
+    RealVector hist(bufSize, 0.);
 
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
-    for (FhdParIter pti(*this, lev); pti.isValid(); ++pti) {
-            
-        const int grid_id = pti.index();
-        const int tile_id = pti.LocalTileIndex();
+    {
+        // thread-private histogram, merged once below
+        RealVector histLocal(bufSize, 0.);
 
-        auto& particle_tile = GetParticles(lev)[std::make_pair(grid_id,tile_id)];
-        auto& particles = particle_tile.GetArrayOfStructs();
-        const int np = particles.numParticles();
-        
-        // loop over particles
-        for (int i = 0; i < np; ++i) {
-            
-            ParticleType & part = particles[i];
+        for (FhdParIter pti(*this, lev); pti.isValid(); ++pti) {
 
-            int iilo = (part.pos(0)-searchDist <= prob_lo[0]) ? -1 : 0;
-            int iihi = (part.pos(0)+searchDist >= prob_hi[0]) ?  1 : 0;
+            PairIndex index(pti.index(), pti.LocalTileIndex());
+            AoS& particles = pti.GetArrayOfStructs();
+            const int np = pti.numParticles();
 
-            int jjlo = (part.pos(1)-searchDist <= prob_lo[1]) ? -1 : 0;
-            int jjhi = (part.pos(1)+searchDist >= prob_hi[1]) ?  1 : 0;
+            auto nbor_data = m_neighbor_list[lev][index].data();
 
-            int kklo = (part.pos(2)-searchDist <= prob_lo[2]) ? -1 : 0;
-            int kkhi = (part.pos(2)+searchDist >= prob_hi[2]) ?  1 : 0;
-            
-            double dist, dx, dy, dz;
-            // loop over other particles
-            for(int j = 0; j < totalParticles; j++)
-            {
-                // assume triply periodic, check the domain and the 8 periodic images
-                for(int ii = iilo; ii <= iihi; ii++)
-                {
-                for(int jj = jjlo; jj <= jjhi; jj++)
-                {
-                for(int kk = kklo; kk <= kkhi; kk++)
-                {
-                    // get distance between particles
-                    dx = amrex::Math::abs(part.pos(0)-posx[j] - ii*domx);
-                    dy = amrex::Math::abs(part.pos(1)-posy[j] - jj*domy);
-                    dz = amrex::Math::abs(part.pos(2)-posz[j] - kk*domz);
+            // loop over particles
+            for (int i = 0; i < np; ++i) {
 
-                    dist = sqrt(dx*dx + dy*dy + dz*dz);
+                const ParticleType & part = particles[i];
+                const Real q1 = part.rdata(FHD_realData::q);
+
+                // loop over neighbours (periodic images are already shifted)
+                for (const auto& p2 : nbor_data.getNeighbors(i)) {
+
+                    Real dr[3];
+                    for (int d=0; d<3; ++d) {
+                        dr[d] = amrex::Math::abs(part.pos(d)-p2.pos(d));
+                    }
+
+                    // skip self
+                    if (dr[0] == 0. && dr[1] == 0. && dr[2] == 0.) continue;
+
+                    const Real q2 = p2.rdata(FHD_realData::q);
+
+                    int chan = -1;
+                    if (q1 > 0 && q2 > 0) {
+                        chan = 1;
+                    }
+                    else if (q1*q2 < 0) {
+                        chan = 2;
+                    }
+                    else if (q1 < 0 && q2 < 0) {
+                        chan = 3;
+                    }
 
                     // if particles are close enough, increment the bin
-                    if (dist > 0.) {
-                        if(dx < totalDist && dy < searchDist && dz < searchDist) {
-                            
-                            bin = (int)amrex::Math::floor(dx/binSize);
-                            XDist[bin]++;
-                            
-                            if (part.rdata(FHD_realData::q) > 0) {
-                                if (charge[j] > 0) {
-                                    XDist_pp[bin]++;
-                                }
-                                else if (charge[j] < 0) {
-                                    XDist_pm[bin]++;
-                                }
-                            }
-                            else if (part.rdata(FHD_realData::q) < 0) {
-                                if (charge[j] > 0) {
-                                    XDist_pm[bin]++;
-                                }
-                                else if (charge[j] < 0) {
-                                    XDist_mm[bin]++;
-                                }
-                            }
-                            
-                        }
-                        if(dy < totalDist && dx < searchDist && dz < searchDist) {
-                            
-                            bin = (int)amrex::Math::floor(dy/binSize);
-                            YDist[bin]++;
-                            
-                            if (part.rdata(FHD_realData::q) > 0) {
-                                if (charge[j] > 0) {
-                                    YDist_pp[bin]++;
-                                }
-                                else if (charge[j] < 0) {
-                                    YDist_pm[bin]++;
-                                }
-                            }
-                            else if (part.rdata(FHD_realData::q) < 0) {
-                                if (charge[j] > 0) {
-                                    YDist_pm[bin]++;
-                                }
-                                else if (charge[j] < 0) {
-                                    YDist_mm[bin]++;
-                                }
-                            }
-                            
-                        }
-                        if(dz < totalDist && dx < searchDist && dy < searchDist) {
-                            
-                            bin = (int)amrex::Math::floor(dz/binSize);                            
-                            ZDist[bin]++;
-                            
-                            if (part.rdata(FHD_realData::q) > 0) {
-                                if (charge[j] > 0) {
-                                    ZDist_pp[bin]++;
-                                }
-                                else if (charge[j] < 0) {
-                                    ZDist_pm[bin]++;
-                                }
-                            }
-                            else if (part.rdata(FHD_realData::q) < 0) {
-                                if (charge[j] > 0) {
-                                    ZDist_pm[bin]++;
-                                }
-                                else if (charge[j] < 0) {
-                                    ZDist_mm[bin]++;
-                                }
+                    for (int d=0; d<3; ++d) {
+                        if (dr[d] < totalDist &&
+                            dr[(d+1)%3] < searchDist && dr[(d+2)%3] < searchDist) {
+
+                            const int bin = (int)amrex::Math::floor(dr[d]/binSize);
+                            histLocal[4*d*totalBins + bin]++;
+                            if (chan > 0) {
+                                histLocal[(4*d+chan)*totalBins + bin]++;
                             }
                         }
                     }
-                }
-                }
-                }                
-            }
+                } // loop over neighbours
+            } // loop over i (np; local particles)
+        }
+
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+        for (int k = 0; k < bufSize; ++k) {
+            hist[k] += histLocal[k];
         }
     }
 
+    // collect the hit count in a single reduction
+    ParallelDescriptor::ReduceRealSum(hist.dataPtr(),bufSize);
+
+    RealVector XDist   (hist.begin() +  0*totalBins, hist.begin() +  1*totalBins);
+    RealVector XDist_pp(hist.begin() +  1*totalBins, hist.begin() +  2*totalBins);
+    RealVector XDist_pm(hist.begin() +  2*totalBins, hist.begin() +  3*totalBins);
+    RealVector XDist_mm(hist.begin() +  3*totalBins, hist.begin() +  4*totalBins);
+    RealVector YDist   (hist.begin() +  4*totalBins, hist.begin() +  5*totalBins);
+    RealVector YDist_pp(hist.begin() +  5*totalBins, hist.begin() +  6*totalBins);
+    RealVector YDist_pm(hist.begin() +  6*totalBins, hist.begin() +  7*totalBins);
+    RealVector YDist_mm(hist.begin() +  7*totalBins, hist.begin() +  8*totalBins);
+    RealVector ZDist   (hist.begin() +  8*totalBins, hist.begin() +  9*totalBins);
+    RealVector ZDist_pp(hist.begin() +  9*totalBins, hist.begin() + 10*totalBins);
+    RealVector ZDist_pm(hist.begin() + 10*totalBins, hist.begin() + 11*totalBins);
+    RealVector ZDist_mm(hist.begin() + 11*totalBins, hist.begin() + 12*totalBins);
+
     // compute total number density
     double n0_total = 0.;
     for (int i=0; i<nspecies; ++i) {
         n0_total += particleInfo[i].n0;
     }
- 
-    // collect the hit count
-    ParallelDescriptor::ReduceRealSum(XDist   .dataPtr(),totalBins);
-    ParallelDescriptor::ReduceRealSum(XDist_pp.dataPtr(),totalBins);
-    ParallelDescriptor::ReduceRealSum(XDist_pm.dataPtr(),totalBins);
-    ParallelDescriptor::ReduceRealSum(XDist_mm.dataPtr(),totalBins);
-    ParallelDescriptor::ReduceRealSum(YDist   .dataPtr(),totalBins);
-    ParallelDescriptor::ReduceRealSum(YDist_pp.dataPtr(),totalBins);
-    ParallelDescriptor::ReduceRealSum(YDist_pm.dataPtr(),totalBins);
-    ParallelDescriptor::ReduceRealSum(YDist_mm.dataPtr(),totalBins);
-    ParallelDescriptor::ReduceRealSum(ZDist   .dataPtr(),totalBins);
-    ParallelDescriptor::ReduceRealSum(ZDist_pp.dataPtr(),totalBins);
-    ParallelDescriptor::ReduceRealSum(ZDist_pm.dataPtr(),totalBins);
-    ParallelDescriptor::ReduceRealSum(ZDist_mm.dataPtr(),totalBins);
 
     // normalize by 1 / (number density * bin volume * total particle count)
     for(int i=0;i<totalBins;i++) {
@@ -1874,6 +1635,7 @@ FhdParticleContainer::SetPosition(int id, Real x, Real y, Real z)
     clearNeighbors();
     Redistribute();
     fillNeighbors();
+    nl_valid = 0;
 }
 
 void
@@ -1945,114 +1707,88 @@ FhdParticleContainer::SetForce(int id, Real x, Real y, Real z)
 void
 FhdParticleContainer::clearMobilityMatrix()
 {
+    // number the pinned markers by owning rank so each rank's rows are one block
+    Vector<int> owner = pinnedOwners();
 
-    
-    for(int i=0;i<(3*totalPinnedMarkers);i++)
+    pinOrder.clear();
+    for(int p=1;p<=ParallelDescriptor::NProcs();p++)
     {
-
-        for(int j=0;j<(3*totalPinnedMarkers);j++)
+        for(int i=0;i<totalMarkers;i++)
         {
-            pinMatrix[i*3*totalPinnedMarkers + j] = 0;
-            //Print() << i << ", " << j << ", " << i*3*totalPinnedMarkers + j << ", " << pinMatrix[i*totalPinnedMarkers + j] << std::endl;
-
+            if(owner[i] == p)
+            {
+                pinOrder.push_back(i+1);
+            }
         }
     }
+    if (pinOrder.size() != totalPinnedMarkers) {
+        Abort("clearMobilityMatrix: number of pinned markers does not match totalPinnedMarkers");
+    }
+
+    setPinLayout();
+    pinFactorLoaded = false;
 
+    // rows and columns of this rank's markers, only used while assembling the mobility
+    const long N = 3*long(totalPinnedMarkers);
+    const long nrow = 3*long(pinLocal.size());
+    pinMatrix.resize(nrow*N);
+    pinMatrixCol.resize(nrow*N);
 
+    for(long i=0;i<nrow*N;i++)
+    {
+        pinMatrix[i] = 0;
+        pinMatrixCol[i] = 0;
+    }
 }
 
 
 void
 FhdParticleContainer::fillMobilityMatrix(int id, int comp)
 {
-    
-    int lev = 0;
-
-    Real velx[totalMarkers];
-    Real vely[totalMarkers];
-    Real velz[totalMarkers];
-    int  pinned[totalMarkers];
-    Real  forcex[totalMarkers];
-    Real  forcey[totalMarkers];
-    Real  forcez[totalMarkers];
-
-    int idMap[totalMarkers];
+    // column of the mobility for a unit force on component comp of marker id
+    const long N = 3*long(totalPinnedMarkers);
+    const int n = pinSlot[id-1];
+    const long j = 3*long(n) + comp;
 
-    PullDown(0, velx, FHD_realData::velx, totalMarkers);
-    PullDown(0, vely, FHD_realData::vely, totalMarkers);
-    PullDown(0, velz, FHD_realData::velz, totalMarkers);
-    PullDownInt(0, pinned, FHD_intData::pinned, totalMarkers);
+    // each rank stores the velocities of its own markers in their rows, and
+    // the whole column is assembled on the owner of marker id
+    Vector<Real> col(N, 0.);
 
+    int lev = 0;
     for(FhdParIter pti(* this, lev); pti.isValid(); ++pti)
     {
         PairIndex index(pti.index(), pti.LocalTileIndex());
 
         AoS & particles = this->GetParticles(lev).at(index).GetArrayOfStructs();
-        long np = this->GetParticles(lev).at(index).numParticles();
+        long np = this->GetParticles(lev).at(index).numRealParticles();
 
-//        AMREX_FOR_1D( np, i,
-        for(int i=0;i<np;i++)
+        for(int i=0;i < np;i++)
         {
             ParticleType & part = particles[i];
 
-            velx[part.id()-1] = part.rdata(FHD_realData::velx);
-            vely[part.id()-1] = part.rdata(FHD_realData::vely);
-            velz[part.id()-1] = part.rdata(FHD_realData::velz);
-
+            if(part.idata(FHD_intData::pinned) == 1)
+            {
+                const int m = pinSlot[part.id()-1];
+                const long lr = 3*long(pinLocalIdx[m]);
+                for(int d=0;d<3;d++)
+                {
+                    const Real v = part.rdata(FHD_realData::velx + d);
+                    pinMatrix[(lr+d)*N + j] += v;
+                    col[3*long(m)+d] = v;
+                }
+            }
         }
-//        );
-
     }
-    
-    Real velpin[totalPinnedMarkers*3];
-    int k = 0;
 
-    for(int i=0;i<totalMarkers;i++)
-    {
-        if(pinned[i] == 1)
-        {
-            velpin[k] = velx[i];
-            velpin[k+1] = vely[i];
-            velpin[k+2] = velz[i];
+    ParallelDescriptor::ReduceRealSum(col.dataPtr(), N, pinOwner[n]);
 
-            k = k+3;
-        }
-    }
-
-    k=1;
-    for(int i=0;i<totalMarkers;i++)
-    {
-        if(pinned[i] == 1)
+    if (pinOwner[n] == ParallelDescriptor::MyProc()) {
+        const long lr = 3*long(pinLocalIdx[n]) + comp;
+        for(long i=0;i<N;i++)
         {
-            idMap[i] = k;
-            k++;
+            pinMatrixCol[lr*N + i] += col[i];
         }
     }
-
-    int realID = idMap[id-1];
-
-    int matrixSize = 3*totalPinnedMarkers;
-
-    for(int i=0;i<matrixSize;i=i+3)
-    {
-        int j = 3*(realID-1) + comp;
-
-        pinMatrix[i*matrixSize +j] += velpin[i];
-
-        pinMatrix[(i+1)*matrixSize +j] += velpin[i+1];
-       
-        pinMatrix[(i+2)*matrixSize +j] += velpin[i+2];
-
-//        Print() << "MAT: " << i*matrixSize +j << ", " << pinMatrix[i*matrixSize+j] << std::endl;
-//        Print() << "MAT: " << (i+1)*matrixSize +j << ", " << pinMatrix[(i+1)*matrixSize+j] << std::endl;
-//        Print() << "MAT: " << (i+2)*matrixSize +j << ", " << pinMatrix[(i+2)*matrixSize+j] << std::endl;
-    }
-
-//    Print() << "Real ID: " << realID << std::endl;
-//    Print() << "MAT: " << pinMatrix[0] << std::endl;
-//    Print() << "MAT: " << pinMatrix[2*matrixSize] << std::endl;
-
-
 }
 
 void
@@ -2086,9 +1822,7 @@ FhdParticleContainer::writeVel(int id)
         }
     }
 
-    ParallelDescriptor::ReduceRealSum(x);
-    ParallelDescriptor::ReduceRealSum(y);
-    ParallelDescriptor::ReduceRealSum(z);
+    ParallelDescriptor::ReduceRealSum({x,y,z});
 
     if(ParallelDescriptor::MyProc() == 0) {
 
@@ -2106,153 +1840,178 @@ FhdParticleContainer::writeVel(int id)
 
 
 void
-FhdParticleContainer::invertMatrix() 
+FhdParticleContainer::factorMatrix() 
 {
     // timer for profiling
-    BL_PROFILE_VAR("invertMatrix()",initRankLists);
-
+    BL_PROFILE_VAR("factorMatrix()",factorMatrix);
 
-    if(ParallelDescriptor::MyProc() == 0) {             
+    const int npin = pinOrder.size();
+    const long N = 3*long(npin);
+    const int myproc = ParallelDescriptor::MyProc();
+    const int nrow = 3*pinLocal.size();
 
-        int N = 3*totalPinnedMarkers;
-        
-        Real* inv = new Real[N*N];
-        Real* A = new Real[N*N];
-
-        Real time1 = ParallelDescriptor::second();
+    Real time1 = ParallelDescriptor::second();
 
-        for(int i=0;i<N;i++)
+    // the mobility is symmetric positive definite; start from the lower
+    // triangle of the symmetrized measured rows, 0.5*(A + A^T)
+    Vector<long> row(nrow);
+    pinFactorRows.resize(pinFactorStart[nrow]);
+    for(int lr=0;lr<nrow;lr++)
+    {
+        row[lr] = 3*long(pinLocal[lr/3]) + lr%3;
+        Real* L = pinFactorRows.dataPtr() + pinFactorStart[lr];
+        for(long j=0;j<=row[lr];j++)
         {
-            for(int j=0;j<N;j++)
-            {
-                A[i*N + j] = pinMatrix[i*N + j];
-            }
-        }
-
-        for(int i = 0; i < N; i++){
-            for(int j = 0; j < N; j++){
-                if(i==j)
-                    inv[i*N + j] = 1.0;
-                else
-                    inv[i*N + j] = 0.0;
-            }
+            L[j] = 0.5*(pinMatrix[lr*N + j] + pinMatrixCol[lr*N + j]);
         }
+    }
 
-        for(int i = 0; i < N; i++){
-            for(int j = 0; j < N; j++){
-                if(i!=j){
-                    Real ratio = A[j*N + i]/A[i*N + i];
-                    for(int k = 0; k < N; k++){
-                        A[j*N + k] -= ratio * A[i*N + k];
-                        inv[j*N + k] -= ratio * inv[i*N + k];
+    // Cholesky factorization A = L L^T with the rows of L kept on the owners.
+    // The owner of each block of consecutive markers factors its diagonal
+    // block and broadcasts its rows; every rank then eliminates that block
+    // from its own later rows. L_rj = (A_rj - sum_{k<j} L_rk L_jk)/L_jj.
+    Vector<Real> block;
+    for(int nlo=0;nlo<npin;)
+    {
+        const int o = pinOwner[nlo];
+        int nhi = nlo+1;
+        while(nhi<npin && pinOwner[nhi] == o) nhi++;
+        const long rlo = 3*long(nlo);
+        const long rhi = 3*long(nhi);
+
+        // rows rlo..rhi-1 of L, packed; row j starts at (j*(j+1) - rlo*(rlo+1))/2
+        block.resize((rhi*(rhi+1) - rlo*(rlo+1))/2);
+
+        if (o == myproc) {
+            const int lr0 = 3*pinLocalIdx[nlo];
+            for(int lr=lr0; lr<lr0+(rhi-rlo); lr++)
+            {
+                Real* L = pinFactorRows.dataPtr() + pinFactorStart[lr];
+                const long r = row[lr];
+                for(long j=rlo;j<=r;j++)
+                {
+                    const Real* Lj = pinFactorRows.dataPtr() + pinFactorStart[lr0 + (j-rlo)];
+                    Real sum = L[j];
+                    for(long k=0;k<j;k++)
+                    {
+                        sum -= L[k]*Lj[k];
+                    }
+                    if (j < r) {
+                        L[j] = sum/Lj[j];
                     }
-                }            
+                    else {
+                        if (sum <= 0.) {
+                            Abort("factorMatrix: mobility matrix is not positive definite");
+                        }
+                        L[j] = std::sqrt(sum);
+                    }
+                }
             }
+            std::copy(pinFactorRows.dataPtr() + pinFactorStart[lr0],
+                      pinFactorRows.dataPtr() + pinFactorStart[lr0] + block.size(),
+                      block.dataPtr());
         }
+        ParallelDescriptor::Bcast(block.dataPtr(), block.size(), o);
 
-        for(int i = 0; i < N; i++){
-            Real a = A[i*N + i];
-            for(int j = 0; j < N; j++){
-                A[i*N + j] /= a;
-                inv[i*N + j] /= a;
+        for(int lr=0;lr<nrow;lr++)
+        {
+            const long r = row[lr];
+            if (r >= rhi) {
+                Real* L = pinFactorRows.dataPtr() + pinFactorStart[lr];
+                for(long j=rlo;j<rhi;j++)
+                {
+                    const Real* Lj = block.dataPtr() + (j*(j+1) - rlo*(rlo+1))/2;
+                    Real sum = L[j];
+                    for(long k=0;k<j;k++)
+                    {
+                        sum -= L[k]*Lj[k];
+                    }
+                    L[j] = sum/Lj[j];
+                }
             }
         }
 
+        nlo = nhi;
+    }
 
-//        std::string filename1 = "matOut";
-//        std::ofstream ofs1(filename1, std::ofstream::app);
-
-//        int matrixSize = 3*totalPinnedMarkers;
-//    
-//        for(int i=0;i<matrixSize;i++)
-//        {
-//            for(int j=0;j<matrixSize;j++)
-//            {
-//                ofs1 << setprecision(15) << pinMatrix[i*matrixSize +j] << std::endl;
-
-//            }
-//        }
-//        
-//        ofs1.close();
-
-        Real time2 = ParallelDescriptor::second() - time1;
-
-        Print() << "Inverse matrix calculated in " << time2 << " seconds.\n";
-
-//        std::string filename1 = "permOut";
-//        remove("permOut");
-//        std::ofstream ofs1(filename1, std::ofstream::app);
+    pinFactorLoaded = true;
 
-//    
-//        for(int i=0;i<N;i++)
-//        {
-//            for(int j=0;j<N;j++)
-//            {
-//                ofs1 << setprecision(15) << A[i*N + j] << std::endl;
+    Real time2 = ParallelDescriptor::second() - time1;
 
-//            }
-//        }
-//        
-//        ofs1.close();
+    Print() << "Mobility factor calculated in " << time2 << " seconds.\n";
 
-
-        std::string filename = "invOut";
-        remove("invOut");
-        //std::ofstream ofs2(filename2, std::ofstream::app);
+    // binary: "FHDPCHL1", the matrix size (long), the ids of the pinned markers
+    // in matrix order (int), then the lower triangle of L by rows; each owner
+    // appends its blocks in order
+    std::string filename = "cholOut";
+    if(myproc == 0) {
+        remove("cholOut");
         ofstream ofs( filename, ios::binary );
-    
-        for(int i=0;i<N;i++)
-        {
-            for(int j=0;j<N;j++)
-            {
-                //ofs2 << setprecision(15) << inv[i*N + j] << std::endl;
-                Real element = inv[i*N + j];
-                ofs.write( reinterpret_cast<char*>( &element ), sizeof element );
 
-            }
-        }
-        
-//        ofs2.close();
+        long nfile = N;
+        ofs.write( "FHDPCHL1", 8 );
+        ofs.write( reinterpret_cast<char*>( &nfile ), sizeof nfile );
+        ofs.write( reinterpret_cast<char*>( pinOrder.dataPtr() ), long(sizeof(int))*npin );
+
         ofs.close();
-        Print() << "Inverse matrix written\n";
+    }
+    ParallelDescriptor::Barrier();
 
+    for(int nlo=0;nlo<npin;)
+    {
+        const int o = pinOwner[nlo];
+        int nhi = nlo+1;
+        while(nhi<npin && pinOwner[nhi] == o) nhi++;
+
+        if (o == myproc) {
+            const long rlo = 3*long(nlo);
+            const long rhi = 3*long(nhi);
+            ofstream ofs( filename, ios::binary | ios::app );
+            ofs.write( reinterpret_cast<char*>( pinFactorRows.dataPtr() + pinFactorStart[3*pinLocalIdx[nlo]] ),
+                       long(sizeof(Real))*(rhi*(rhi+1) - rlo*(rlo+1))/2 );
+            ofs.close();
+        }
+        ParallelDescriptor::Barrier();
 
-        delete inv;
-        delete A;
+        nlo = nhi;
     }
-    
+
+    Print() << "Mobility factor written\n";
 }
 
 
 void
 FhdParticleContainer::writeMat()
 {
-
+    // binary, the measured N*N mobility by rows in matrix order (pinOrder);
+    // each owner appends the rows of its blocks in order
+    std::string filename = "matOut";
     if(ParallelDescriptor::MyProc() == 0) {
-
-        std::string filename = "matOut";
-
         remove("matOut");
-        //std::ofstream ofs(filename, std::ofstream::app);
-        ofstream ofs( filename, ios::binary );
-
-        int matrixSize = 3*totalPinnedMarkers;
-    
-        for(int i=0;i<matrixSize;i++)
-        {
-            for(int j=0;j<matrixSize;j++)
-            {
-                //ofs << setprecision(15) << pinMatrix[i*matrixSize +j] << std::endl;
+    }
+    ParallelDescriptor::Barrier();
 
-                Real element = pinMatrix[i*matrixSize +j];
-                ofs.write( reinterpret_cast<char*>( &element ), sizeof element );
+    const int npin = pinOrder.size();
+    const long N = 3*long(npin);
 
-            }
+    for(int nlo=0;nlo<npin;)
+    {
+        const int o = pinOwner[nlo];
+        int nhi = nlo+1;
+        while(nhi<npin && pinOwner[nhi] == o) nhi++;
+
+        if (o == ParallelDescriptor::MyProc()) {
+            ofstream ofs( filename, ios::binary | ios::app );
+            ofs.write( reinterpret_cast<char*>( pinMatrix.dataPtr() + 3*long(pinLocalIdx[nlo])*N ),
+                       long(sizeof(Real))*3*long(nhi-nlo)*N );
+            ofs.close();
         }
-        
-        ofs.close();
-        Print() << "WRITTEN\n";
+        ParallelDescriptor::Barrier();
+
+        nlo = nhi;
     }
+
+    Print() << "WRITTEN\n";
 }
 
 void
@@ -2273,29 +2032,33 @@ FhdParticleContainer::MeanSqrCalc(int lev, int reset) {
         long np = this->GetParticles(lev).at(index).numParticles();
         nTotal += np;
 
+        auto& soa = this->GetParticles(lev).at(index).GetStructOfArrays();
+        Real* travelTime = soa.GetRealData(FHD_realDataSoA::travelTime).dataPtr();
+        Real* disp[3];
+        for (int d=0; d<AMREX_SPACEDIM; ++d) {
+            disp[d] = soa.GetRealData(FHD_realDataSoA::ax + d).dataPtr();
+        }
+
         for (int i=0; i<np; ++i) {
             ParticleType & part = particles[i];
 
             Real sqrPos = 0;
             for (int d=0; d<AMREX_SPACEDIM; ++d){
-                sqrPos += pow(part.rdata(FHD_realData::ax + d),2);
-                sumPosQ[d] += part.rdata(FHD_realData::ax + d)*part.rdata(FHD_realData::q);
+                sqrPos += pow(disp[d][i],2);
+                sumPosQ[d] += disp[d][i]*part.rdata(FHD_realData::q);
             }
-            //std::cout << part.rdata(FHD_realData::ax) << std::endl;
 
-            diffTotal += sqrPos/(6.0*part.rdata(FHD_realData::travelTime));
-            tt = part.rdata(FHD_realData::travelTime);
+            diffTotal += sqrPos/(6.0*travelTime[i]);
+            tt = travelTime[i];
         }
 
         if(reset == 1)
         {
             for (int i=0; i<np; ++i) {
-                ParticleType & part = particles[i];
-
                 for (int d=0; d<AMREX_SPACEDIM; ++d){
-                    part.rdata(FHD_realData::ax + d) = 0;
+                    disp[d][i] = 0;
                 }
-                part.rdata(FHD_realData::travelTime) = 0;
+                travelTime[i] = 0;
             }
         }
     }
@@ -2,30 +2,111 @@
 
 #include "rng_functions.H"
 
+#include <chrono>
+
+// Philox key for counter_rng=1: the root seed and the number of fills done so
+// far.  Every rank calls MultiFabFillRandom in the same order, so the fill
+// number (which advances with step, stage and field) agrees across ranks.
+static uint32_t counter_rng_seed = 0;
+static uint32_t counter_rng_fill = 0;
+static int counter_rng_init = 0;
+
+void CounterRNGKey(uint32_t& key0, uint32_t& key1)
+{
+    if (counter_rng_init == 0) {
+        if (seed > 0) {
+            counter_rng_seed = seed;
+        } else {
+            // same clock-based root seed on all ranks
+            auto now = std::chrono::system_clock::now();
+            int randSeed = now.time_since_epoch().count();
+            ParallelDescriptor::Bcast(&randSeed,1,ParallelDescriptor::IOProcessorNumber());
+            counter_rng_seed = randSeed;
+        }
+        counter_rng_init = 1;
+    }
+
+    key0 = counter_rng_seed;
+    key1 = counter_rng_fill++;
+}
+
+static void MultiFabFillRandomCounter(MultiFab& mf, const int& scomp, const int& ncomp,
+                                      const amrex::Real& variance, const Geometry& geom)
+{
+    uint32_t key0, key1;
+    CounterRNGKey(key0, key1);
+
+    const Real stddev = sqrt(variance);
+
+    // domain in the index space of mf; periodic ghost cells and faces/nodes
+    // on periodic boundaries are wrapped to the valid index they duplicate,
+    // so every copy of a location draws the same number
+    const Box& dom = amrex::convert(geom.Domain(), mf.ixType());
+    const Dim3 dlo = amrex::lbound(dom);
+    const Dim3 dhi = amrex::ubound(dom);
+    GpuArray<int,3> per = {0,0,0};
+    GpuArray<int,3> len = {1,1,1};
+    for (int d=0; d<AMREX_SPACEDIM; ++d) {
+        per[d] = geom.isPeriodic(d);
+        len[d] = geom.Domain().length(d);
+    }
+
+    for (MFIter mfi(mf,TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+        const Box& bx = mfi.growntilebox();
+        const Array4<Real>& mf_fab = mf.array(mfi);
+        amrex::ParallelFor(bx, ncomp, [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+        {
+            int ii = per[0] ? dlo.x + ((i-dlo.x)%len[0] + len[0])%len[0] : i;
+            int jj = per[1] ? dlo.y + ((j-dlo.y)%len[1] + len[1])%len[1] : j;
+            int kk = per[2] ? dlo.z + ((k-dlo.z)%len[2] + len[2])%len[2] : k;
+
+            // ghost cells outside a non-periodic boundary are left alone,
+            // as FillBoundary would
+            if (ii < dlo.x || ii > dhi.x || jj < dlo.y || jj > dhi.y || kk < dlo.z || kk > dhi.z) {
+                return;
+            }
+
+            mf_fab(i,j,k,scomp+n) = stddev*PhiloxNormal(ii,jj,kk,scomp+n,key0,key1);
+        });
+    }
+}
+
 void MultiFabFillRandom(MultiFab& mf, const int& comp, const amrex::Real& variance,
                         const Geometry& geom)
+{
+    MultiFabFillRandom(mf, comp, 1, variance, geom);
+}
+
+void MultiFabFillRandom(MultiFab& mf, const int& scomp, const int& ncomp,
+                        const amrex::Real& variance, const Geometry& geom)
 {
     BL_PROFILE_VAR("MultiFabFillRandom()",MultiFabFillRandom);
 
+    if (counter_rng == 1) {
+        // no communication: shared and periodic locations are computed locally
+        MultiFabFillRandomCounter(mf, scomp, ncomp, variance, geom);
+        return;
+    }
+
     for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
         const Box& bx = mfi.validbox();
         const Array4<Real>& mf_fab = mf.array(mfi);
-        amrex::ParallelForRNG(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k, amrex::RandomEngine const& engine) noexcept
+        amrex::ParallelForRNG(bx, ncomp, [=] AMREX_GPU_DEVICE (int i, int j, int k, int n, amrex::RandomEngine const& engine) noexcept
         {
-	  mf_fab(i,j,k,comp) = amrex::RandomNormal(0.,1.,engine);
+	  mf_fab(i,j,k,scomp+n) = amrex::RandomNormal(0.,1.,engine);
         });
     }
 
 //----------------------------------------
 
     // Scale standard gaussian samples by standard deviation
-    mf.mult(sqrt(variance), comp, 1, 0);
+    mf.mult(sqrt(variance), scomp, ncomp, 0);
 
     // sync up random numbers of faces/nodes that are at the same physical location
-    mf.OverrideSync(geom.periodicity());
+    mf.OverrideSync(scomp, ncomp, geom.periodicity());
 
     // fill interior and periodic ghost cells
-    mf.FillBoundary(geom.periodicity());
+    mf.FillBoundary(scomp, ncomp, geom.periodicity());
 
 //----------------------------------------
 }